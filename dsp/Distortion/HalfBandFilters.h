@@ -0,0 +1,339 @@
+#pragma once
+
+#include "juce_dsp/juce_dsp.h"
+
+namespace punk_dsp
+{
+    /**
+     * IIR: polyphase allpass (elliptic) half-bands. Cheapest, nonlinear phase, fractional latency.
+     * FIR: linear-phase Kaiser-windowed half-bands. Flat group delay, more taps and latency.
+     */
+    enum class OversamplingFilter
+    {
+        IIR,
+        FIR
+    };
+
+    /**
+     * @class HalfBandIIR
+     * @brief One 2x stage of polyphase allpass half-bands: upsample() doubles the rate, downsample()
+     *        halves it, each with its own per-channel state.
+     *
+     * H(z) = (A0(z^2) + z^-1 A1(z^2)) / 2, where the two paths are cascades of first-order allpasses
+     * running at the lower rate, so each output sample costs one multiply per coefficient.
+     * Coefficients are designed in prepare() (Valenzuela-Constantinides elliptic design): the first
+     * stage gets 8 of them for a steep band edge (0.45 fs, -106 dB), later stages only have to clear
+     * images far above the audio band and get 4 (-117 dB).
+     */
+    template <typename SampleType>
+    class HalfBandIIR
+    {
+    public:
+        static constexpr int maxCoefficients = 8;
+
+        void prepare (int numChannels, bool firstStage)
+        {
+            const auto design = firstStage ? designCoefficients (8, 0.05) : designCoefficients (4, 0.25);
+            numCoefficients = (int) design.size();
+
+            // Low-frequency group delay of up + down: the extra half sample of the z^-1 path in each
+            // direction cancels against decimating on the odd phase, leaving the (1 - a) / (1 + a) sum
+            latency = 0.0;
+
+            for (int i = 0; i < numCoefficients; ++i)
+            {
+                coefficients[(size_t) i] = (SampleType) design[(size_t) i];
+                latency += (1.0 - design[(size_t) i]) / (1.0 + design[(size_t) i]);
+            }
+
+            upStates.assign ((size_t) (numChannels * numCoefficients), {});
+            downStates.assign (upStates.size(), {});
+        }
+
+        void reset()
+        {
+            std::fill (upStates.begin(), upStates.end(), Section {});
+            std::fill (downStates.begin(), downStates.end(), Section {});
+        }
+
+        // Latency of upsample() + downsample(), in samples at the lower rate
+        double getLatency() const noexcept     { return latency; }
+
+        // numSamples in, 2 * numSamples out
+        void upsample (int channel, const SampleType* input, SampleType* output, int numSamples) noexcept
+        {
+            Section* state = upStates.data() + channel * numCoefficients;
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                SampleType even = input[i];
+                SampleType odd = input[i];
+
+                for (int c = 0; c < numCoefficients; c += 2)
+                    even = state[c].process (coefficients[(size_t) c], even);
+
+                for (int c = 1; c < numCoefficients; c += 2)
+                    odd = state[c].process (coefficients[(size_t) c], odd);
+
+                output[2 * i] = even;
+                output[2 * i + 1] = odd;
+            }
+        }
+
+        // 2 * numSamples in, numSamples out
+        void downsample (int channel, const SampleType* input, SampleType* output, int numSamples) noexcept
+        {
+            Section* state = downStates.data() + channel * numCoefficients;
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                SampleType even = input[2 * i + 1];
+                SampleType odd = input[2 * i];
+
+                for (int c = 0; c < numCoefficients; c += 2)
+                    even = state[c].process (coefficients[(size_t) c], even);
+
+                for (int c = 1; c < numCoefficients; c += 2)
+                    odd = state[c].process (coefficients[(size_t) c], odd);
+
+                output[i] = (even + odd) * SampleType (0.5);
+            }
+        }
+
+        /**
+         * numCoefficients allpass coefficients for a half-band whose transition band is transition
+         * wide (relative to the higher rate, centred on a quarter of it), alternating path 0 / path 1.
+         */
+        static std::vector<double> designCoefficients (int numCoefficients, double transition)
+        {
+            const double pi = juce::MathConstants<double>::pi;
+
+            // Elliptic modulus and nome of the transition
+            double k = std::tan ((1.0 - transition * 2.0) * pi / 4.0);
+            k *= k;
+            const double kRoot = std::pow (1.0 - k * k, 0.25);
+            const double e = 0.5 * (1.0 - kRoot) / (1.0 + kRoot);
+            const double e4 = e * e * e * e;
+            const double q = e * (1.0 + e4 * (2.0 + e4 * (15.0 + 150.0 * e4)));
+
+            const int order = numCoefficients * 2 + 1;
+            std::vector<double> design ((size_t) numCoefficients);
+
+            for (int index = 0; index < numCoefficients; ++index)
+            {
+                const int c = index + 1;
+                double numerator = 0.0, denominator = 0.0;
+
+                for (int i = 0; i < 32; ++i)
+                    numerator += ((i % 2) ? -1.0 : 1.0) * std::pow (q, i * (i + 1)) * std::sin ((i * 2 + 1) * c * pi / order);
+
+                for (int i = 1; i < 32; ++i)
+                    denominator += ((i % 2) ? -1.0 : 1.0) * std::pow (q, i * i) * std::cos (i * 2 * c * pi / order);
+
+                const double w = numerator * std::pow (q, 0.25) / (denominator + 0.5);
+                const double w2 = w * w;
+                const double x = std::sqrt ((1.0 - w2 * k) * (1.0 - w2 / k)) / (1.0 + w2);
+                design[(size_t) index] = (1.0 - x) / (1.0 + x);
+            }
+
+            return design;
+        }
+
+    private:
+        // (a + z^-1) / (1 + a z^-1) at the lower rate
+        struct Section
+        {
+            SampleType x1 = 0, y1 = 0;
+
+            SampleType process (SampleType a, SampleType x) noexcept
+            {
+                const SampleType y = a * (x - y1) + x1;
+                x1 = x;
+                y1 = y;
+                return y;
+            }
+        };
+
+        std::array<SampleType, maxCoefficients> coefficients {};
+        int numCoefficients = 0;
+        double latency = 0.0;
+
+        std::vector<Section> upStates;      // numChannels * numCoefficients
+        std::vector<Section> downStates;
+    };
+
+    /**
+     * @class HalfBandFIR
+     * @brief One 2x stage of linear-phase half-band FIRs, split into its two polyphase branches.
+     *
+     * Every other tap of a half-band is zero, so one branch is a plain delay and the other a
+     * symmetric 2M-tap dot product: upsample() computes the even outputs with the dot product and
+     * reads the odd ones from the history, downsample() filters the even inputs and adds the
+     * delayed odd ones. The history is written twice into a ring of 2 * 2M samples so the dot
+     * product is always contiguous. First stage: 127 taps (0.45 fs, -91 dB); later stages: 27.
+     * Latency is the filter centre, 2M - 1 samples of the lower rate, for up and down together.
+     */
+    template <typename SampleType>
+    class HalfBandFIR
+    {
+    public:
+        void prepare (int numChannels, bool firstStage)
+        {
+            halfLength = firstStage ? 32 : 7;
+            const int numDense = 2 * halfLength;
+            const auto design = designDenseTaps (halfLength, 9.0);
+
+            taps.resize ((size_t) numDense);
+
+            for (int t = 0; t < numDense; ++t)
+                taps[(size_t) t] = (SampleType) design[(size_t) t];
+
+            channels.resize ((size_t) numChannels);
+
+            for (auto& ch : channels)
+            {
+                ch.upHistory.assign ((size_t) (2 * numDense), SampleType (0));
+                ch.evenHistory.assign (ch.upHistory.size(), SampleType (0));
+                ch.oddHistory.assign (ch.upHistory.size(), SampleType (0));
+            }
+
+            reset();
+        }
+
+        void reset()
+        {
+            for (auto& ch : channels)
+            {
+                std::fill (ch.upHistory.begin(), ch.upHistory.end(), SampleType (0));
+                std::fill (ch.evenHistory.begin(), ch.evenHistory.end(), SampleType (0));
+                std::fill (ch.oddHistory.begin(), ch.oddHistory.end(), SampleType (0));
+                ch.upPos = ch.downPos = 0;
+            }
+        }
+
+        double getLatency() const noexcept     { return (double) (2 * halfLength - 1); }
+
+        // numSamples in, 2 * numSamples out
+        void upsample (int channel, const SampleType* input, SampleType* output, int numSamples) noexcept
+        {
+            auto& ch = channels[(size_t) channel];
+            const int numDense = (int) taps.size();
+            const SampleType* dense = taps.data();
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                // history[pos .. pos + numDense) is always the newest numDense samples, oldest first
+                ch.upHistory[(size_t) ch.upPos] = ch.upHistory[(size_t) (ch.upPos + numDense)] = input[i];
+
+                if (++ch.upPos == numDense)
+                    ch.upPos = 0;
+
+                const SampleType* recent = ch.upHistory.data() + ch.upPos;
+
+                // The zero-stuffed input halves the level, so the branches are scaled by 2
+                output[2 * i] = dotProduct (dense, recent, numDense) * SampleType (2);
+                output[2 * i + 1] = recent[halfLength];
+            }
+        }
+
+        // 2 * numSamples in, numSamples out
+        void downsample (int channel, const SampleType* input, SampleType* output, int numSamples) noexcept
+        {
+            auto& ch = channels[(size_t) channel];
+            const int numDense = (int) taps.size();
+            const SampleType* dense = taps.data();
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                ch.evenHistory[(size_t) ch.downPos] = ch.evenHistory[(size_t) (ch.downPos + numDense)] = input[2 * i];
+                const int pos = ch.downPos + 1 == numDense ? 0 : ch.downPos + 1;
+                const SampleType* recentEven = ch.evenHistory.data() + pos;
+
+                // Odd inputs go through the centre tap (0.5) only, halfLength pairs late
+                const SampleType* recentOdd = ch.oddHistory.data() + ch.downPos;
+
+                output[i] = dotProduct (dense, recentEven, numDense) + recentOdd[halfLength] * SampleType (0.5);
+
+                ch.oddHistory[(size_t) ch.downPos] = ch.oddHistory[(size_t) (ch.downPos + numDense)] = input[2 * i + 1];
+                ch.downPos = pos;
+            }
+        }
+
+        /**
+         * The 2M non-zero taps of the 4M - 1 tap Kaiser-windowed half-band besides its centre (0.5),
+         * normalised so this branch also has a DC gain of 0.5. Symmetric, so their order is moot.
+         */
+        static std::vector<double> designDenseTaps (int newHalfLength, double beta)
+        {
+            const int length = 4 * newHalfLength - 1;
+            const int centre = length / 2;
+            std::vector<double> design ((size_t) (2 * newHalfLength));
+            double sum = 0.0;
+
+            for (int t = 0; t < 2 * newHalfLength; ++t)
+            {
+                const int n = 2 * t;
+                const double x = juce::MathConstants<double>::halfPi * (double) (n - centre);
+                const double ratio = 2.0 * (double) n / (double) (length - 1) - 1.0;
+                const double window = besselI0 (beta * std::sqrt (1.0 - ratio * ratio)) / besselI0 (beta);
+
+                design[(size_t) t] = 0.5 * std::sin (x) / x * window;
+                sum += design[(size_t) t];
+            }
+
+            for (auto& tap : design)
+                tap *= 0.5 / sum;
+
+            return design;
+        }
+
+    private:
+        // Four independent sums, so the adds don't wait on each other (numTaps is even)
+        static SampleType dotProduct (const SampleType* a, const SampleType* b, int numTaps) noexcept
+        {
+            SampleType sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+            int t = 0;
+
+            for (; t + 4 <= numTaps; t += 4)
+            {
+                sum0 += a[t] * b[t];
+                sum1 += a[t + 1] * b[t + 1];
+                sum2 += a[t + 2] * b[t + 2];
+                sum3 += a[t + 3] * b[t + 3];
+            }
+
+            for (; t < numTaps; t += 2)
+            {
+                sum0 += a[t] * b[t];
+                sum1 += a[t + 1] * b[t + 1];
+            }
+
+            return (sum0 + sum2) + (sum1 + sum3);
+        }
+
+        static double besselI0 (double x)
+        {
+            double sum = 1.0, term = 1.0;
+
+            for (int k = 1; term > 1.0e-12 * sum; ++k)
+            {
+                term *= (x / (2.0 * k)) * (x / (2.0 * k));
+                sum += term;
+            }
+
+            return sum;
+        }
+
+        struct ChannelState
+        {
+            std::vector<SampleType> upHistory;      // Inputs, written twice
+            std::vector<SampleType> evenHistory;    // Even inputs of downsample(), written twice
+            std::vector<SampleType> oddHistory;     // Odd inputs of downsample(), written twice
+            int upPos = 0, downPos = 0;
+        };
+
+        std::vector<SampleType> taps;
+        std::vector<ChannelState> channels;
+        int halfLength = 0;     // M: the dense branch has 2M taps
+    };
+}
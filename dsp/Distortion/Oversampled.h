@@ -0,0 +1,200 @@
+#pragma once
+
+#include "juce_dsp/juce_dsp.h"
+#include "HalfBandFilters.h"
+
+/**
+ * @class Oversampled
+ * @brief Runs a distortion processor's per-sample kernel at 2x, 4x or 8x the host rate.
+ *
+ * Wraps Waveshaper, TubeModel, Wavefolder or ParametricWaveshaper (any Processor<SampleType>):
+ *
+ *     punk_dsp::Oversampled<punk_dsp::Waveshaper<float>> shaper;
+ *     shaper.setFactor (4);
+ *     shaper.prepare (spec);
+ *     shaper.getProcessor().setDrive (8.0f);
+ *     shaper.process (buffer, [] (auto& ws, float x) { return ws.applyTanhClipper (x); });
+ *
+ * A kernel that also takes the channel, kernel (processor, channel, sample), gets the index of the
+ * channel being run, which a processor with per-channel state needs (Waveshaper's ADAA overloads,
+ * prepared for the channel count):
+ *
+ *     shaper.getProcessor().setADAAOrder (punk_dsp::ADAAOrder::FirstOrder);
+ *     shaper.getProcessor().prepare (spec);
+ *     shaper.process (buffer, [] (auto& ws, int channel, float x) { return ws.applyTanhClipper (channel, x); });
+ *
+ * Each 2x step is a polyphase half-band stage (HalfBandFilters.h), IIR or FIR. process() reads
+ * the host buffer straight into the first stage, runs the kernel over the top-rate block in place
+ * in one loop, and the last downsampling stage writes straight back into the host buffer, so the
+ * only intermediate storage is one buffer per stage, allocated in prepare().
+ *
+ * prepare() readies all three stages of both filters, so setFactor() and setFilter() only switch
+ * between them and can be called at any time; a switch resets the filters and changes the latency.
+ * getLatencySamples() is the delay of the filters at the host rate, rounded (the IIR one is
+ * fractional and only holds at low frequencies; the FIR one is exact at 2x). Report it to the host,
+ * plus any delay of the processor itself divided by getFactor().
+ *
+ * The processor sees factor times the host rate; its parameters are per sample, not per second.
+ */
+namespace punk_dsp
+{
+    template <typename Processor>
+    class Oversampled;
+
+    template <template <typename> class ProcessorType, typename SampleType>
+    class Oversampled<ProcessorType<SampleType>>
+    {
+    public:
+        using Processor = ProcessorType<SampleType>;
+
+        static constexpr int maxStages = 3;
+
+        Oversampled() = default;
+        ~Oversampled() = default;
+
+        void setFactor (int newFactor)                  // 2, 4 or 8
+        {
+            const int newNumStages = newFactor >= 8 ? 3 : (newFactor >= 4 ? 2 : 1);
+
+            if (newNumStages != numStages)
+            {
+                numStages = newNumStages;
+                updateLatency();
+                reset();
+            }
+        }
+
+        void setFilter (OversamplingFilter newFilter)
+        {
+            if (newFilter != filter)
+            {
+                filter = newFilter;
+                updateLatency();
+                reset();
+            }
+        }
+
+        void prepare (const juce::dsp::ProcessSpec& spec)
+        {
+            maxBlockSize = (int) spec.maximumBlockSize;
+            numChannels = (int) spec.numChannels;
+
+            for (int stage = 0; stage < maxStages; ++stage)
+            {
+                iirStages[(size_t) stage].prepare (numChannels, stage == 0);
+                firStages[(size_t) stage].prepare (numChannels, stage == 0);
+                stageBuffers[(size_t) stage].setSize (numChannels, maxBlockSize << (stage + 1), false, true, false);
+            }
+
+            updateLatency();
+            reset();
+        }
+
+        void reset()
+        {
+            for (int stage = 0; stage < maxStages; ++stage)
+            {
+                iirStages[(size_t) stage].reset();
+                firStages[(size_t) stage].reset();
+                stageBuffers[(size_t) stage].clear();
+            }
+        }
+
+        int getFactor() const noexcept                  { return 1 << numStages; }
+        int getLatencySamples() const noexcept          { return juce::roundToInt (latency); }
+
+        Processor& getProcessor() noexcept              { return processor; }
+        const Processor& getProcessor() const noexcept  { return processor; }
+
+        /**
+        * @brief Processes the audio buffer in-place through kernel at the oversampled rate.
+        *
+        * @param inputBuffer The buffer containing the signal to be processed.
+        * @param kernel      Called as kernel (getProcessor(), sample), or kernel (getProcessor(), channel,
+        *                    sample) if it takes the channel, for every upsampled sample, returning
+        *                    the processed sample.
+        */
+        template <typename Kernel>
+        void process (juce::AudioBuffer<SampleType>& inputBuffer, Kernel&& kernel)
+        {
+            if (filter == OversamplingFilter::IIR)
+                processBlock (iirStages, inputBuffer, kernel);
+            else
+                processBlock (firStages, inputBuffer, kernel);
+        }
+
+    private:
+        void updateLatency()
+        {
+            latency = 0.0;
+
+            // Stage s runs at 2^s times the host rate on its input side
+            for (int stage = 0; stage < numStages; ++stage)
+                latency += (filter == OversamplingFilter::IIR ? iirStages[(size_t) stage].getLatency()
+                                                              : firStages[(size_t) stage].getLatency()) / (double) (1 << stage);
+        }
+
+        template <typename Kernel>
+        SampleType applyKernel (Kernel& kernel, int channel, SampleType sample)
+        {
+            if constexpr (std::is_invocable_v<Kernel&, Processor&, int, SampleType>)
+                return kernel (processor, channel, sample);
+            else
+                return kernel (processor, sample);
+        }
+
+        template <typename Stages, typename Kernel>
+        void processBlock (Stages& stages, juce::AudioBuffer<SampleType>& inputBuffer, Kernel& kernel)
+        {
+            const int channels = juce::jmin (inputBuffer.getNumChannels(), numChannels);
+            const int totalSamples = inputBuffer.getNumSamples();
+
+            for (int channel = 0; channel < channels; ++channel)
+            {
+                SampleType* channelData = inputBuffer.getWritePointer (channel);
+
+                for (int start = 0; start < totalSamples; start += maxBlockSize)
+                {
+                    const int numSamples = juce::jmin (maxBlockSize, totalSamples - start);
+                    const SampleType* stageInput = channelData + start;
+
+                    for (int stage = 0; stage < numStages; ++stage)
+                    {
+                        SampleType* stageOutput = stageBuffers[(size_t) stage].getWritePointer (channel);
+                        stages[(size_t) stage].upsample (channel, stageInput, stageOutput, numSamples << stage);
+                        stageInput = stageOutput;
+                    }
+
+                    SampleType* top = stageBuffers[(size_t) (numStages - 1)].getWritePointer (channel);
+                    const int numTopSamples = numSamples << numStages;
+
+                    for (int i = 0; i < numTopSamples; ++i)
+                        top[i] = applyKernel (kernel, channel, top[i]);
+
+                    for (int stage = numStages - 1; stage >= 0; --stage)
+                    {
+                        SampleType* stageOutput = stage == 0 ? channelData + start
+                                                             : stageBuffers[(size_t) (stage - 1)].getWritePointer (channel);
+                        stages[(size_t) stage].downsample (channel, stageBuffers[(size_t) stage].getReadPointer (channel),
+                                                           stageOutput, numSamples << stage);
+                    }
+                }
+            }
+        }
+
+        Processor processor;
+
+        std::array<HalfBandIIR<SampleType>, maxStages> iirStages;
+        std::array<HalfBandFIR<SampleType>, maxStages> firStages;
+        std::array<juce::AudioBuffer<SampleType>, maxStages> stageBuffers; // Stage s output, 2^(s+1) * maxBlockSize
+
+        OversamplingFilter filter = OversamplingFilter::IIR;
+        int numStages = 1;
+        int numChannels = 0;
+        int maxBlockSize = 0;
+        double latency = 0.0;   // Host-rate samples
+
+        // --- Prevent copy and move ---
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Oversampled)
+    };
+}
@@ -6,6 +6,7 @@
 
 namespace punk_dsp
 {
+    template <typename SampleType>
     class ParametricWaveshaper
     {
     public:
@@ -24,8 +25,8 @@ namespace punk_dsp
         // Extras
         void setMix(float newMix);
         
-        float processSample(float sample);
-        void processBuffer(juce::AudioBuffer<float>& inputBuffer);
+        SampleType processSample(SampleType sample);
+        void processBuffer(juce::AudioBuffer<SampleType>& inputBuffer);
 
     private:
         // Parameters
@@ -0,0 +1,131 @@
+#include "TableShaper.h"
+
+namespace punk_dsp
+{
+    template <typename SampleType>
+    TableShaper<SampleType>::TableShaper()
+    {
+    }
+
+    template <typename SampleType>
+    TableShaper<SampleType>::~TableShaper()
+    {
+        delete pending.exchange(nullptr);
+        delete retired.exchange(nullptr);
+    }
+
+    // --- --- PARAMETER UPDATES --- --
+    template <typename SampleType>
+    void TableShaper<SampleType>::setCurve(Curve newCurve)
+    {
+        curve = std::move(newCurve);
+        rebuild();
+    }
+
+    template <typename SampleType>
+    void TableShaper<SampleType>::setInputRange(float newInputRange)
+    {
+        inputRange = juce::jlimit(0.01f, 100.0f, newInputRange);
+
+        if (curve)
+            rebuild();
+    }
+
+    template <typename SampleType>
+    void TableShaper<SampleType>::rebuild()
+    {
+        // Whatever the audio thread swapped out last time is no longer in use
+        delete retired.exchange(nullptr);
+
+        auto table = std::make_unique<Table>();
+        table->segments.resize(numSegments);
+
+        const double range = inputRange;
+        const double step = 2.0 * range / numSegments;
+
+        // Nodes -range - step .. range + step: every segment also sees its outer neighbours
+        std::vector<double> nodes(numSegments + 3);
+
+        for (size_t i = 0; i < nodes.size(); ++i)
+            nodes[i] = curve(-range + ((double) i - 1.0) * step);
+
+        for (int i = 0; i < numSegments; ++i)
+        {
+            const double v0 = nodes[(size_t) i];
+            const double v1 = nodes[(size_t) i + 1];
+            const double v2 = nodes[(size_t) i + 2];
+            const double v3 = nodes[(size_t) i + 3];
+
+            auto& segment = table->segments[(size_t) i];
+            segment.c0 = (SampleType) v1;
+            segment.c1 = (SampleType) (0.5 * (v2 - v0));
+            segment.c2 = (SampleType) (v0 - 2.5 * v1 + 2.0 * v2 - 0.5 * v3);
+            segment.c3 = (SampleType) (0.5 * (v3 - v0) + 1.5 * (v1 - v2));
+        }
+
+        table->scale = (SampleType) (1.0 / step);
+        table->offset = (SampleType) (range / step);
+
+        // A table the audio thread never picked up can go straight away
+        delete pending.exchange(table.release());
+    }
+
+    // --- --- PROCESSING --- ---
+    template <typename SampleType>
+    void TableShaper<SampleType>::acquireLatestTable() noexcept
+    {
+        // Only swap while retired is free, so the old table always has somewhere to go
+        if (pending.load(std::memory_order_acquire) == nullptr || retired.load(std::memory_order_acquire) != nullptr)
+            return;
+
+        if (Table* next = pending.exchange(nullptr, std::memory_order_acq_rel))
+        {
+            retired.store(active.release(), std::memory_order_release);
+            active.reset(next);
+        }
+    }
+
+    template <typename SampleType>
+    SampleType TableShaper<SampleType>::evaluate(const Table& table, SampleType sample) noexcept
+    {
+        constexpr SampleType lastPosition = (SampleType) numSegments;
+
+        // Written so NaN fails the comparison and lands on 0: jlimit would pass it on to the index
+        const SampleType scaled = sample * table.scale + table.offset;
+        const SampleType position = scaled > (SampleType) 0 ? juce::jmin(scaled, lastPosition) : (SampleType) 0;
+        const int index = juce::jmin((int) position, numSegments - 1);
+        const SampleType t = position - (SampleType) index;
+        const Segment& segment = table.segments[(size_t) index];
+
+        return segment.c0 + t * (segment.c1 + t * (segment.c2 + t * segment.c3));
+    }
+
+    template <typename SampleType>
+    SampleType TableShaper<SampleType>::processSample(SampleType sample) const noexcept
+    {
+        return active != nullptr ? evaluate(*active, sample) : sample;
+    }
+
+    template <typename SampleType>
+    void TableShaper<SampleType>::processBuffer(juce::AudioBuffer<SampleType>& inputBuffer)
+    {
+        acquireLatestTable();
+
+        if (active == nullptr)
+            return;
+
+        const Table& table = *active;
+        const int numSamples = inputBuffer.getNumSamples();
+        const int numChannels = inputBuffer.getNumChannels();
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            SampleType* channelData = inputBuffer.getWritePointer(channel);
+            for (int sample = 0; sample < numSamples; ++sample)
+                channelData[sample] = evaluate(table, channelData[sample]);
+        }
+    }
+
+    template class TableShaper<float>;
+    template class TableShaper<double>;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+/**
+ * @class TableShaper
+ * @brief Bakes any memoryless transfer curve into a lookup table with cubic interpolation
+ *
+ * Costs the same few multiplies per sample whatever the curve is: a clipper with its drive and
+ * bias, TubeModel's transfer and harmonics, anything callable as double -> double.
+ *
+ *     punk_dsp::Waveshaper<float> clipper;    // Only ever touched by setCurve()
+ *     punk_dsp::TableShaper<float> shaper;
+ *
+ *     // Message thread, whenever drive / bias change
+ *     clipper.setDrive (driveParam);
+ *     shaper.setCurve ([&clipper] (double x) { return (double) clipper.applyATanClipper ((float) x); });
+ *
+ *     // Audio thread
+ *     shaper.processBuffer (buffer);
+ *
+ * setCurve() samples the curve over [-inputRange, inputRange] on the calling thread and stores a
+ * Catmull-Rom cubic per segment as four contiguous coefficients (32 KB in float), so each sample
+ * reads one 16-byte record instead of four scattered neighbours and evaluates it branch-free.
+ * Inputs beyond the range hold the edge values; NaN reads the lower edge.
+ *
+ * Rebuilding never blocks or allocates on the audio thread: setCurve() publishes the new table
+ * through an atomic pointer and processBuffer() (or acquireLatestTable()) swaps it in at the
+ * start of the next block. The table it replaces is freed by the next setCurve(). Call
+ * setCurve() and setInputRange() from one non-audio thread. Until the first setCurve(), the
+ * shaper passes audio through.
+ */
+namespace punk_dsp
+{
+    template <typename SampleType>
+    class TableShaper
+    {
+    public:
+        using Curve = std::function<double (double)>;
+
+        static constexpr int numSegments = 2048;
+
+        TableShaper();
+        ~TableShaper();
+
+        // Message thread: bake curve and publish it
+        void setCurve(Curve newCurve);
+        void setInputRange(float newInputRange);    // Rebuilds the current curve, default 2.0
+
+        // Audio thread: swap in the latest table. processBuffer() calls it, processSample() doesn't
+        void acquireLatestTable() noexcept;
+
+        SampleType processSample(SampleType sample) const noexcept;
+        void processBuffer(juce::AudioBuffer<SampleType>& inputBuffer);
+
+    private:
+        struct alignas(4 * sizeof(SampleType)) Segment
+        {
+            SampleType c0, c1, c2, c3;   // c0 + t (c1 + t (c2 + t c3)), t in [0, 1)
+        };
+
+        struct Table
+        {
+            std::vector<Segment> segments;  // numSegments
+            SampleType scale, offset;       // Input -> segment position
+        };
+
+        void rebuild();
+        static SampleType evaluate(const Table& table, SampleType sample) noexcept;
+
+        // Message thread
+        Curve curve;
+        float inputRange { 2.0f };
+
+        // Handover: the message thread fills pending, the audio thread moves it into active and
+        // parks the old active in retired, for the message thread to free
+        std::atomic<Table*> pending { nullptr };
+        std::atomic<Table*> retired { nullptr };
+
+        // Audio thread
+        std::unique_ptr<Table> active;
+
+        // --- Prevent copy and move ---
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TableShaper)
+    };
+}
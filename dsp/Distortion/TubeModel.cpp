@@ -2,66 +2,95 @@
 
 namespace punk_dsp
 {
-    TubeModel::TubeModel()
+    template <typename SampleType>
+    TubeModel<SampleType>::TubeModel()
     {
     }
 
     // --- --- PARAMETER UPDATES --- --
-    void TubeModel::setDrive(float newDrive)
+    template <typename SampleType>
+    void TubeModel<SampleType>::setDrive(float newDrive)
     {
         drive = newDrive;
     }
 
-    void TubeModel::setOutGain(float newOutGain)
+    template <typename SampleType>
+    void TubeModel<SampleType>::setOutGain(float newOutGain)
     {
         outGain = newOutGain;
     }
 
-    void TubeModel::setBiasPre(float newBiasPre)
+    template <typename SampleType>
+    void TubeModel<SampleType>::setBiasPre(float newBiasPre)
     {
         biasPre = juce::jlimit(-1.0f, 1.0f, newBiasPre);
     }
 
-    void TubeModel::setBiasPost(float newBiasPost)
+    template <typename SampleType>
+    void TubeModel<SampleType>::setBiasPost(float newBiasPost)
     {
         biasPost = juce::jlimit(-1.0f, 1.0f, newBiasPost);
     }
 
-    void TubeModel::setCoeffPos(float newCoeffPos)
+    template <typename SampleType>
+    void TubeModel<SampleType>::setCoeffPos(float newCoeffPos)
     {
         coeffPos = juce::jlimit(0.0f, 2.0f, newCoeffPos);
     }
 
-    void TubeModel::setCoeffNeg(float newCoeffNeg)
+    template <typename SampleType>
+    void TubeModel<SampleType>::setCoeffNeg(float newCoeffNeg)
     {
         coeffNeg = juce::jlimit(0.0f, 2.0f, newCoeffNeg);
     }
 
-    void TubeModel::setHarmonicGain(float newHarmGain)
+    template <typename SampleType>
+    void TubeModel<SampleType>::setHarmonicGain(float newHarmGain)
     {
         harmonicGain = newHarmGain;
     }
     
-    void TubeModel::setHarmonicBalance(float newBalance)
+    template <typename SampleType>
+    void TubeModel<SampleType>::setHarmonicBalance(float newBalance)
     {
         harmonicBalance = juce::jlimit(0.0f, 1.0f, newBalance);
     }
 
-    void TubeModel::setHarmonicSidechain(bool usePostDrive)
+    template <typename SampleType>
+    void TubeModel<SampleType>::setHarmonicSidechain(bool usePostDrive)
     {
         harmonicSidechain = usePostDrive;
     }
 
-    void TubeModel::setSagTime(float time_ms)
+    template <typename SampleType>
+    void TubeModel<SampleType>::setSagTime(float time_ms)
     {
         sagTime = juce::jlimit(0.1f, 100.0f, time_ms);
     }
 
     // --- --- PROCESSING --- ---
-    float TubeModel::processSample(float sample)
+    template <typename SampleType>
+    SampleType TubeModel<SampleType>::processSample(SampleType sample)
     {
-        float x = (sample + biasPre) * drive + biasPost;
-        float output = 0.0f;
+        SampleType x = (sample + biasPre) * drive + biasPost;
+        SampleType shaped = applyTransfer(x);
+
+        calculateSag(x);
+
+        return shaped * sagResponse * outGain;
+    }
+
+    template <typename SampleType>
+    SampleType TubeModel<SampleType>::processStatic(SampleType sample) const
+    {
+        SampleType x = (sample + biasPre) * drive + biasPost;
+        return applyTransfer(x) * outGain;
+    }
+
+    template <typename SampleType>
+    SampleType TubeModel<SampleType>::applyTransfer(SampleType x) const
+    {
+        SampleType output = 0.0f;
 
         // Asymmetric transfer function
         if (x > 0.0f)
@@ -70,40 +99,44 @@ namespace punk_dsp
             output = x / (1.0f + coeffNeg * std::abs(x));
 
         // Generate harmonics
-        float harmonics = 0.0f;
+        SampleType harmonics = 0.0f;
         if (harmonicSidechain)
             harmonics = harmonicGain * addHarmonics(output);
         else
             harmonics = harmonicGain * addHarmonics(x);
 
-        calculateSag(x);
-
-        return (output + harmonics) * sagResponse * outGain;
+        return output + harmonics;
     }
 
-    void TubeModel::processBuffer(juce::AudioBuffer<float>& inputBuffer)
+    template <typename SampleType>
+    void TubeModel<SampleType>::processBuffer(juce::AudioBuffer<SampleType>& inputBuffer)
     {
         const int numSamples = inputBuffer.getNumSamples();
         const int numChannels = inputBuffer.getNumChannels();
 
         for (int channel = 0; channel < numChannels; ++channel)
         {
-            float* channelData = inputBuffer.getWritePointer(channel);
+            SampleType* channelData = inputBuffer.getWritePointer(channel);
             for (int sample = 0; sample < numSamples; ++sample)
                 channelData[sample] = processSample(channelData[sample]);
         }
     }
 
     // --- --- EXTRA STEPS --- ---
-    float TubeModel::addHarmonics(float inputSignal)
+    template <typename SampleType>
+    SampleType TubeModel<SampleType>::addHarmonics(SampleType inputSignal) const
     {
-        return harmonicBalance * juce::dsp::FastMathApproximations::sin(2.0f * juce::MathConstants<float>::pi * inputSignal) + (1.0f - harmonicBalance) * juce::dsp::FastMathApproximations::sin(3.0f * juce::MathConstants<float>::pi * inputSignal);
+        return harmonicBalance * juce::dsp::FastMathApproximations::sin(2.0f * juce::MathConstants<SampleType>::pi * inputSignal) + (1.0f - harmonicBalance) * juce::dsp::FastMathApproximations::sin(3.0f * juce::MathConstants<SampleType>::pi * inputSignal);
     }
 
-    void TubeModel::calculateSag(float inputSignal)
+    template <typename SampleType>
+    void TubeModel<SampleType>::calculateSag(SampleType inputSignal)
     {
-        float signalMagnitude = std::abs(inputSignal);
-        float decayFactor = std::exp(-0.001f * signalMagnitude * (1000.0f / sagTime));
-        sagResponse = std::max(0.1f, sagResponse * decayFactor + 0.01f * signalMagnitude);
+        SampleType signalMagnitude = std::abs(inputSignal);
+        SampleType decayFactor = std::exp(-0.001f * signalMagnitude * (1000.0f / sagTime));
+        sagResponse = juce::jmax((SampleType) 0.1, sagResponse * decayFactor + 0.01f * signalMagnitude);
     }
+
+    template class TubeModel<float>;
+    template class TubeModel<double>;
 }
\ No newline at end of file
@@ -10,14 +10,19 @@
  */
 namespace punk_dsp
 {
+    template <typename SampleType>
     class TubeModel
     {
     public:
         TubeModel();
         ~TubeModel() = default;
 
-        float processSample(float sample);
-        void processBuffer(juce::AudioBuffer<float>& inputBuffer);
+        SampleType processSample(SampleType sample);
+        void processBuffer(juce::AudioBuffer<SampleType>& inputBuffer);
+
+        // The memoryless part of processSample(): transfer function and harmonics, without sag.
+        // Stateless, so it can be baked into a TableShaper
+        SampleType processStatic(SampleType sample) const;
 
         // Parameter Updates
         void setDrive(float newDrive);
@@ -50,12 +55,13 @@ namespace punk_dsp
         bool harmonicSidechain { true };
 
         float sagTime { 100.0f };   // Milliseconds - if set to 100ms, sagResponse stays at 1.0 = no sag
-        float sagResponse { 1.0f }; // 1.0 = no sag, <1.0 = reduced gain
-        float sagLastSample { 0.0f };
+        SampleType sagResponse { 1.0f }; // 1.0 = no sag, <1.0 = reduced gain
+        SampleType sagLastSample { 0.0f };
 
         // Extra processing
-        float addHarmonics(float inputSignal);
-        void calculateSag(float inputSignal);
+        SampleType applyTransfer(SampleType x) const;
+        SampleType addHarmonics(SampleType inputSignal) const;
+        void calculateSag(SampleType inputSignal);
 
         // --- Prevent copy and move ---
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TubeModel)
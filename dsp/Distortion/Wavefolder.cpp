@@ -2,59 +2,105 @@
 
 namespace punk_dsp
 {
-    Wavefolder::Wavefolder()
+    namespace
     {
+        template <typename SampleType>
+        using FoldRegister = juce::dsp::SIMDRegister<SampleType>;
+
+        // Reflecting x about +-limit until it lands in range is a triangle wave of x, period
+        // 4 * limit: with phase = (x + limit) * scale, fold = limit * (4 |phase - round(phase)| - 1).
+        // The wave is even in phase, so rounding |phase| is one truncation. Phases are capped at
+        // 2^22 (float's last fractional bit) to stay in int range; in-range samples pass untouched.
+        constexpr double maxFoldPhase = 4194304.0;
+
+        template <typename SampleType>
+        SampleType foldTriangle(SampleType x, SampleType limit, SampleType scale) noexcept
+        {
+            const SampleType phase = juce::jmin(std::abs(x + limit) * scale, (SampleType) maxFoldPhase);
+            const SampleType whole = (SampleType) (int) (phase + (SampleType) 0.5);
+            const SampleType folded = limit * ((SampleType) 4 * std::abs(phase - whole) - (SampleType) 1);
+
+            return std::abs(x) <= limit ? x : folded;
+        }
+
+        // Same arithmetic, a register at a time
+        template <typename SampleType>
+        FoldRegister<SampleType> foldTriangle(FoldRegister<SampleType> x, FoldRegister<SampleType> limit,
+                                              FoldRegister<SampleType> scale) noexcept
+        {
+            using SIMDType = FoldRegister<SampleType>;
+
+            const SIMDType phase = SIMDType::min(SIMDType::abs(x + limit) * scale, SIMDType::expand((SampleType) maxFoldPhase));
+            const SIMDType whole = SIMDType::truncate(phase + SIMDType::expand((SampleType) 0.5));
+            const SIMDType folded = limit * (SIMDType::expand((SampleType) 4) * SIMDType::abs(phase - whole) - SIMDType::expand((SampleType) 1));
+            const SIMDType magnitude = SIMDType::abs(x);
+
+            return (x & SIMDType::lessThanOrEqual(magnitude, limit)) + (folded & SIMDType::greaterThan(magnitude, limit));
+        }
+    }
+
+    template <typename SampleType>
+    Wavefolder<SampleType>::Wavefolder()
+    {
+        setThreshold(threshold);
     }
 
     // --- --- PARAMETER UPDATES --- --
-    void Wavefolder::setDrive(float newDrive)
+    template <typename SampleType>
+    void Wavefolder<SampleType>::setDrive(float newDrive)
     {
         drive = newDrive;
     }
 
-    void Wavefolder::setOutGain(float newOutGain)
+    template <typename SampleType>
+    void Wavefolder<SampleType>::setOutGain(float newOutGain)
     {
         outGain = newOutGain;
     }
 
-    void Wavefolder::setBiasPre(float newBiasPre)
+    template <typename SampleType>
+    void Wavefolder<SampleType>::setBiasPre(float newBiasPre)
     {
         biasPre = juce::jlimit(-1.0f, 1.0f, newBiasPre);
     }
 
-    void Wavefolder::setBiasPost(float newBiasPost)
+    template <typename SampleType>
+    void Wavefolder<SampleType>::setBiasPost(float newBiasPost)
     {
         biasPost = juce::jlimit(-1.0f, 1.0f, newBiasPost);
     }
 
-    void Wavefolder::setThreshold(float newThres)
+    template <typename SampleType>
+    void Wavefolder<SampleType>::setThreshold(float newThres)
     {
         threshold = juce::jlimit(-1.0f, 1.0f, newThres);
+
+        // Fold into +-|threshold|; at 0 the wet signal collapses to +-minFoldLimit (silence)
+        // instead of dividing by zero
+        foldLimit = (SampleType) juce::jmax(std::abs(threshold), minFoldLimit);
+        foldScale = (SampleType) 1 / ((SampleType) 4 * foldLimit);
     }
 
-    void Wavefolder::setMix(float newMix)
+    template <typename SampleType>
+    void Wavefolder<SampleType>::setMix(float newMix)
     {
         mix = juce::jlimit(0.0f, 1.0f, newMix);
     }
 
     // --- --- SAMPLE PROCESSING --- ---
-    float Wavefolder::foldToRangeSample(float sample)
+    template <typename SampleType>
+    SampleType Wavefolder<SampleType>::foldToRangeSample(SampleType sample)
     {
         auto x = drive * (sample + biasPre) + biasPost;
 
-        // Fold the wave when it exceeds the threshold
-        while (std::abs(x) > threshold)
-        {
-            if (x > threshold)
-                x = 2.0f * threshold - x;
-            else if (x < -threshold)
-                x = -2.0f * threshold - x;
-        }
+        // Fold the wave back whenever it exceeds the threshold
+        x = foldTriangle(x, foldLimit, foldScale);
 
         return outGain * (x * mix + sample * (1.0f - mix));
     }
 
-    float Wavefolder::foldSinSample(float sample)
+    template <typename SampleType>
+    SampleType Wavefolder<SampleType>::foldSinSample(SampleType sample)
     {
         auto x = drive * (sample + biasPre) + biasPost;
 
@@ -62,61 +108,91 @@ namespace punk_dsp
         return outGain * (juce::dsp::FastMathApproximations::sin(x) * mix + sample * (1.0f - mix));
     }
 
-    float Wavefolder::extraFoldToRangeSample(float sample)
+    template <typename SampleType>
+    SampleType Wavefolder<SampleType>::extraFoldToRangeSample(SampleType sample)
     {
-        while (std::abs(sample) > threshold)
-        {
-            if (sample > threshold)
-                sample = 2.0f * threshold - sample;
-            else if (sample < -threshold)
-                sample = -2.0f * threshold - sample;
-        }
-        return sample;
+        return foldTriangle(sample, foldLimit, foldScale);
     }
 
-    float Wavefolder::comboFoldSample(float sample)
+    template <typename SampleType>
+    SampleType Wavefolder<SampleType>::comboFoldSample(SampleType sample)
     {
         // Sine wave folding -> foldToRange folding
         return extraFoldToRangeSample( foldSinSample(sample) );
     }
 
     // --- --- BUFFER PROCESSING --- ---
-    void Wavefolder::foldToRangeBuffer(juce::AudioBuffer<float>& inputBuffer)
+    template <typename SampleType>
+    void Wavefolder<SampleType>::foldToRangeBuffer(juce::AudioBuffer<SampleType>& inputBuffer)
     {
+        using SIMDType = FoldRegister<SampleType>;
+        constexpr int lanes = (int) SIMDType::SIMDNumElements;
+
         const int numSamples = inputBuffer.getNumSamples();
         const int numChannels = inputBuffer.getNumChannels();
 
+        // foldToRangeSample() with the parameters hoisted into registers
+        const SIMDType inDrive    = SIMDType::expand((SampleType) drive);
+        const SIMDType inBiasPre  = SIMDType::expand((SampleType) biasPre);
+        const SIMDType inBiasPost = SIMDType::expand((SampleType) biasPost);
+        const SIMDType limit      = SIMDType::expand(foldLimit);
+        const SIMDType scale      = SIMDType::expand(foldScale);
+        const SIMDType wetGain    = SIMDType::expand((SampleType) mix);
+        const SIMDType dryGain    = SIMDType::expand((SampleType) (1.0f - mix));
+        const SIMDType gain       = SIMDType::expand((SampleType) outGain);
+
         for (int channel = 0; channel < numChannels; ++channel)
         {
-            float* channelData = inputBuffer.getWritePointer(channel);
-            for (int sample = 0; sample < numSamples; ++sample)
+            SampleType* channelData = inputBuffer.getWritePointer(channel);
+
+            // Scalar up to the first aligned sample and after the last whole register
+            const int head = juce::jmin(numSamples, (int) (SIMDType::getNextSIMDAlignedPtr(channelData) - channelData));
+            const int tail = head + (numSamples - head) / lanes * lanes;
+
+            for (int sample = 0; sample < head; ++sample)
+                channelData[sample] = foldToRangeSample(channelData[sample]);
+
+            for (int sample = head; sample < tail; sample += lanes)
+            {
+                const SIMDType input = SIMDType::fromRawArray(channelData + sample);
+                const SIMDType x = inDrive * (input + inBiasPre) + inBiasPost;
+
+                (gain * (foldTriangle(x, limit, scale) * wetGain + input * dryGain)).copyToRawArray(channelData + sample);
+            }
+
+            for (int sample = tail; sample < numSamples; ++sample)
                 channelData[sample] = foldToRangeSample(channelData[sample]);
         }
     }
 
-    void Wavefolder::foldSinBuffer(juce::AudioBuffer<float>& inputBuffer)
+    template <typename SampleType>
+    void Wavefolder<SampleType>::foldSinBuffer(juce::AudioBuffer<SampleType>& inputBuffer)
     {
         const int numSamples = inputBuffer.getNumSamples();
         const int numChannels = inputBuffer.getNumChannels();
 
         for (int channel = 0; channel < numChannels; ++channel)
         {
-            float* channelData = inputBuffer.getWritePointer(channel);
+            SampleType* channelData = inputBuffer.getWritePointer(channel);
             for (int sample = 0; sample < numSamples; ++sample)
                 channelData[sample] = foldSinSample(channelData[sample]);
         }
     }
 
-    void Wavefolder::comboFoldBuffer(juce::AudioBuffer<float>& inputBuffer)
+    template <typename SampleType>
+    void Wavefolder<SampleType>::comboFoldBuffer(juce::AudioBuffer<SampleType>& inputBuffer)
     {
         const int numSamples = inputBuffer.getNumSamples();
         const int numChannels = inputBuffer.getNumChannels();
 
         for (int channel = 0; channel < numChannels; ++channel)
         {
-            float* channelData = inputBuffer.getWritePointer(channel);
+            SampleType* channelData = inputBuffer.getWritePointer(channel);
             for (int sample = 0; sample < numSamples; ++sample)
                 channelData[sample] = comboFoldSample(channelData[sample]);
         }
     }
+
+    template class Wavefolder<float>;
+    template class Wavefolder<double>;
 }
@@ -7,15 +7,18 @@
  *
  * Features:
  *  - Drive (dB) with multiplicative smoothing
- *  - Threshold (fold limit, linear amplitude)
+ *  - Threshold (fold limit, linear amplitude): folds into +-|threshold|, 0 folds to silence
  *  - Symmetry (-1 .. +1): adjusts positive vs. negative fold limits
  *  - Bias (pre-fold DC offset)
  *  - Stages: cascaded folders (1..N)
  *  - Dry/Wet mix
  *  - Output gain (dB)
  *
+ * Folding to range is closed form (a triangle wave of the input), so its cost per sample does
+ * not depend on drive or level. foldToRangeBuffer() runs it a SIMDRegister at a time.
+ *
  * Usage:
- *    Wavefolder wf;
+ *    Wavefolder<float> wf;
  *    wf.prepare ({ sampleRate, (uint32) blockSize, (uint32) numChannels });
  *    wf.setDriveDecibels (18.0f);
  *    wf.setThreshold (0.5f);
@@ -28,6 +31,7 @@
  */
 namespace punk_dsp
 {
+    template <typename SampleType>
     class Wavefolder
     {
     public:
@@ -42,17 +46,19 @@ namespace punk_dsp
         void setMix (float newMix);
         
         // Sample processing
-        float foldToRangeSample(float sample);
-        float foldSinSample(float sample);
-        float comboFoldSample(float sample);
-        float extraFoldToRangeSample(float sample);
+        SampleType foldToRangeSample(SampleType sample);
+        SampleType foldSinSample(SampleType sample);
+        SampleType comboFoldSample(SampleType sample);
+        SampleType extraFoldToRangeSample(SampleType sample);
         
         // Buffer processing
-        void foldToRangeBuffer(juce::AudioBuffer<float>& inputBuffer);
-        void foldSinBuffer(juce::AudioBuffer<float>& inputBuffer);
-        void comboFoldBuffer(juce::AudioBuffer<float>& inputBuffer);
+        void foldToRangeBuffer(juce::AudioBuffer<SampleType>& inputBuffer);
+        void foldSinBuffer(juce::AudioBuffer<SampleType>& inputBuffer);
+        void comboFoldBuffer(juce::AudioBuffer<SampleType>& inputBuffer);
        
     private:
+        static constexpr float minFoldLimit = 1.0e-6f;
+
         // Parameters
         float drive     { 1.0f };   // linear
         float outGain   { 1.0f };   // linear
@@ -60,5 +66,9 @@ namespace punk_dsp
         float biasPre   { 0.0f };   // [-1..1]
         float biasPost  { 0.0f };   // pre-fold offset
         float mix       { 1.0f };   // wet
+
+        // Derived from threshold: fold range +-foldLimit, foldScale = 1 / (4 * foldLimit)
+        SampleType foldLimit { 0 };
+        SampleType foldScale { 0 };
     };
 }
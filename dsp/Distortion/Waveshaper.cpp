@@ -2,111 +2,409 @@
 
 namespace punk_dsp
 {
-    Waveshaper::Waveshaper()
+    namespace
     {
+        // Clipper shapes in the driven domain u. clip() is the plain clipper, given the gain from
+        // outputGain(): inlined into the block loop and the sample methods alike. For ADAA: f, its
+        // antiderivatives F1 and F2 (both zero at 0, even and odd) and the output scale on outGain
+        struct SoftClipShape
+        {
+            static constexpr int id = 0;
+            static constexpr double scale = 1.0;
+
+            template <typename T> static T outputGain (float outGain)   { return (T) outGain; }
+            template <typename T> static T clip (T u, T gain)           { return gain * u / (std::abs (u) + (T) 1); }
+
+            static double f (double u)  { return u / (std::abs (u) + 1.0); }
+            static double F1 (double u) { const double a = std::abs (u); return a - std::log1p (a); }
+            static double F2 (double u) { const double a = std::abs (u); return std::copysign (0.5 * a * a + a - (1.0 + a) * std::log1p (a), u); }
+        };
+
+        struct HardClipShape
+        {
+            static constexpr int id = 1;
+            static constexpr double scale = 1.0;
+
+            // Clamping first lands on the same +-2/3 plateau as branching on |u| > 1, branch-free
+            // (written so u = 1 rounds to exactly 2/3)
+            template <typename T> static T outputGain (float outGain)   { return (T) outGain; }
+
+            template <typename T> static T clip (T u, T gain)
+            {
+                u = std::max ((T) -1, std::min ((T) 1, u));
+                return gain * (u * ((T) 3 - u * u) / (T) 3);
+            }
+
+            static double f (double u)
+            {
+                return std::abs (u) > 1.0 ? std::copysign (2.0 / 3.0, u) : u - u * u * u / 3.0;
+            }
+
+            static double F1 (double u)
+            {
+                const double u2 = u * u;
+                return std::abs (u) > 1.0 ? 2.0 / 3.0 * std::abs (u) - 0.25 : u2 * (0.5 - u2 / 12.0);
+            }
+
+            static double F2 (double u)
+            {
+                const double a = std::abs (u);
+                return a > 1.0 ? std::copysign (a * a / 3.0 - a * 0.25 + 1.0 / 15.0, u) : u * u * u * (1.0 / 6.0 - u * u / 60.0);
+            }
+        };
+
+        // The exact tanh: the plain applyTanhClipper() uses the fast approximation
+        struct TanhClipShape
+        {
+            static constexpr int id = 2;
+            static constexpr double scale = 2.0 / juce::MathConstants<double>::pi;
+            static constexpr double ln2 = 0.693147180559945309417;
+
+            template <typename T> static T outputGain (float outGain)   { return (T) (outGain * 2.0f) / juce::MathConstants<T>::pi; }
+            template <typename T> static T clip (T u, T gain)           { return gain * juce::dsp::FastMathApproximations::tanh (u); }
+
+            static double f (double u)  { return std::tanh (u); }
+
+            // ln cosh, without overflowing cosh
+            static double F1 (double u) { const double a = std::abs (u); return a + std::log1p (std::exp (-2.0 * a)) - ln2; }
+
+            // a^2 / 2 - a ln2 + Li2 (-e^-2a) / 2 + pi^2 / 24, with Li2 (z) = -Li2 (z / (z - 1)) - ln^2 (1 - z) / 2
+            // so the series only ever sees arguments in (0, 0.5]
+            static double F2 (double u)
+            {
+                const double a = std::abs (u);
+
+                // Near 0 the terms below cancel down to ~u^3 / 6: use its series
+                if (a < 0.1)
+                {
+                    const double u2 = u * u;
+                    return u * u2 * (1.0 / 6.0 - u2 * (1.0 / 60.0 - u2 * (1.0 / 315.0 - u2 * 17.0 / 22680.0)));
+                }
+
+                const double e = std::exp (-2.0 * a);
+                const double y = e / (1.0 + e);
+                const double log1e = std::log1p (e);
+
+                double series = 0.0, power = y;
+
+                for (int k = 1; power > 1.0e-17 * k * k; ++k, power *= y)
+                    series += power / (double) (k * k);
+
+                const double li2 = -series - 0.5 * log1e * log1e;
+                const double pi = juce::MathConstants<double>::pi;
+
+                return std::copysign (0.5 * a * a - a * ln2 + 0.5 * li2 + pi * pi / 24.0, u);
+            }
+        };
+
+        struct ATanClipShape
+        {
+            static constexpr int id = 3;
+            static constexpr double scale = 2.0 / juce::MathConstants<double>::pi;
+
+            template <typename T> static T outputGain (float outGain)   { return (T) (outGain * 2.0f) / juce::MathConstants<T>::pi; }
+            template <typename T> static T clip (T u, T gain)           { return gain * std::atan (u); }
+
+            static double f (double u)  { return std::atan (u); }
+            static double F1 (double u) { return u * std::atan (u) - 0.5 * std::log1p (u * u); }
+            static double F2 (double u) { return 0.5 * ((u * u - 1.0) * std::atan (u) + u - u * std::log1p (u * u)); }
+        };
+
+        // Below these input steps the divided differences lose their digits: expand around the
+        // midpoint instead. Second order divides twice, so it gives up sooner
+        constexpr double adaaTolerance = 1.0e-5;
+        constexpr double adaa2Tolerance = 1.0e-4;
+    }
+
+    template <typename SampleType>
+    Waveshaper<SampleType>::Waveshaper()
+    {
+    }
+
+    template <typename SampleType>
+    void Waveshaper<SampleType>::prepare(const juce::dsp::ProcessSpec& spec)
+    {
+        adaaStates.assign(spec.numChannels, {});
+    }
+
+    template <typename SampleType>
+    void Waveshaper<SampleType>::reset()
+    {
+        std::fill(adaaStates.begin(), adaaStates.end(), ADAAState {});
     }
 
     // --- --- PARAMETER UPDATES --- --
-    void Waveshaper::setDrive(float newDrive)
+    template <typename SampleType>
+    void Waveshaper<SampleType>::setDrive(float newDrive)
     {
         drive = newDrive;
     }
 
-    void Waveshaper::setOutGain(float newOutGain)
+    template <typename SampleType>
+    void Waveshaper<SampleType>::setOutGain(float newOutGain)
     {
         outGain = newOutGain;
     }
 
-    void Waveshaper::setBiasPre(float newBiasPre)
+    template <typename SampleType>
+    void Waveshaper<SampleType>::setBiasPre(float newBiasPre)
     {
         biasPre = juce::jlimit(-1.0f, 1.0f, newBiasPre);
     }
 
-    void Waveshaper::setBiasPost(float newBiasPost)
+    template <typename SampleType>
+    void Waveshaper<SampleType>::setBiasPost(float newBiasPost)
     {
         biasPost = juce::jlimit(-1.0f, 1.0f, newBiasPost);
     }
 
+    template <typename SampleType>
+    void Waveshaper<SampleType>::setADAAOrder(ADAAOrder newOrder)
+    {
+        adaaOrder = newOrder;
+    }
+
+    template <typename SampleType>
+    void Waveshaper<SampleType>::setClipper(ClipperType newClipper)
+    {
+        clipper = newClipper;
+    }
+
     // --- --- SAMPLE PROCESSING --- ---
-    float Waveshaper::applySoftClipper(float sample)
+    template <typename SampleType>
+    SampleType Waveshaper<SampleType>::applySoftClipper(SampleType sample)
     {
         sample = drive * (biasPre + sample) + biasPost;
-        return outGain * sample / (std::abs(sample) + 1.0f);
+        return SoftClipShape::clip(sample, SoftClipShape::outputGain<SampleType>(outGain));
     }
 
-    float Waveshaper::applyHardClipper(float sample)
+    template <typename SampleType>
+    SampleType Waveshaper<SampleType>::applyHardClipper(SampleType sample)
     {
         sample = drive * (biasPre + sample) + biasPost;
-        if (sample > 1.0f)
-            return outGain * 2.0f / 3.0f;
-        else if (sample < -1.0f)
-            return outGain * -2.0f / 3.0f;
-        else
-            return outGain * (sample - std::pow(sample, 3.0f) / 3.0f);
+        return HardClipShape::clip(sample, HardClipShape::outputGain<SampleType>(outGain));
     }
 
-    float Waveshaper::applyTanhClipper(float sample)
+    template <typename SampleType>
+    SampleType Waveshaper<SampleType>::applyTanhClipper(SampleType sample)
     {
         sample = drive * (biasPre + sample) + biasPost;
-        return outGain * 2.0f / juce::MathConstants<float>::pi * juce::dsp::FastMathApproximations::tanh(sample);
+        return TanhClipShape::clip(sample, TanhClipShape::outputGain<SampleType>(outGain));
     }
 
-    float Waveshaper::applyATanClipper(float sample)
+    template <typename SampleType>
+    SampleType Waveshaper<SampleType>::applyATanClipper(SampleType sample)
     {
         sample = drive * (biasPre + sample) + biasPost;
-        return outGain * 2.0f / juce::MathConstants<float>::pi * std::atan(sample);
+        return ATanClipShape::clip(sample, ATanClipShape::outputGain<SampleType>(outGain));
     }
 
-    // --- --- BUFFER PROCESSING --- ---
-    void Waveshaper::applySoftClipper(juce::AudioBuffer<float>& inputBuffer)
+    // --- --- ADAA SAMPLE PROCESSING --- ---
+    template <typename SampleType>
+    SampleType Waveshaper<SampleType>::applySoftClipper(int channel, SampleType sample)
     {
-        const int numSamples = inputBuffer.getNumSamples();
-        const int numChannels = inputBuffer.getNumChannels();
+        if (adaaOrder == ADAAOrder::Off || channel >= (int) adaaStates.size())
+            return applySoftClipper(sample);
 
-        for (int channel = 0; channel < numChannels; ++channel)
+        return applyADAA<SoftClipShape>(channel, sample);
+    }
+
+    template <typename SampleType>
+    SampleType Waveshaper<SampleType>::applyHardClipper(int channel, SampleType sample)
+    {
+        if (adaaOrder == ADAAOrder::Off || channel >= (int) adaaStates.size())
+            return applyHardClipper(sample);
+
+        return applyADAA<HardClipShape>(channel, sample);
+    }
+
+    template <typename SampleType>
+    SampleType Waveshaper<SampleType>::applyTanhClipper(int channel, SampleType sample)
+    {
+        if (adaaOrder == ADAAOrder::Off || channel >= (int) adaaStates.size())
+            return applyTanhClipper(sample);
+
+        return applyADAA<TanhClipShape>(channel, sample);
+    }
+
+    template <typename SampleType>
+    SampleType Waveshaper<SampleType>::applyATanClipper(int channel, SampleType sample)
+    {
+        if (adaaOrder == ADAAOrder::Off || channel >= (int) adaaStates.size())
+            return applyATanClipper(sample);
+
+        return applyADAA<ATanClipShape>(channel, sample);
+    }
+
+    template <typename SampleType>
+    template <typename Shape>
+    SampleType Waveshaper<SampleType>::applyADAA(int channel, SampleType sample)
+    {
+        auto& state = adaaStates[(size_t) channel];
+        const double x = (double) drive * ((double) biasPre + (double) sample) + (double) biasPost;
+        const double y = adaaOrder == ADAAOrder::FirstOrder ? processADAA<Shape, ADAAOrder::FirstOrder>(state, x)
+                                                            : processADAA<Shape, ADAAOrder::SecondOrder>(state, x);
+
+        return (SampleType) ((double) outGain * Shape::scale * y);
+    }
+
+    template <typename SampleType>
+    template <typename Shape, ADAAOrder order>
+    double Waveshaper<SampleType>::processADAA(ADAAState& state, double x)
+    {
+        constexpr int kernel = Shape::id * 3 + (int) order;
+
+        // The cache holds antiderivatives of another shape or order: rebuild it from the inputs
+        if (state.cachedKernel != kernel)
         {
-            float* channelData = inputBuffer.getWritePointer(channel);
-            for (int sample = 0; sample < numSamples; ++sample)
-                channelData[sample] = applySoftClipper(channelData[sample]);
+            if constexpr (order == ADAAOrder::FirstOrder)
+            {
+                state.ad1 = Shape::F1(state.x1);
+            }
+            else
+            {
+                const double dx = state.x1 - state.x2;
+                state.ad1 = Shape::F2(state.x1);
+                state.d1 = std::abs(dx) < adaa2Tolerance ? Shape::F1(0.5 * (state.x1 + state.x2))
+                                                        : (state.ad1 - Shape::F2(state.x2)) / dx;
+            }
+
+            state.cachedKernel = kernel;
         }
+
+        double y;
+
+        if constexpr (order == ADAAOrder::FirstOrder)
+        {
+            // Mean of f over [x1, x]
+            const double F1 = Shape::F1(x);
+            const double dx = x - state.x1;
+
+            y = std::abs(dx) < adaaTolerance ? Shape::f(0.5 * (x + state.x1)) : (F1 - state.ad1) / dx;
+
+            state.ad1 = F1;
+        }
+        else
+        {
+            // Divided difference of the divided differences of F2 over [x2, x1, x]
+            const double F2 = Shape::F2(x);
+            const double dx = x - state.x1;
+            const double d0 = std::abs(dx) < adaa2Tolerance ? Shape::F1(0.5 * (x + state.x1)) : (F2 - state.ad1) / dx;
+            const double span = x - state.x2;
+
+            if (std::abs(span) < adaa2Tolerance)
+            {
+                // x came back to x2: expand around their midpoint instead
+                const double mid = 0.5 * (x + state.x2);
+                const double delta = mid - state.x1;
+
+                y = std::abs(delta) < adaa2Tolerance ? Shape::f(0.5 * (mid + state.x1))
+                                                    : 2.0 / delta * (Shape::F1(mid) + (state.ad1 - Shape::F2(mid)) / delta);
+            }
+            else
+            {
+                y = 2.0 * (d0 - state.d1) / span;
+            }
+
+            state.ad1 = F2;
+            state.d1 = d0;
+        }
+
+        state.x2 = state.x1;
+        state.x1 = x;
+        return y;
     }
 
-    void Waveshaper::applyHardClipper(juce::AudioBuffer<float>& inputBuffer)
+    // --- --- BUFFER PROCESSING --- ---
+    template <typename SampleType>
+    void Waveshaper<SampleType>::process(juce::AudioBuffer<SampleType>& inputBuffer)
     {
-        const int numSamples = inputBuffer.getNumSamples();
-        const int numChannels = inputBuffer.getNumChannels();
-
-        for (int channel = 0; channel < numChannels; ++channel)
+        switch (clipper)
         {
-            float* channelData = inputBuffer.getWritePointer(channel);
-            for (int sample = 0; sample < numSamples; ++sample)
-                channelData[sample] = applyHardClipper(channelData[sample]);
+            case ClipperType::Hard: applyClipper<HardClipShape>(inputBuffer); break;
+            case ClipperType::Tanh: applyClipper<TanhClipShape>(inputBuffer); break;
+            case ClipperType::ATan: applyClipper<ATanClipShape>(inputBuffer); break;
+            case ClipperType::Soft:
+            default:                applyClipper<SoftClipShape>(inputBuffer); break;
         }
     }
 
-    void Waveshaper::applyTanhClipper(juce::AudioBuffer<float>& inputBuffer)
+    template <typename SampleType>
+    void Waveshaper<SampleType>::applySoftClipper(juce::AudioBuffer<SampleType>& inputBuffer)
+    {
+        applyClipper<SoftClipShape>(inputBuffer);
+    }
+
+    template <typename SampleType>
+    void Waveshaper<SampleType>::applyHardClipper(juce::AudioBuffer<SampleType>& inputBuffer)
+    {
+        applyClipper<HardClipShape>(inputBuffer);
+    }
+
+    template <typename SampleType>
+    void Waveshaper<SampleType>::applyTanhClipper(juce::AudioBuffer<SampleType>& inputBuffer)
+    {
+        applyClipper<TanhClipShape>(inputBuffer);
+    }
+
+    template <typename SampleType>
+    void Waveshaper<SampleType>::applyATanClipper(juce::AudioBuffer<SampleType>& inputBuffer)
+    {
+        applyClipper<ATanClipShape>(inputBuffer);
+    }
+
+    template <typename SampleType>
+    template <typename Shape>
+    void Waveshaper<SampleType>::applyClipper(juce::AudioBuffer<SampleType>& inputBuffer)
     {
         const int numSamples = inputBuffer.getNumSamples();
         const int numChannels = inputBuffer.getNumChannels();
+        const int numADAAChannels = getNumADAAChannels(inputBuffer);
 
-        for (int channel = 0; channel < numChannels; ++channel)
+        applyADAA<Shape>(inputBuffer, numADAAChannels);
+
+        // Parameters held in locals, not reloaded from this after every store, so the shape inlines
+        // into a loop the compiler can vectorise
+        const SampleType inDrive = drive, inBiasPre = biasPre, inBiasPost = biasPost;
+        const SampleType gain = Shape::template outputGain<SampleType>(outGain);
+
+        for (int channel = numADAAChannels; channel < numChannels; ++channel)
         {
-            float* channelData = inputBuffer.getWritePointer(channel);
+            SampleType* channelData = inputBuffer.getWritePointer(channel);
             for (int sample = 0; sample < numSamples; ++sample)
-                channelData[sample] = applyTanhClipper(channelData[sample]);
+                channelData[sample] = Shape::clip(inDrive * (inBiasPre + channelData[sample]) + inBiasPost, gain);
         }
     }
 
-    void Waveshaper::applyATanClipper(juce::AudioBuffer<float>& inputBuffer)
+    template <typename SampleType>
+    int Waveshaper<SampleType>::getNumADAAChannels(const juce::AudioBuffer<SampleType>& inputBuffer) const noexcept
+    {
+        return adaaOrder == ADAAOrder::Off ? 0 : juce::jmin(inputBuffer.getNumChannels(), (int) adaaStates.size());
+    }
+
+    // The order is picked once per block, so the sample loop runs a single kernel
+    template <typename SampleType>
+    template <typename Shape>
+    void Waveshaper<SampleType>::applyADAA(juce::AudioBuffer<SampleType>& inputBuffer, int numChannels)
     {
         const int numSamples = inputBuffer.getNumSamples();
-        const int numChannels = inputBuffer.getNumChannels();
+        const double gain = (double) outGain * Shape::scale;
+        const double inDrive = drive, inBias = (double) drive * biasPre + biasPost;
 
         for (int channel = 0; channel < numChannels; ++channel)
         {
-            float* channelData = inputBuffer.getWritePointer(channel);
-            for (int sample = 0; sample < numSamples; ++sample)
-                channelData[sample] = applyATanClipper(channelData[sample]);
+            auto& state = adaaStates[(size_t) channel];
+            SampleType* channelData = inputBuffer.getWritePointer(channel);
+
+            if (adaaOrder == ADAAOrder::FirstOrder)
+                for (int sample = 0; sample < numSamples; ++sample)
+                    channelData[sample] = (SampleType) (gain * processADAA<Shape, ADAAOrder::FirstOrder>(state, inDrive * (double) channelData[sample] + inBias));
+            else
+                for (int sample = 0; sample < numSamples; ++sample)
+                    channelData[sample] = (SampleType) (gain * processADAA<Shape, ADAAOrder::SecondOrder>(state, inDrive * (double) channelData[sample] + inBias));
         }
     }
+
+    template class Waveshaper<float>;
+    template class Waveshaper<double>;
 }
\ No newline at end of file
@@ -7,38 +7,108 @@
  * Contains some waveshaping functions
  * On its own, it works as a clipper
  * In combination with filters, adequate input gain and bias, it works as the core of distortion processors
+ *
+ * process() runs the clipper picked by setClipper(), dispatching once per block; the four named
+ * buffer methods run theirs through the same loop, with the parameters hoisted out of it.
+ *
+ * setADAAOrder() switches the clippers to antiderivative anti-aliasing: the buffer methods and the
+ * (channel, sample) overloads then keep per-channel state, allocated in prepare().
  */
 namespace punk_dsp
 {
+    /**
+     * Antiderivative anti-aliasing. Instead of f(u), each sample outputs the mean of f over the
+     * segment from the previous driven input (FirstOrder, half a sample of delay) or a second-order
+     * average over the last two segments (SecondOrder, one sample of delay), from closed-form
+     * antiderivatives. Each order takes roughly 8 dB off the aliasing of a hard-driven clipper, with
+     * a gentle top-octave roll-off. Off is the plain clipper.
+     *
+     * It stacks with Oversampled: prepare the Waveshaper for the oversampled rate and channel count
+     * and use the (channel, sample) overloads from a kernel that takes the channel (see Oversampled.h).
+     */
+    enum class ADAAOrder
+    {
+        Off,
+        FirstOrder,
+        SecondOrder
+    };
+
+    enum class ClipperType
+    {
+        Soft,
+        Hard,
+        Tanh,
+        ATan
+    };
+
+    template <typename SampleType>
     class Waveshaper
     {
     public:
         Waveshaper();
         ~Waveshaper() = default;
 
+        void prepare(const juce::dsp::ProcessSpec& spec);  // Allocates the ADAA state, one per channel
+        void reset();
+
+        int getLatencySamples() const noexcept { return adaaOrder == ADAAOrder::SecondOrder ? 1 : 0; }
+
         // Sample processing
-        float applySoftClipper(float sample);
-        float applyHardClipper(float sample);
-        float applyTanhClipper(float sample);
-        float applyATanClipper(float sample);
+        SampleType applySoftClipper(SampleType sample);
+        SampleType applyHardClipper(SampleType sample);
+        SampleType applyTanhClipper(SampleType sample);
+        SampleType applyATanClipper(SampleType sample);
+
+        // Sample processing with ADAA on the state of channel (the plain clipper when Off or unprepared)
+        SampleType applySoftClipper(int channel, SampleType sample);
+        SampleType applyHardClipper(int channel, SampleType sample);
+        SampleType applyTanhClipper(int channel, SampleType sample);
+        SampleType applyATanClipper(int channel, SampleType sample);
         
         // Buffer processing
-        void applySoftClipper(juce::AudioBuffer<float>& inputBuffer);
-        void applyHardClipper(juce::AudioBuffer<float>& inputBuffer);
-        void applyTanhClipper(juce::AudioBuffer<float>& inputBuffer);
-        void applyATanClipper(juce::AudioBuffer<float>& inputBuffer);
+        void applySoftClipper(juce::AudioBuffer<SampleType>& inputBuffer);
+        void applyHardClipper(juce::AudioBuffer<SampleType>& inputBuffer);
+        void applyTanhClipper(juce::AudioBuffer<SampleType>& inputBuffer);
+        void applyATanClipper(juce::AudioBuffer<SampleType>& inputBuffer);
+        void process(juce::AudioBuffer<SampleType>& inputBuffer);     // The clipper set by setClipper()
 
         // Parameter Updates
         void setDrive(float newDrive);
         void setOutGain(float newOutGain);
         void setBiasPre(float newBiasPre);
         void setBiasPost(float newBiasPost);
+        void setADAAOrder(ADAAOrder newOrder);
+        void setClipper(ClipperType newClipper);
 
     private:
+        // Driven input history and cached antiderivatives, in double: the divided differences
+        // cancel most of their digits, which float cannot spare
+        struct ADAAState
+        {
+            double x1 = 0.0, x2 = 0.0;  // Previous two driven inputs
+            double ad1 = 0.0;           // FirstOrder: F1 (x1). SecondOrder: F2 (x1)
+            double d1 = 0.0;            // SecondOrder: (F2 (x1) - F2 (x2)) / (x1 - x2)
+            int cachedKernel = -1;      // Shape and order the cache holds, refreshed on change
+        };
+
+        template <typename Shape>
+        void applyClipper(juce::AudioBuffer<SampleType>& inputBuffer);
+        template <typename Shape>
+        SampleType applyADAA(int channel, SampleType sample);
+        template <typename Shape>
+        void applyADAA(juce::AudioBuffer<SampleType>& inputBuffer, int numChannels);
+        int getNumADAAChannels(const juce::AudioBuffer<SampleType>& inputBuffer) const noexcept;
+        template <typename Shape, ADAAOrder order>
+        double processADAA(ADAAState& state, double x);
+
         float drive { 1.0f };
         float outGain { 1.0f };
         float biasPre { 0.0f };
         float biasPost { 0.0f };
+        ADAAOrder adaaOrder { ADAAOrder::Off };
+        ClipperType clipper { ClipperType::Soft };
+
+        std::vector<ADAAState> adaaStates;
 
         // --- Prevent copy and move ---
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Waveshaper)
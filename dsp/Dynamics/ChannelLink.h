@@ -0,0 +1,89 @@
+#pragma once
+
+#include "juce_dsp/juce_dsp.h"
+
+namespace punk_dsp
+{
+    /**
+     * Independent: one detector and gain curve per channel.
+     * Max / Mean: one detector for all channels, fed by the loudest channel or the channel average.
+     * Weighted:   weight * Max + (1 - weight) * Mean.
+     */
+    enum class ChannelLink
+    {
+        Independent,
+        Max,
+        Mean,
+        Weighted
+    };
+
+    /**
+     * @class LinkedDetector
+     * @brief Combines the per-channel detector magnitudes of a block into one detector signal.
+     *
+     * Feed every channel's magnitudes with accumulate() (channel 0 first), then combine() once.
+     * Everything is a FloatVectorOperations pass over preallocated scratch, so the processors can
+     * run their log/exp gain computer once per sample for the whole bus.
+     */
+    class LinkedDetector
+    {
+    public:
+        void prepare (int maxBlockSize)
+        {
+            maxima.assign ((size_t) juce::jmax (1, maxBlockSize), 0.0f);
+            sums.assign (maxima.size(), 0.0f);
+        }
+
+        void setLink (ChannelLink newLink) noexcept          { link = newLink; }
+        void setWeight (float newWeight) noexcept           { weight = juce::jlimit (0.0f, 1.0f, newWeight); }
+
+        bool isLinked() const noexcept                      { return link != ChannelLink::Independent; }
+        int getBlockSize() const noexcept                   { return (int) maxima.size(); }
+
+        void accumulate (int channel, const float* magnitudes, int numSamples) noexcept
+        {
+            if (channel == 0)
+            {
+                if (link != ChannelLink::Mean)
+                    juce::FloatVectorOperations::copy (maxima.data(), magnitudes, numSamples);
+                if (link != ChannelLink::Max)
+                    juce::FloatVectorOperations::copy (sums.data(), magnitudes, numSamples);
+                return;
+            }
+
+            if (link != ChannelLink::Mean)
+                juce::FloatVectorOperations::max (maxima.data(), maxima.data(), magnitudes, numSamples);
+            if (link != ChannelLink::Max)
+                juce::FloatVectorOperations::add (sums.data(), magnitudes, numSamples);
+        }
+
+        // The linked magnitudes, valid until the next accumulate()
+        const float* combine (int numChannels, int numSamples) noexcept
+        {
+            const float meanScale = 1.0f / (float) juce::jmax (1, numChannels);
+
+            switch (link)
+            {
+                case ChannelLink::Mean:
+                    juce::FloatVectorOperations::multiply (sums.data(), meanScale, numSamples);
+                    return sums.data();
+
+                case ChannelLink::Weighted:
+                    juce::FloatVectorOperations::multiply (maxima.data(), weight, numSamples);
+                    juce::FloatVectorOperations::addWithMultiply (maxima.data(), sums.data(), (1.0f - weight) * meanScale, numSamples);
+                    return maxima.data();
+
+                case ChannelLink::Independent:
+                case ChannelLink::Max:
+                default:
+                    return maxima.data();
+            }
+        }
+
+    private:
+        std::vector<float> maxima;
+        std::vector<float> sums;
+        ChannelLink link = ChannelLink::Independent;
+        float weight = 0.5f;
+    };
+}
@@ -5,85 +5,193 @@ static constexpr float compMinMagnitude = 0.00001f;     // Approx -100 dB
 
 namespace punk_dsp
 {
-    Compressor::Compressor()
+    template <typename SampleType>
+    Compressor<SampleType>::Compressor()
     {
     }
 
-    void Compressor::prepare(const juce::dsp::ProcessSpec& spec)
+    template <typename SampleType>
+    void Compressor<SampleType>::prepare(const juce::dsp::ProcessSpec& spec)
     {
         sampleRate = spec.sampleRate;
         envelope.assign (spec.numChannels, 0.0f);
+        sustain.assign (spec.numChannels, 0.0f);
+        
+        // Sample-lane path works a block at a time, padded to whole registers
+        detectorSize = ((int) spec.maximumBlockSize + simdLanes - 1) / simdLanes * simdLanes;
+        detectorStorage.allocate (detectorSize + simdLanes, true);
+        detector = SIMDFloat::getNextSIMDAlignedPtr (detectorStorage.get());
+        linkedDetector.prepare (detectorSize);
+        sidechainMix.assign ((size_t) detectorSize, 0.0f);
+        levelDetectors.prepare (sampleRate, (int) spec.numChannels);
+        sidechainFilter.prepare (sampleRate, (int) spec.numChannels);
+        
+        lookahead.prepare ((int) std::ceil (maxLookaheadMs * 0.001f * sampleRate), (int) spec.numChannels);
+        updateLookahead (lookaheadMs);
         
         // Recalculate time coefficients based on current sample rate
         attackCoeff = calculateTimeCoeff (10.0f);
-        releaseCoeff = calculateTimeCoeff (100.0f);
+        releaseMs = 100.0f;
+        releaseCoeff = calculateTimeCoeff (releaseMs);
+        updateAutoRelease (autoRelease);
     }
 
-    void Compressor::reset()
+    template <typename SampleType>
+    void Compressor<SampleType>::reset()
     {
         std::fill (envelope.begin(), envelope.end(), 0.0f);
+        std::fill (sustain.begin(), sustain.end(), 0.0f);
+        lookahead.reset();
+        levelDetectors.reset();
+        sidechainFilter.reset();
     }
 
-    float Compressor::calculateTimeCoeff(float time_ms)
+    template <typename SampleType>
+    float Compressor<SampleType>::calculateTimeCoeff(float time_ms)
     {
         // return std::exp(-2.0f * juce::MathConstants<float>::pi * 1000.f / time_ms / sampleRate);
         return std::exp(-1.f / (0.001f * time_ms * sampleRate));
     }
 
 
-    void Compressor::updateRatio(float newRatio)
+    template <typename SampleType>
+    void Compressor<SampleType>::updateRatio(float newRatio)
     {
         ratio = newRatio;
         compressionSlope = 1.0f - (1.0f / newRatio);
     }
 
-    void Compressor::updateThres(float newThres)
+    template <typename SampleType>
+    void Compressor<SampleType>::updateThres(float newThres)
     {
         thresdB = newThres;
         updateKneeRange();
     }
 
-    void Compressor::updateKnee(float newKnee)
+    template <typename SampleType>
+    void Compressor<SampleType>::updateKnee(float newKnee)
     {
         kneedB = newKnee;
         updateKneeRange();
     }
 
 
-    void Compressor::updateKneeRange()
+    template <typename SampleType>
+    void Compressor<SampleType>::updateKneeRange()
     {
         kneeStart = thresdB - (kneedB / 2.0f);
         kneeEnd = thresdB + (kneedB / 2.0f);
     }
 
-    void Compressor::updateAttack(float newAttMs)
+    template <typename SampleType>
+    void Compressor<SampleType>::updateAttack(float newAttMs)
     {
         attackCoeff = calculateTimeCoeff(newAttMs);
     }
 
-    void Compressor::updateRelease(float newRelMs)
+    template <typename SampleType>
+    void Compressor<SampleType>::updateRelease(float newRelMs)
     {
+        releaseMs = newRelMs;
         releaseCoeff = calculateTimeCoeff(newRelMs);
+        updateAutoRelease(autoRelease);
     }
 
-    void Compressor::updateMakeUp(float newMakeUp_dB)
+    template <typename SampleType>
+    void Compressor<SampleType>::updateAutoRelease(bool newAutoRelease)
+    {
+        autoRelease = newAutoRelease;
+        
+        // Off, the follower never leaves 0 dB, so the release floor is the target itself
+        sustainCoeff = autoRelease ? calculateTimeCoeff(releaseMs * autoReleaseSpread) : 1.0f;
+        
+        if (! autoRelease)
+            std::fill(sustain.begin(), sustain.end(), 0.0f);
+    }
+
+    template <typename SampleType>
+    void Compressor<SampleType>::updateMakeUp(float newMakeUp_dB)
     {
         makeUpGaindB = newMakeUp_dB;
     }
 
-    void Compressor::updateMix(float newMix)
+    template <typename SampleType>
+    void Compressor<SampleType>::updateMix(float newMix)
     {
         mix = newMix / 100.0f;
     }
 
-    void Compressor::updateFeedForward(bool newFeedForward)
+    template <typename SampleType>
+    void Compressor<SampleType>::updateFeedForward(bool newFeedForward)
     {
         useFeedForward = newFeedForward;
     }
 
+    template <typename SampleType>
+    void Compressor<SampleType>::updateControlInterval(int newInterval)
+    {
+        controlInterval = juce::jlimit(1, maxControlInterval, newInterval);
+    }
+
+    template <typename SampleType>
+    void Compressor<SampleType>::updateDetector(DetectorType newDetector)
+    {
+        levelDetectors.setType(newDetector);
+    }
+
+    template <typename SampleType>
+    void Compressor<SampleType>::updateRmsWindow(float newWindowMs)
+    {
+        levelDetectors.setRmsWindow(newWindowMs);
+    }
+
+    template <typename SampleType>
+    void Compressor<SampleType>::updateSidechainFilter(SidechainFilterType newType)
+    {
+        sidechainFilter.setType(newType);
+    }
+
+    template <typename SampleType>
+    void Compressor<SampleType>::updateSidechainFreq(float newFreqHz)
+    {
+        sidechainFilter.setFrequency(newFreqHz);
+    }
+
+    template <typename SampleType>
+    void Compressor<SampleType>::updateSidechainQ(float newQ)
+    {
+        sidechainFilter.setQ(newQ);
+    }
+
+    template <typename SampleType>
+    void Compressor<SampleType>::updateSidechainGain(float newGain_dB)
+    {
+        sidechainFilter.setGain(newGain_dB);
+    }
+
+    template <typename SampleType>
+    void Compressor<SampleType>::updateLink(ChannelLink newLink)
+    {
+        linkedDetector.setLink(newLink);
+    }
+
+    template <typename SampleType>
+    void Compressor<SampleType>::updateLinkWeight(float newWeight)
+    {
+        linkedDetector.setWeight(newWeight / 100.0f);
+    }
+
+    template <typename SampleType>
+    void Compressor<SampleType>::updateLookahead(float newLookaheadMs)
+    {
+        lookaheadMs = juce::jlimit(0.0f, maxLookaheadMs, newLookaheadMs);
+        lookahead.setDelay(juce::roundToInt(lookaheadMs * 0.001f * sampleRate));
+    }
+
     // --- Core Math Logic ---
 
-    float Compressor::calculateTargetGain(float inputDB)
+    template <typename SampleType>
+    float Compressor<SampleType>::calculateTargetGain(float inputDB)
     {
         if (inputDB > kneeEnd)
             return (inputDB - thresdB) * compressionSlope;
@@ -97,7 +205,8 @@ namespace punk_dsp
         return 0.0f;
     }
 
-    float Compressor::updateEnvelope(float targetGR_dB, float currentEnv_dB)
+    template <typename SampleType>
+    float Compressor<SampleType>::updateEnvelope(float targetGR_dB, float currentEnv_dB)
     {
         // If target reduction is greater than current (Attack), or less (Release)
         float alpha = (targetGR_dB > -currentEnv_dB) ? attackCoeff : releaseCoeff;
@@ -108,107 +217,376 @@ namespace punk_dsp
     }
 
     // --- Methods for GUI ---
-    float Compressor::getGainReduction()
+    template <typename SampleType>
+    float Compressor<SampleType>::getGainReduction()
     {
         return currentGR_dB;
     }
 
-    void Compressor::process(juce::AudioBuffer<float>& inputBuffer)
+    template <typename SampleType>
+    void Compressor<SampleType>::process(juce::AudioBuffer<SampleType>& inputBuffer)
+    {
+        processBlock(inputBuffer, nullptr);
+    }
+
+    template <typename SampleType>
+    void Compressor<SampleType>::processWithSidechain(juce::AudioBuffer<SampleType>& inputBuffer, const juce::dsp::AudioBlock<const SampleType>& sidechainBlock)
+    {
+        // A key shorter than the block can't drive it; fall back to self-keying rather than read past it
+        if (sidechainBlock.getNumChannels() == 0 || (int) sidechainBlock.getNumSamples() < inputBuffer.getNumSamples())
+        {
+            jassert (sidechainBlock.getNumChannels() == 0);
+            processBlock(inputBuffer, nullptr);
+            return;
+        }
+        
+        const SidechainInput<SampleType> sidechain (sidechainBlock, inputBuffer.getNumChannels());
+        processBlock(inputBuffer, &sidechain);
+    }
+
+    template <typename SampleType>
+    void Compressor<SampleType>::processWithSidechain(juce::AudioBuffer<SampleType>& inputBuffer, const juce::AudioBuffer<SampleType>& sidechainBuffer)
+    {
+        processWithSidechain(inputBuffer, juce::dsp::AudioBlock<const SampleType>(sidechainBuffer));
+    }
+
+    template <typename SampleType>
+    void Compressor<SampleType>::processBlock(juce::AudioBuffer<SampleType>& inputBuffer, const SidechainInput<SampleType>* sidechain)
     {
         const int numSamples = inputBuffer.getNumSamples();
         const int numChannels = inputBuffer.getNumChannels();
         
         if ((int)envelope.size() != numChannels)
             envelope.assign(numChannels, 0.0f);
+        if ((int)sustain.size() != numChannels)
+            sustain.assign(numChannels, 0.0f);
+        
+        SampleType* const* channelData = inputBuffer.getArrayOfWritePointers();
+        
+        if (linkedDetector.isLinked() && numChannels > 1)
+        {
+            levelDetectors.visit([&](auto& levelDetector)
+            {
+                if (useFeedForward)
+                    processLinked<false>(levelDetector, channelData, numChannels, numSamples, sidechain);
+                else
+                    processLinked<true>(levelDetector, channelData, numChannels, numSamples, sidechain);
+            });
+            
+            currentGR_dB = envelope[0]; // For meter reporting
+            return;
+        }
+        
+        // One channel per lane while at least a register's worth is left (the last group may be partly empty).
+        // Lookahead, control-rate gain, RMS / true-peak detection and an external or filtered key need
+        // a detector signal apart from the audio, which only the block path keeps
+        constexpr int groupSize = simdLanes * registersPerGroup;
+        const bool blockPathOnly = sidechain != nullptr || sidechainFilter.isActive() || lookahead.getDelay() > 0 || controlInterval > 1
+                                || levelDetectors.getType() != DetectorType::Peak;
+        const int numLaneChannels = blockPathOnly ? 0 : numChannels;
+        int first = 0;
         
-        for (int ch = 0; ch < numChannels; ++ch)
+        for (; numLaneChannels - first >= simdLanes; first += groupSize)
         {
-            float* channelData = inputBuffer.getWritePointer(ch);
-            float currentEnv = envelope[ch];
+            const int numActive = juce::jmin(groupSize, numLaneChannels - first);
             
-            for (int sample = 0; sample < numSamples; ++sample)
+            if (useFeedForward)
+                processChannelGroup<false>(channelData + first, numActive, numSamples, envelope.data() + first, sustain.data() + first);
+            else
+                processChannelGroup<true>(channelData + first, numActive, numSamples, envelope.data() + first, sustain.data() + first);
+        }
+        
+        // Remaining channels (e.g. stereo): samples per lane
+        levelDetectors.visit([&](auto& levelDetector)
+        {
+            for (int ch = first; ch < numChannels; ++ch)
             {
-                float input = channelData[sample];
-                
-                // 1. Identify Sidechain Input based on Topology
-                float sidechainInput = input;
+                if (useFeedForward)
+                    processChannelBlock<false>(levelDetector, ch, channelData[ch], numSamples, envelope[(size_t) ch], sustain[(size_t) ch], sidechain);
+                else
+                    processChannelBlock<true>(levelDetector, ch, channelData[ch], numSamples, envelope[(size_t) ch], sustain[(size_t) ch], sidechain);
+            }
+        });
+        
+        if (numChannels > 0) currentGR_dB = envelope[0]; // For meter reporting
+    }
+
+    template <typename SampleType>
+    template <bool feedBack>
+    void Compressor<SampleType>::processChannelGroup(SampleType* const* channelData, int numActive, int numSamples, float* groupEnvelope, float* groupSustain)
+    {
+        // Registers are independent, so interleaving them hides the latency of the envelope recursion
+        constexpr int groupSize = simdLanes * registersPerGroup;
+        alignas (SIMDFloat) float lanes[groupSize] = {};
+        
+        // Ballistics run on the reduction amount (-envelope), which is >= 0
+        for (int lane = 0; lane < numActive; ++lane)
+            lanes[lane] = -groupEnvelope[lane];
+        
+        SIMDFloat reduction[registersPerGroup], held[registersPerGroup];
+        for (int r = 0; r < registersPerGroup; ++r)
+            reduction[r] = SIMDFloat::fromRawArray(lanes + r * simdLanes);
+        
+        for (int lane = 0; lane < numActive; ++lane)
+            lanes[lane] = groupSustain[lane];
+        
+        for (int r = 0; r < registersPerGroup; ++r)
+            held[r] = SIMDFloat::fromRawArray(lanes + r * simdLanes);
+        
+        // Zero knee would divide by zero; a microscopic one is indistinguishable from hard
+        const float knee = juce::jmax(kneedB, 1.0e-6f);
+        
+        const SIMDFloat zero         = SIMDFloat::expand(0.0f);
+        const SIMDFloat minMagnitude = SIMDFloat::expand(compMinMagnitude);
+        const SIMDFloat kneeWidth    = SIMDFloat::expand(knee);
+        const SIMDFloat attackDelta  = SIMDFloat::expand(attackCoeff - releaseCoeff);
+        const SIMDFloat release      = SIMDFloat::expand(releaseCoeff);
+        const SIMDFloat sustainRate  = SIMDFloat::expand(sustainCoeff);
+        const SIMDFloat makeUp       = SIMDFloat::expand(makeUpGaindB);
+        const SIMDFloat wetGain      = SIMDFloat::expand(mix);
+        const SIMDFloat dryGain      = SIMDFloat::expand(1.0f - mix);
+        const float kneeCurve        = compressionSlope / (2.0f * knee);
+        
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            for (int lane = 0; lane < numActive; ++lane)
+                lanes[lane] = (float) channelData[lane][sample];
+            
+            for (int r = 0; r < registersPerGroup; ++r)
+            {
+                const SIMDFloat input = SIMDFloat::fromRawArray(lanes + r * simdLanes);
                 
-                if (!useFeedForward)
-                {
-                    // Feed-back uses the PREVIOUS output (estimated by current envelope)
-                    float prevGain = juce::Decibels::decibelsToGain(currentEnv + makeUpGaindB);
-                    sidechainInput = input * prevGain;
-                }
+                // 1. Detection (Sidechain)
+                SIMDFloat inputDB = DynamicsDecibels::gainToDecibels(SIMDFloat::max(SIMDFloat::abs(input), minMagnitude));
                 
-                // 2. Detection (Sidechain)
-                float mag = std::max( std::abs(sidechainInput), compMinMagnitude );
-                float inputDB = juce::Decibels::gainToDecibels(mag);
+                // Feed-back detects the PREVIOUS output: in dB that's just an offset by the applied gain
+                if constexpr (feedBack)
+                    inputDB = inputDB + (makeUp - reduction[r]);
                 
-                // 3. Gain Computer & Ballistics
-                float targetGR = calculateTargetGain(inputDB);
-                currentEnv = updateEnvelope(targetGR, currentEnv);
+                // 2. Gain Computer, branchless: quadratic inside the knee, linear above it
+                const SIMDFloat intoKnee = SIMDFloat::min(SIMDFloat::max(inputDB - kneeStart, zero), kneeWidth);
+                const SIMDFloat target = intoKnee * intoKnee * kneeCurve
+                                       + SIMDFloat::max(inputDB - kneeEnd, zero) * compressionSlope;
                 
-                // 4. Apply Gain
-                float totalGainDB = currentEnv + makeUpGaindB;
-                float gainLinear = juce::Decibels::decibelsToGain(totalGainDB);
+                // 3. Ballistics: attack while the target reduction is above the current one. Auto release
+                //    floors the release at the slow follower of the target
+                held[r] = target + sustainRate * (held[r] - target);
+                const SIMDFloat floor = SIMDFloat::max(target, held[r]);
+                const SIMDFloat alpha = release + (attackDelta & SIMDFloat::greaterThan(floor, reduction[r]));
+                reduction[r] = floor + alpha * (reduction[r] - floor);
                 
-                float processed = input * gainLinear;
-                channelData[sample] = (processed * mix) + (input * (1.0f - mix));
+                // 4. Gain, applied in the sample type below
+                const SIMDFloat gainLinear = DynamicsDecibels::decibelsToGain(makeUp - reduction[r]);
+                (gainLinear * wetGain + dryGain).copyToRawArray(lanes + r * simdLanes);
             }
             
-            envelope[ch] = currentEnv;
-            
-            if (ch == 0) currentGR_dB = currentEnv; // For meter reporting
+            for (int lane = 0; lane < numActive; ++lane)
+                channelData[lane][sample] *= (SampleType) lanes[lane];
         }
+        
+        for (int r = 0; r < registersPerGroup; ++r)
+            reduction[r].copyToRawArray(lanes + r * simdLanes);
+        
+        for (int lane = 0; lane < numActive; ++lane)
+            groupEnvelope[lane] = -lanes[lane];
+        
+        for (int r = 0; r < registersPerGroup; ++r)
+            held[r].copyToRawArray(lanes + r * simdLanes);
+        
+        for (int lane = 0; lane < numActive; ++lane)
+            groupSustain[lane] = lanes[lane];
     }
 
-    void Compressor::processWithSidechaing(juce::AudioBuffer<float>& inputBuffer, juce::AudioBuffer<float>& sidechainBuffer)
+    template <typename SampleType>
+    template <bool feedBack, typename Detector>
+    void Compressor<SampleType>::processLinked(Detector& levelDetector, SampleType* const* channelData, int numChannels, int numSamples,
+                                               const SidechainInput<SampleType>* sidechain)
     {
-        const int numSamples = inputBuffer.getNumSamples();
-        const int numChannels = inputBuffer.getNumChannels();
+        if (detector == nullptr)
+            return;
         
-        if ((int)envelope.size() != numChannels)
-            envelope.assign(numChannels, 0.0f);
+        // One envelope for the whole bus, kept in every slot so unlinking carries on smoothly
+        float reduction = -envelope[0];
+        float held = sustain[0];
         
-        for (int ch = 0; ch < numChannels; ++ch)
+        for (int start = 0; start < numSamples; start += detectorSize)
         {
-            float* sidechainData = sidechainBuffer.getReadPointer(ch);
-            float* channelData = inputBuffer.getWritePointer(ch);
-            float currentEnv = envelope[ch];
+            const int num = juce::jmin(detectorSize, numSamples - start);
             
-            for (int sample = 0; sample < numSamples; ++sample)
+            // 1. Detection (Sidechain): every channel feeds the one linked detector
+            for (int ch = 0; ch < numChannels; ++ch)
             {
-                float input = channelData[sample];
-                
-                // 1. Identify Sidechain Input based on Topology
-                float sidechainInput = sidechainData[sample];
-                
-                if (!useFeedForward)
-                {
-                    // Feed-back uses the PREVIOUS output (estimated by current envelope)
-                    float prevGain = juce::Decibels::decibelsToGain(currentEnv + makeUpGaindB);
-                    sidechainInput = sidechainInput * prevGain;
-                }
-                
-                // 2. Detection (Sidechain)
-                float mag = std::max( std::abs(sidechainInput), compMinMagnitude );
-                float inputDB = juce::Decibels::gainToDecibels(mag);
-                
-                // 3. Gain Computer & Ballistics
-                float targetGR = calculateTargetGain(inputDB);
-                currentEnv = updateEnvelope(targetGR, currentEnv);
-                
-                // 4. Apply Gain
-                float totalGainDB = currentEnv + makeUpGaindB;
-                float gainLinear = juce::Decibels::decibelsToGain(totalGainDB);
-                
-                float processed = input * gainLinear;
-                channelData[sample] = (processed * mix) + (input * (1.0f - mix));
+                detectChannel(levelDetector, ch, channelData[ch], start, num, sidechain);
+                linkedDetector.accumulate(ch, detector, num);
             }
             
-            envelope[ch] = currentEnv;
+            // 2. Gain once for all channels, then apply it to each of them
+            computeGainBlock<feedBack>(linkedDetector.combine(numChannels, num), num, reduction, held);
+            
+            for (int ch = 0; ch < numChannels; ++ch)
+                applyGains(channelData[ch] + start, detector, num);
+        }
+        
+        std::fill(envelope.begin(), envelope.end(), -reduction);
+        std::fill(sustain.begin(), sustain.end(), held);
+    }
+
+    template <typename SampleType>
+    template <bool feedBack, typename Detector>
+    void Compressor<SampleType>::processChannelBlock(Detector& levelDetector, int channel, SampleType* channelData, int numSamples, float& channelEnvelope,
+                                                     float& channelSustain, const SidechainInput<SampleType>* sidechain)
+    {
+        if (detector == nullptr)
+            return;
+        
+        float reduction = -channelEnvelope;
+        
+        for (int start = 0; start < numSamples; start += detectorSize)
+        {
+            SampleType* data = channelData + start;
+            const int num = juce::jmin(detectorSize, numSamples - start);
+            
+            detectChannel(levelDetector, channel, channelData, start, num, sidechain);
+            computeGainBlock<feedBack>(detector, num, reduction, channelSustain);
+            applyGains(data, detector, num);
+        }
+        
+        channelEnvelope = -reduction;
+    }
+
+    template <typename SampleType>
+    template <typename Detector>
+    void Compressor<SampleType>::detectChannel(Detector& levelDetector, int channel, SampleType* channelData, int start, int numSamples,
+                                               const SidechainInput<SampleType>* sidechain)
+    {
+        SampleType* data = channelData + start;
+        
+        // The key is the audio itself or the external sidechain, read in place (mixed only on a channel mismatch).
+        // A double key is narrowed into detector; an active sidechain filter writes the filtered key there too,
+        // and the detector then reads it in place
+        const SampleType* key = sidechain != nullptr ? sidechain->getChannel(channel, start, numSamples, sidechainMix.data()) : data;
+        const float* detectorInput = toDetectorInput(key, detector, numSamples);
+        levelDetector.process(channel, sidechainFilter.process(channel, detectorInput, detector, numSamples), detector, numSamples);
+        
+        // Lookahead delays the audio in-place and detects the peak level of the window ahead of it
+        if (lookahead.getDelay() > 0 && channel < lookahead.getNumChannels())
+            lookahead.process(channel, data, detector, numSamples);
+    }
+
+    template <typename SampleType>
+    template <bool feedBack>
+    void Compressor<SampleType>::computeGainBlock(const float* magnitudes, int numSamples, float& reduction, float& held)
+    {
+        if (controlInterval > 1)
+        {
+            computeGainBlockControlRate<feedBack>(magnitudes, numSamples, reduction, held);
+            return;
+        }
+        
+        const float knee = juce::jmax(kneedB, 1.0e-6f);
+        const float kneeCurve = compressionSlope / (2.0f * knee);
+        const int numPadded = (numSamples + simdLanes - 1) / simdLanes * simdLanes;
+        
+        // 1. Magnitude -> dB, a register of samples at a time
+        juce::FloatVectorOperations::max(detector, magnitudes, compMinMagnitude, numSamples);
+        juce::FloatVectorOperations::fill(detector + numSamples, compMinMagnitude, numPadded - numSamples);
+        
+        for (int i = 0; i < numPadded; i += simdLanes)
+            DynamicsDecibels::gainToDecibels(SIMDFloat::fromRawArray(detector + i)).copyToRawArray(detector + i);
+        
+        // 2. Gain Computer & Ballistics: the only serial part, kept branchless. The state is kept in
+        //    locals, so the stores into detector don't force it through memory every sample
+        float currentReduction = reduction, currentHeld = held;
+        
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            float inputDB = detector[sample];
+            
+            // Feed-back detects the PREVIOUS output: in dB that's just an offset by the applied gain
+            if constexpr (feedBack)
+                inputDB += makeUpGaindB - currentReduction;
+            
+            const float intoKnee = juce::jlimit(0.0f, knee, inputDB - kneeStart);
+            const float target = intoKnee * intoKnee * kneeCurve + juce::jmax(0.0f, inputDB - kneeEnd) * compressionSlope;
+            
+            // Auto release floors the release at the slow follower of the target
+            currentHeld = target + sustainCoeff * (currentHeld - target);
+            const float floor = juce::jmax(target, currentHeld);
+            
+            const float alpha = floor > currentReduction ? attackCoeff : releaseCoeff;
+            currentReduction = floor + alpha * (currentReduction - floor);
+            
+            detector[sample] = makeUpGaindB - currentReduction;
+        }
+        
+        reduction = currentReduction;
+        held = currentHeld;
+        
+        // 3. dB -> linear, a register at a time, with the mix folded in
+        for (int i = 0; i < numPadded; i += simdLanes)
+            DynamicsDecibels::decibelsToGain(SIMDFloat::fromRawArray(detector + i)).copyToRawArray(detector + i);
+        
+        juce::FloatVectorOperations::multiply(detector, mix, numSamples);
+        juce::FloatVectorOperations::add(detector, 1.0f - mix, numSamples);
+    }
+
+    template <typename SampleType>
+    template <bool feedBack>
+    void Compressor<SampleType>::computeGainBlockControlRate(const float* magnitudes, int numSamples, float& reduction, float& held)
+    {
+        const float knee = juce::jmax(kneedB, 1.0e-6f);
+        const float kneeCurve = compressionSlope / (2.0f * knee);
+        
+        // One ballistics step covers a whole sub-block: alpha^K
+        const float attackStep = std::pow(attackCoeff, (float) controlInterval);
+        const float releaseStep = std::pow(releaseCoeff, (float) controlInterval);
+        const float sustainStep = std::pow(sustainCoeff, (float) controlInterval);
+        
+        float previousGain = DynamicsDecibels::decibelsToGain(makeUpGaindB - reduction);
+        
+        for (int start = 0; start < numSamples; start += controlInterval)
+        {
+            const int num = juce::jmin(controlInterval, numSamples - start);
+            
+            // 1. Detection: the sub-block's mean magnitude (nulls closest against K = 1)
+            float level = 0.0f;
+            for (int i = 0; i < num; ++i)
+                level += magnitudes[start + i];
             
-            if (ch == 0) currentGR_dB = currentEnv; // For meter reporting
+            float inputDB = DynamicsDecibels::gainToDecibels(juce::jmax(level / (float) num, compMinMagnitude));
+            
+            // Feed-back detects the PREVIOUS output: in dB that's just an offset by the applied gain
+            if constexpr (feedBack)
+                inputDB += makeUpGaindB - reduction;
+            
+            // 2. Gain Computer & Ballistics, once per sub-block
+            const float intoKnee = juce::jlimit(0.0f, knee, inputDB - kneeStart);
+            const float target = intoKnee * intoKnee * kneeCurve + juce::jmax(0.0f, inputDB - kneeEnd) * compressionSlope;
+            
+            // A short tail (block size not a multiple of K) gets its own step
+            const bool fullStep = num == controlInterval;
+            held = target + (fullStep ? sustainStep : std::pow(sustainCoeff, (float) num)) * (held - target);
+            const float floor = juce::jmax(target, held);
+            
+            const bool attacking = floor > reduction;
+            const float alpha = fullStep ? (attacking ? attackStep : releaseStep)
+                                         : std::pow(attacking ? attackCoeff : releaseCoeff, (float) num);
+            reduction = floor + alpha * (reduction - floor);
+            
+            // 3. Linear gain ramps from the previous update to this one across the sub-block
+            const float gain = DynamicsDecibels::decibelsToGain(makeUpGaindB - reduction);
+            const float step = (gain - previousGain) / (float) num;
+            
+            for (int i = 0; i < num; ++i)
+                detector[start + i] = previousGain + step * (float) (i + 1);
+            
+            previousGain = gain;
         }
+        
+        juce::FloatVectorOperations::multiply(detector, mix, numSamples);
+        juce::FloatVectorOperations::add(detector, 1.0f - mix, numSamples);
     }
-}
+
+    template class Compressor<float>;
+    template class Compressor<double>;
+}
\ No newline at end of file
@@ -1,6 +1,13 @@
 #pragma once
 
 #include "juce_dsp/juce_dsp.h"
+#include "DecibelConversions.h"
+#include "Lookahead.h"
+#include "ChannelLink.h"
+#include "LevelDetectors.h"
+#include "SidechainInput.h"
+#include "SidechainFilter.h"
+#include "SampleConversions.h"
 
 /**
  * @class Compressor
@@ -8,9 +15,46 @@
  *
  * All core dynamics processing, including sidechain detection, gain computation,
  * and envelope smoothing, is contained here.
+ *
+ * process() is vectorised with juce::dsp::SIMDRegister: wide buses run one channel per
+ * lane (4 lanes on SSE/NEON, 8 on AVX), channels left over from full registers vectorise
+ * detection and gain conversion across samples. Both use a branchless knee and the
+ * DynamicsDecibels conversions (see DecibelConversions.h).
+ *
+ * With updateLookahead() > 0 the audio is delayed and the detector reads the peak of the
+ * lookahead window instead of |x|, so the gain is already down when a transient arrives.
+ * Report getLatencySamples() to the host. Lookahead runs through the per-channel block path.
+ *
+ * updateLink() other than Independent drives every channel from one detector and one gain
+ * curve (block path), so the stereo image holds and the log/exp work runs once per sample.
+ *
+ * updateControlInterval(K) trades accuracy for CPU: with K > 1 the detector (sub-block mean
+ * level), gain computer and dB -> gain conversion run once every K samples (block path) and the
+ * linear gain is ramped across each sub-block. Envelope timing is unchanged; what is lost is
+ * gain movement faster than K samples (ripple, the shape of very fast attacks). Nulled against
+ * K = 1 on a 460 Hz tone with 5 ms attack: -56 dB at K = 4, -48 dB at 8, -22 dB at 32 (see
+ * tests/Dynamics/CompressorTests.cpp).
+ *
+ * updateDetector() picks the sidechain level: Peak (default), RMS or TruePeak. The block path is
+ * instantiated per detector, so only the selected one runs in the inner loop; RMS and TruePeak
+ * always take the block path.
+ *
+ * updateSidechainFilter() puts a high-pass, low-pass or bell biquad in front of the detector
+ * (self-keyed or external); the audio itself is never filtered. Filtering takes the block path.
+ *
+ * updateAutoRelease(true) makes the release program-dependent (dual time constant): a slow
+ * follower of the target reduction, autoReleaseSpread times slower than the release, floors the
+ * release. Transients recover at the release time, sustained compression recovers slowly from
+ * wherever it has settled. It costs one multiply-add and a max per sample on every path; off,
+ * the follower stays at 0 dB and the output is unchanged.
+ *
+ * SampleType is float or double (both instantiated in Compressor.cpp). The audio, the lookahead
+ * delay and the key stay in SampleType; detection, gain computer and ballistics run in float
+ * (dB domain) and only the gain is widened when applied.
  */
  namespace punk_dsp
 {
+    template <typename SampleType>
     class Compressor
     {
     public:
@@ -28,17 +72,40 @@
         void updateMakeUp(float newMakeUp_dB);
         void updateMix(float newMix);
         void updateFeedForward(bool newFeedForward);
+        void updateLookahead(float newLookaheadMs);    // [0, maxLookaheadMs], 0 = off
+        void updateLink(ChannelLink newLink);
+        void updateLinkWeight(float newWeight);        // % of Max in ChannelLink::Weighted, the rest Mean
+        void updateControlInterval(int newInterval);   // Samples per gain update, [1, maxControlInterval]
+        void updateDetector(DetectorType newDetector);
+        void updateRmsWindow(float newWindowMs);       // RMS detector window, default 10 ms
+        void updateSidechainFilter(SidechainFilterType newType);
+        void updateSidechainFreq(float newFreqHz);
+        void updateSidechainQ(float newQ);
+        void updateSidechainGain(float newGain_dB);    // Bell only
+        void updateAutoRelease(bool newAutoRelease);
         
         float getGainReduction();
+        int getLatencySamples() const noexcept { return lookahead.getDelay(); }
+
+        static constexpr float maxLookaheadMs = 20.0f;
+        static constexpr int maxControlInterval = 32;
+        static constexpr float autoReleaseSpread = 10.0f;  // Slow release stage, x the release time
 
         /**
         * @brief Processes the audio buffer in-place, applying downward compression.
         *
         * @param inputBuffer The buffer containing the signal to be processed.
         */
-        void process(juce::AudioBuffer<float>& inputBuffer);
+        void process(juce::AudioBuffer<SampleType>& inputBuffer);
 
-        void processWithSidechain(juce::AudioBuffer<float>& inputBuffer, juce::AudioBuffer<float>& sidechainBuffer);
+        /**
+        * @brief Processes the audio buffer in-place, detecting from an external key signal.
+        *
+        * The key is read in place: matching channels key 1:1, a mono key is broadcast, any other
+        * layout keys every channel with its mean. It must be at least as long as the buffer.
+        */
+        void processWithSidechain(juce::AudioBuffer<SampleType>& inputBuffer, const juce::dsp::AudioBlock<const SampleType>& sidechainBlock);
+        void processWithSidechain(juce::AudioBuffer<SampleType>& inputBuffer, const juce::AudioBuffer<SampleType>& sidechainBuffer);
 
     private:
         // Internal Math Methods
@@ -46,20 +113,61 @@
         float updateEnvelope (float targetGR_dB, float currentEnv_dB);
         void updateKneeRange();
         float calculateTimeCoeff (float time_ms);
+
+        // SIMD paths: one channel per lane (two registers per pass), or samples per lane
+        using SIMDFloat = juce::dsp::SIMDRegister<float>;
+        static constexpr int simdLanes = (int) SIMDFloat::SIMDNumElements;
+        static constexpr int registersPerGroup = 2;
+
+        template <bool feedBack>
+        void processChannelGroup (SampleType* const* channelData, int numActive, int numSamples, float* groupEnvelope, float* groupSustain);
+        void processBlock (juce::AudioBuffer<SampleType>& inputBuffer, const SidechainInput<SampleType>* sidechain);
+        
+        template <bool feedBack, typename Detector>
+        void processChannelBlock (Detector& levelDetector, int channel, SampleType* channelData, int numSamples, float& channelEnvelope,
+                                  float& channelSustain, const SidechainInput<SampleType>* sidechain);
+        template <bool feedBack, typename Detector>
+        void processLinked (Detector& levelDetector, SampleType* const* channelData, int numChannels, int numSamples,
+                            const SidechainInput<SampleType>* sidechain);
+        
+        // Block path stages: detector level of the key (lookahead peak of it) into detector, then magnitudes -> gain into detector
+        template <typename Detector>
+        void detectChannel (Detector& levelDetector, int channel, SampleType* channelData, int start, int numSamples,
+                            const SidechainInput<SampleType>* sidechain);
+        template <bool feedBack>
+        void computeGainBlock (const float* magnitudes, int numSamples, float& reduction, float& held);
+        template <bool feedBack>
+        void computeGainBlockControlRate (const float* magnitudes, int numSamples, float& reduction, float& held);
         
         // --- Internal State ---
         std::vector<float> envelope;    // Stores the current applied linear gain factor
+        std::vector<float> sustain;     // Auto release: slow follower of the target reduction (dB, >= 0)
         float currentGR_dB = 0.0f;      // Gain reduction (in dB) being applied currently
         
+        juce::HeapBlock<float> detectorStorage;
+        float* detector = nullptr;      // Per-sample dB scratch, SIMD-aligned, whole registers
+        int detectorSize = 0;
+        
+        Lookahead<SampleType> lookahead; // Delay line + sliding peak, allocated in prepare
+        LinkedDetector linkedDetector;  // Channel link scratch, detectorSize
+        LevelDetectors levelDetectors;  // Peak / RMS / true-peak sidechain level
+        SidechainFilter sidechainFilter; // HP / LP / bell on the detector path only
+        std::vector<SampleType> sidechainMix; // Key downmix scratch, detectorSize
+        
         // Parameters
         float ratio         = 4.0f;   // Linear ratio (e.g., 4.0 for 4:1)
         float thresdB       = -12.0f; // Threshold in dB
         float kneedB        = 6.0f;   // Knee width in dB
         float attackCoeff   = 0.0f;   // Smoothing coefficient (Attack)
         float releaseCoeff  = 0.0f;   // Smoothing coefficient (Release)
+        float sustainCoeff  = 1.0f;   // Auto release follower coefficient, 1 = off
+        float releaseMs     = 100.0f; // Release time, kept for the auto release stage
+        bool autoRelease    = false;  // Program-dependent release
         float makeUpGaindB  = 0.0f;   // Compensation gain after the compression takes place
         float mix           = 1.0f;   // Mix (dry/wet)
         bool useFeedForward = true;   // Use feed-forward or feed-back topology
+        float lookaheadMs   = 0.0f;   // Detector lookahead (and added latency)
+        int controlInterval = 1;      // Samples between gain computer updates
         
         // Cached values for performance
         float sampleRate       = 44100.0f;
@@ -0,0 +1,200 @@
+#pragma once
+
+#include "juce_dsp/juce_dsp.h"
+
+// Normally set through the module config (see punk_dsp.h)
+#ifndef PUNK_DSP_DECIBEL_ACCURACY
+ #define PUNK_DSP_DECIBEL_ACCURACY 2
+#endif
+
+namespace punk_dsp
+{
+    /**
+     * Reference: juce::Decibels (std::log10 / std::pow), lane by lane for SIMD registers.
+     * Fast / Balanced / Precise: log2/exp2 polynomials of degree 3 / 4 / 5.
+     */
+    enum class DecibelAccuracy
+    {
+        Reference,
+        Fast,
+        Balanced,
+        Precise
+    };
+
+    /**
+     * @class DecibelConversions
+     * @brief gain <-> dB conversions for the dynamics processors, for float or SIMDRegister<float>.
+     *
+     * 20 * log10(x) = 20 * log10(2) * (exponent + log2(mantissa)), and 10^(dB / 20) = 2^integer * 2^fraction,
+     * with the IEEE exponent handled by bit manipulation and only the mantissa/fraction going through a
+     * polynomial. Same conventions as juce::Decibels with its default -100 dB floor: gains at or below the
+     * floor read as -100 dB and levels at or below -100 dB give a gain of 0 (which also keeps denormals out
+     * of the gain path).
+     *
+     * Maximum error from -100 dB to +100 dB (gains 1e-5 to 1e5), evaluated in float against double precision
+     * (checked by tests/Dynamics/DecibelConversionsTests.cpp):
+     *   Fast      gainToDecibels 0.0047 dB     decibelsToGain 8.7e-5 relative (0.0008 dB)
+     *   Balanced  gainToDecibels 0.0007 dB     decibelsToGain 3.7e-6 relative (0.00003 dB)
+     *   Precise   gainToDecibels 0.0001 dB     decibelsToGain 8.5e-7 relative (float rounding of dB, as juce::Decibels)
+     * Beyond that the float rounding of the dB value itself takes over, for juce::Decibels as well.
+     */
+    template <DecibelAccuracy accuracy>
+    struct DecibelConversions
+    {
+        using SIMDFloat = juce::dsp::SIMDRegister<float>;
+
+        static constexpr float minusInfinityDb = -100.0f;
+
+        static float gainToDecibels (float gain) noexcept
+        {
+            if constexpr (accuracy == DecibelAccuracy::Reference)
+                return juce::Decibels::gainToDecibels (gain);
+
+            if (gain <= minusInfinityGain)
+                return minusInfinityDb;
+
+            float mantissa;
+            const float exponent = splitExponent (gain, mantissa);
+            return juce::jmax (minusInfinityDb, (exponent + log2Mantissa (mantissa)) * dBPerOctave);
+        }
+
+        static float decibelsToGain (float dB) noexcept
+        {
+            if constexpr (accuracy == DecibelAccuracy::Reference)
+                return juce::Decibels::decibelsToGain (dB);
+
+            if (dB <= minusInfinityDb)
+                return 0.0f;
+
+            float fraction;
+            const float scale = splitOctaves (dB * octavesPerDb, fraction);
+            return scale * exp2Fraction (fraction);
+        }
+
+        static SIMDFloat gainToDecibels (SIMDFloat gain) noexcept
+        {
+            alignas (SIMDFloat) float mantissa[lanes];
+            alignas (SIMDFloat) float exponent[lanes];
+            SIMDFloat::max (gain, SIMDFloat::expand (minusInfinityGain)).copyToRawArray (mantissa);
+
+            if constexpr (accuracy == DecibelAccuracy::Reference)
+            {
+                for (int lane = 0; lane < lanes; ++lane)
+                    mantissa[lane] = juce::Decibels::gainToDecibels (mantissa[lane]);
+
+                return SIMDFloat::fromRawArray (mantissa);
+            }
+
+            // SIMDRegister has no integer shifts: split the fields lane by lane
+            for (int lane = 0; lane < lanes; ++lane)
+                exponent[lane] = splitExponent (mantissa[lane], mantissa[lane]);
+
+            const SIMDFloat log2Gain = SIMDFloat::fromRawArray (exponent) + log2Mantissa (SIMDFloat::fromRawArray (mantissa));
+            const SIMDFloat dB = SIMDFloat::max (log2Gain * dBPerOctave, SIMDFloat::expand (minusInfinityDb));
+
+            // Exactly the floor at or below it, as the scalar version (the polynomial is not exact there)
+            const SIMDFloat floorGain = SIMDFloat::expand (minusInfinityGain);
+            return (dB & SIMDFloat::greaterThan (gain, floorGain))
+                 + (SIMDFloat::expand (minusInfinityDb) & SIMDFloat::lessThanOrEqual (gain, floorGain));
+        }
+
+        static SIMDFloat decibelsToGain (SIMDFloat dB) noexcept
+        {
+            alignas (SIMDFloat) float fraction[lanes];
+            alignas (SIMDFloat) float scale[lanes];
+            dB.copyToRawArray (fraction);
+
+            if constexpr (accuracy == DecibelAccuracy::Reference)
+            {
+                for (int lane = 0; lane < lanes; ++lane)
+                    fraction[lane] = juce::Decibels::decibelsToGain (fraction[lane]);
+
+                return SIMDFloat::fromRawArray (fraction);
+            }
+
+            for (int lane = 0; lane < lanes; ++lane)
+                scale[lane] = splitOctaves (fraction[lane] * octavesPerDb, fraction[lane]);
+
+            const SIMDFloat gain = SIMDFloat::fromRawArray (scale) * exp2Fraction (SIMDFloat::fromRawArray (fraction));
+            return gain & SIMDFloat::greaterThan (dB, SIMDFloat::expand (minusInfinityDb));
+        }
+
+    private:
+        static constexpr int lanes = (int) SIMDFloat::SIMDNumElements;
+
+        static constexpr float dBPerOctave = 6.02059991f;           // 20 * log10(2)
+        static constexpr float octavesPerDb = 0.166096404f;         // log2(10) / 20
+        static constexpr float minusInfinityGain = 0.00001f;        // 10^(-100 / 20)
+
+        // x = 2^exponent * mantissa, mantissa in [1, 2). x must be positive and normal.
+        static float splitExponent (float x, float& mantissa) noexcept
+        {
+            juce::uint32 bits;
+            std::memcpy (&bits, &x, sizeof (bits));
+            const float exponent = (float) ((int) ((bits >> 23) & 0xff) - 127);
+
+            bits = (bits & 0x007fffffu) | 0x3f800000u;
+            std::memcpy (&mantissa, &bits, sizeof (bits));
+            return exponent;
+        }
+
+        // 2^octaves = scale * 2^fraction, fraction in [0, 1). Octaves clamp to [-126, 127).
+        static float splitOctaves (float octaves, float& fraction) noexcept
+        {
+            // Splitting before the bias keeps the fraction exact
+            const float clamped = juce::jlimit (-126.0f, 126.99f, octaves);
+            const float integer = std::floor (clamped);
+            fraction = clamped - integer;
+
+            const juce::uint32 bits = (juce::uint32) ((int) integer + 127) << 23;
+            float scale;
+            std::memcpy (&scale, &bits, sizeof (bits));
+            return scale;
+        }
+
+        // log2(m) = (m - 1) * p(m) on [1, 2), exact at m = 1
+        template <typename T>
+        static T log2Mantissa (T m) noexcept
+        {
+            if constexpr (accuracy == DecibelAccuracy::Fast)
+                return (m - 1.0f) * horner (m, 0.165381263f, -0.91996586f, 2.17917747f);
+            else if constexpr (accuracy == DecibelAccuracy::Balanced)
+                return (m - 1.0f) * horner (m, -0.0847673116f, 0.579895128f, -1.58543097f, 2.52931761f);
+            else
+                return (m - 1.0f) * horner (m, 0.0463845387f, -0.381805835f, 1.28470445f, -2.31919185f, 2.81187426f);
+        }
+
+        // 2^f = 1 + f * q(f) on [0, 1), exact at f = 0
+        template <typename T>
+        static T exp2Fraction (T f) noexcept
+        {
+            if constexpr (accuracy == DecibelAccuracy::Fast)
+                return f * horner (f, 0.0770671555f, 0.227644854f, 0.695116825f) + 1.0f;
+            else if constexpr (accuracy == DecibelAccuracy::Balanced)
+                return f * horner (f, 0.0134267005f, 0.0522424459f, 0.24128022f, 0.693044842f) + 1.0f;
+            else
+                return f * horner (f, 0.00186713195f, 0.00901702607f, 0.0557999165f, 0.240164449f, 0.693151312f) + 1.0f;
+        }
+
+        // Highest-order coefficient first
+        template <typename T, typename... Rest>
+        static T horner (T x, float highest, Rest... rest) noexcept
+        {
+            T result = splat<T> (highest);
+            ((result = result * x + rest), ...);
+            return result;
+        }
+
+        template <typename T>
+        static T splat (float value) noexcept
+        {
+            if constexpr (std::is_same_v<T, float>)
+                return value;
+            else
+                return T::expand (value);
+        }
+    };
+
+    // Conversions used by Compressor, Gate and Lifter, chosen by PUNK_DSP_DECIBEL_ACCURACY
+    using DynamicsDecibels = DecibelConversions<static_cast<DecibelAccuracy> (PUNK_DSP_DECIBEL_ACCURACY)>;
+}
@@ -1,183 +1,400 @@
 #include "Gate.h"
 
-// Define a small constant to prevent division by zero near the noise floor.
-static constexpr float gateMinMagnitude = 0.000001f; // Approx -120 dB
+// Distance (in dB) at which the envelope snaps to fully open / fully closed
+static constexpr float gateSnap_dB = 0.01f;
 
 namespace punk_dsp
 {
-    Gate::Gate()
+    template <typename SampleType>
+    Gate<SampleType>::Gate()
     {
     }
 
-    void Gate::prepare(const juce::dsp::ProcessSpec& spec)
+    template <typename SampleType>
+    void Gate<SampleType>::prepare(const juce::dsp::ProcessSpec& spec)
     {
         sampleRate = spec.sampleRate;
-        envelope.assign (spec.numChannels, 0.0f);
+        channelStates.assign (spec.numChannels, ChannelState { State::Closed, rangedB, 0 });
+        
+        peak.assign (juce::jmax (1u, spec.maximumBlockSize), 0.0f);
+        linkedDetector.prepare ((int) peak.size());
+        sidechainMix.assign (peak.size(), 0.0f);
+        levelDetectors.prepare (sampleRate, (int) spec.numChannels);
+        sidechainFilter.prepare (sampleRate, (int) spec.numChannels);
+        lookahead.prepare ((int) std::ceil (maxLookaheadMs * 0.001f * sampleRate), (int) spec.numChannels);
+        updateLookahead (lookaheadMs);
         
         // Recalculate time coefficients based on current sample rate
         attackCoeff = calculateTimeCoeff (10.0f);
         releaseCoeff = calculateTimeCoeff (10.0f);
+        updateHold (holdMs);
+        updateThresholds();
     }
 
-    void Gate::reset()
+    template <typename SampleType>
+    void Gate<SampleType>::reset()
     {
-        std::fill (envelope.begin(), envelope.end(), 0.0f);
+        std::fill (channelStates.begin(), channelStates.end(), ChannelState { State::Closed, rangedB, 0 });
+        lookahead.reset();
+        levelDetectors.reset();
+        sidechainFilter.reset();
     }
 
-    float Gate::calculateTimeCoeff(float time_ms)
+    template <typename SampleType>
+    float Gate<SampleType>::calculateTimeCoeff(float time_ms)
     {
         // return std::exp(-2.0f * juce::MathConstants<float>::pi * 1000.f / time_ms / sampleRate);
         return std::exp(-1.f / (0.001f * time_ms * sampleRate));
     }
 
-    void Gate::updateRatio(float newRatio)
+    template <typename SampleType>
+    void Gate<SampleType>::updateThres(float newThres)
     {
-        ratio = newRatio;
-        expansionSlope = ratio - 1.0f;
+        thresdB = newThres;
+        updateThresholds();
     }
 
-    void Gate::updateThres(float newThres)
+    template <typename SampleType>
+    void Gate<SampleType>::updateHysteresis(float newHysteresis)
     {
-        thresdB = newThres;
-        updateKneeRange();
+        hysteresisdB = juce::jmax(0.0f, newHysteresis);
+        updateThresholds();
+    }
+
+    template <typename SampleType>
+    void Gate<SampleType>::updateThresholds()
+    {
+        // The state machine compares raw detector levels, so the thresholds are kept linear
+        openLevel = juce::Decibels::decibelsToGain(thresdB, -200.0f);
+        closeLevel = juce::Decibels::decibelsToGain(thresdB - hysteresisdB, -200.0f);
     }
 
-    void Gate::updateKnee(float newKnee)
+    template <typename SampleType>
+    void Gate<SampleType>::updateHold(float newHoldMs)
     {
-        kneedB = newKnee;
-        updateKneeRange();
+        holdMs = juce::jmax(0.0f, newHoldMs);
+        holdSamples = juce::roundToInt(holdMs * 0.001f * sampleRate);
     }
 
-    void Gate::updateKneeRange()
+    template <typename SampleType>
+    void Gate<SampleType>::updateRange(float newRange)
     {
-        kneeStart = thresdB - (kneedB / 2.0f);
-        kneeEnd = thresdB + (kneedB / 2.0f);
+        rangedB = juce::jlimit(-120.0f, 0.0f, newRange);
+        
+        // A closed gate sits exactly at the range
+        for (auto& gate : channelStates)
+            if (gate.state == State::Closed)
+                gate.envelope_dB = rangedB;
     }
 
-    void Gate::updateAttack(float newAttMs)
+    template <typename SampleType>
+    void Gate<SampleType>::updateAttack(float newAttMs)
     {
         attackCoeff = calculateTimeCoeff(newAttMs);
     }
 
-    void Gate::updateRelease(float newRelMs)
+    template <typename SampleType>
+    void Gate<SampleType>::updateRelease(float newRelMs)
     {
         releaseCoeff = calculateTimeCoeff(newRelMs);
     }
 
-    void Gate::updateMix(float newMix)
+    template <typename SampleType>
+    void Gate<SampleType>::updateMix(float newMix)
     {
         mix = newMix / 100.0f;
     }
 
-    // --- Core Math Logic ---
+    template <typename SampleType>
+    void Gate<SampleType>::updateDetector(DetectorType newDetector)
+    {
+        levelDetectors.setType(newDetector);
+    }
 
-    float Gate::calculateTargetGain(float input_dB)
+    template <typename SampleType>
+    void Gate<SampleType>::updateRmsWindow(float newWindowMs)
     {
-        if (input_dB < kneeStart)
-            return (input_dB - thresdB) * expansionSlope;
-        if (input_dB < kneeEnd)
-        {
-            const float x = input_dB - kneeEnd;
-            return expansionSlope / (2.0f * kneedB) * (x * x);
-        }
-        
-        return 0.0f;
+        levelDetectors.setRmsWindow(newWindowMs);
+    }
+
+    template <typename SampleType>
+    void Gate<SampleType>::updateSidechainFilter(SidechainFilterType newType)
+    {
+        sidechainFilter.setType(newType);
     }
 
-    float Gate::updateEnvelope(float targetGR_dB, float currentEnv_dB)
+    template <typename SampleType>
+    void Gate<SampleType>::updateSidechainFreq(float newFreqHz)
     {
-        // If target reduction is greater than current (Attack), or less (Release)
-        float alpha = (-targetGR_dB > -currentGR_dB) ? attackCoeff : releaseCoeff;
+        sidechainFilter.setFrequency(newFreqHz);
+    }
+
+    template <typename SampleType>
+    void Gate<SampleType>::updateSidechainQ(float newQ)
+    {
+        sidechainFilter.setQ(newQ);
+    }
+
+    template <typename SampleType>
+    void Gate<SampleType>::updateSidechainGain(float newGain_dB)
+    {
+        sidechainFilter.setGain(newGain_dB);
+    }
+
+    template <typename SampleType>
+    void Gate<SampleType>::updateLink(ChannelLink newLink)
+    {
+        linkedDetector.setLink(newLink);
+    }
+
+    template <typename SampleType>
+    void Gate<SampleType>::updateLinkWeight(float newWeight)
+    {
+        linkedDetector.setWeight(newWeight / 100.0f);
+    }
+
+    template <typename SampleType>
+    void Gate<SampleType>::updateLookahead(float newLookaheadMs)
+    {
+        lookaheadMs = juce::jlimit(0.0f, maxLookaheadMs, newLookaheadMs);
+        lookahead.setDelay(juce::roundToInt(lookaheadMs * 0.001f * sampleRate));
+    }
+
+    // --- Core Math Logic ---
+
+    template <typename SampleType>
+    float Gate<SampleType>::updateEnvelope(float targetGR_dB, float currentEnv_dB)
+    {
+        // Opening (target above the current gain) is the attack, closing the release
+        float alpha = (targetGR_dB > currentEnv_dB) ? attackCoeff : releaseCoeff;
         
         // Exponential smoothing: y[n] = a * y[n-1] + (1-a) * x[n]
-        float smoothedReductionAmount = (alpha * -currentGR_dB) + ((1.0f - alpha) * -targetGR_dB);
-        return -smoothedReductionAmount;
+        return (alpha * currentEnv_dB) + ((1.0f - alpha) * targetGR_dB);
     }
 
     // --- Methods for GUI ---
-    float Gate::getGainReduction()
+    template <typename SampleType>
+    float Gate<SampleType>::getGainReduction()
     {
         return currentGR_dB;
     }
 
     // --- PROCESS ---
-    void Gate::process(juce::AudioBuffer<float>& inputBuffer)
+    template <typename SampleType>
+    void Gate<SampleType>::process(juce::AudioBuffer<SampleType>& inputBuffer)
+    {
+        processBlock(inputBuffer, nullptr);
+    }
+
+    template <typename SampleType>
+    void Gate<SampleType>::processWithSidechain(juce::AudioBuffer<SampleType>& inputBuffer, const juce::dsp::AudioBlock<const SampleType>& sidechainBlock)
+    {
+        // A key shorter than the block can't drive it; fall back to self-keying rather than read past it
+        if (sidechainBlock.getNumChannels() == 0 || (int) sidechainBlock.getNumSamples() < inputBuffer.getNumSamples())
+        {
+            jassert (sidechainBlock.getNumChannels() == 0);
+            processBlock(inputBuffer, nullptr);
+            return;
+        }
+        
+        const SidechainInput<SampleType> sidechain (sidechainBlock, inputBuffer.getNumChannels());
+        processBlock(inputBuffer, &sidechain);
+    }
+
+    template <typename SampleType>
+    void Gate<SampleType>::processWithSidechain(juce::AudioBuffer<SampleType>& inputBuffer, const juce::AudioBuffer<SampleType>& sidechainBuffer)
+    {
+        processWithSidechain(inputBuffer, juce::dsp::AudioBlock<const SampleType>(sidechainBuffer));
+    }
+
+    template <typename SampleType>
+    void Gate<SampleType>::processBlock(juce::AudioBuffer<SampleType>& inputBuffer, const SidechainInput<SampleType>* sidechain)
     {
         const int numSamples = inputBuffer.getNumSamples();
         const int numChannels = inputBuffer.getNumChannels();
         
-        // Ensure envelope vector is correctly sized (safety)
-        if ((int)envelope.size() != numChannels)
-            envelope.assign(numChannels, 1.0f);
+        // Ensure the state vector is correctly sized (safety)
+        if ((int)channelStates.size() != numChannels)
+            channelStates.assign(numChannels, ChannelState { State::Closed, rangedB, 0 });
 
-        for (int channel = 0; channel < numChannels; ++channel)
+        if (numChannels == 0)
+            return;
+
+        levelDetectors.visit([&](auto& levelDetector)
         {
-            // Pointers for reading input and writing wet output
-            float* channelData = inputBuffer.getWritePointer(channel);
-            currentGR_dB = envelope[channel];
+            if (linkedDetector.isLinked() && numChannels > 1)
+                processLinked(levelDetector, inputBuffer.getArrayOfWritePointers(), numChannels, numSamples, sidechain);
+            else
+                for (int channel = 0; channel < numChannels; ++channel)
+                    processChannel(levelDetector, channel, inputBuffer.getWritePointer(channel), numSamples, sidechain);
+        });
+        
+        currentGR_dB = channelStates[0].envelope_dB; // For meter reporting
+    }
 
-            for (int sample = 0; sample < numSamples; ++sample)
-            {
-                float inputSample = channelData[sample];
-                float magnitude = std::max( std::abs (inputSample), gateMinMagnitude );
-                
-                // 1. SIDECHAIN: Convert magnitude to dB
-                const float inputDB = juce::Decibels::gainToDecibels(magnitude);
+    template <typename SampleType>
+    template <typename Detector>
+    void Gate<SampleType>::detectChannel(Detector& levelDetector, int channel, SampleType* channelData, int start, int numSamples,
+                                         const SidechainInput<SampleType>* sidechain)
+    {
+        SampleType* data = channelData + start;
+        
+        // External and/or filtered key; the filter writes into peak, which the detector reads in place
+        const SampleType* key = sidechain != nullptr ? sidechain->getChannel(channel, start, numSamples, sidechainMix.data()) : data;
+        const float* detectorInput = toDetectorInput(key, peak.data(), numSamples);
+        levelDetector.process(channel, sidechainFilter.process(channel, detectorInput, peak.data(), numSamples), peak.data(), numSamples);
+        
+        // Delays data in-place; peak holds the loudest level of the window ahead of it
+        if (lookahead.getDelay() > 0 && channel < lookahead.getNumChannels())
+            lookahead.process(channel, data, peak.data(), numSamples);
+    }
 
-                // 2. Gain Computer & Ballistics
-                float targetGR_dB = calculateTargetGain(inputDB);
-                currentGR_dB = updateEnvelope(targetGR_dB, currentGR_dB);
-                
-                // 4. APPLY GAIN (in-place)
-                const float gainReductionLinear = juce::Decibels::decibelsToGain(currentGR_dB);
-                float processed = inputSample * gainReductionLinear;
-                channelData[sample] = (processed * mix) + (inputSample * (1.0f - mix));
+    template <typename SampleType>
+    template <typename Detector>
+    void Gate<SampleType>::processLinked(Detector& levelDetector, SampleType* const* channelData, int numChannels, int numSamples,
+                                         const SidechainInput<SampleType>* sidechain)
+    {
+        if (peak.empty())
+            return;
+        
+        // One state machine for the whole bus, kept in every slot so unlinking carries on smoothly
+        const int blockSize = (int) peak.size();
+        
+        for (int start = 0; start < numSamples; start += blockSize)
+        {
+            const int num = juce::jmin(blockSize, numSamples - start);
+            
+            // 1. SIDECHAIN: every channel feeds the one linked detector
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                detectChannel(levelDetector, channel, channelData[channel], start, num, sidechain);
+                linkedDetector.accumulate(channel, peak.data(), num);
             }
             
-            // Store the final envelope value for the start of the next block
-            envelope[channel] = currentGR_dB;        
+            // 2. State machine & gain, once for every channel
+            applyGate(channelStates[0], linkedDetector.combine(numChannels, num), channelData, numChannels, start, num);
         }
+        
+        std::fill(channelStates.begin() + 1, channelStates.end(), channelStates[0]);
     }
 
-    void Gate::processWithSidechain(juce::AudioBuffer<float>& inputBuffer, juce::AudioBuffer<float>& sidechainBuffer)
+    template <typename SampleType>
+    template <typename Detector>
+    void Gate<SampleType>::processChannel(Detector& levelDetector, int channel, SampleType* channelData, int numSamples,
+                                          const SidechainInput<SampleType>* sidechain)
     {
-        const int numSamples = inputBuffer.getNumSamples();
-        const int numChannels = inputBuffer.getNumChannels();
+        if (peak.empty())
+            return;
         
-        // Ensure envelope vector is correctly sized (safety)
-        if ((int)envelope.size() != numChannels)
-            envelope.assign(numChannels, 1.0f);
-
-        for (int channel = 0; channel < numChannels; ++channel)
+        const int blockSize = (int) peak.size();
+        
+        for (int start = 0; start < numSamples; start += blockSize)
         {
-            // Pointers for reading input and writing wet output
-            float* sidechainData = sidechainBuffer.getReadPointer(ch);
-            float* channelData = inputBuffer.getWritePointer(channel);
-            currentGR_dB = envelope[channel];
+            const int num = juce::jmin(blockSize, numSamples - start);
+            
+            detectChannel(levelDetector, channel, channelData, start, num, sidechain);
+            applyGate(channelStates[(size_t) channel], peak.data(), &channelData, 1, start, num);
+        }
+    }
 
-            for (int sample = 0; sample < numSamples; ++sample)
+    template <typename SampleType>
+    void Gate<SampleType>::applyGate(ChannelState& gate, const float* levels, SampleType* const* channelData, int numChannels,
+                                     int start, int numSamples)
+    {
+        const float closedGain = DynamicsDecibels::decibelsToGain(rangedB) * mix + (1.0f - mix);
+        int sample = 0;
+        
+        while (sample < numSamples)
+        {
+            if (gate.state == State::Closed || gate.state == State::Open)
             {
-                float inputSample = channelData[sample];
-
-                // 1. SIDECHAIN
-                float sidechainInput = sidechainData[sample];
-                float magnitude = std::max( std::abs (sidechainInput), gateMinMagnitude );
+                // 1. FAST PATH: constant gain until the sample that changes state
+                const bool open = gate.state == State::Open;
+                int end = sample;
                 
-                // Convert magnitude to dB
-                const float inputDB = juce::Decibels::gainToDecibels(magnitude);
-
-                // 2. Gain Computer & Ballistics
-                float targetGR_dB = calculateTargetGain(inputDB);
-                currentGR_dB = updateEnvelope(targetGR_dB, currentGR_dB);
+                if (open)
+                    while (end < numSamples && levels[end] >= closeLevel) ++end;
+                else
+                    while (end < numSamples && levels[end] <= openLevel) ++end;
+                
+                // Open is unity gain: nothing to apply
+                if (! open && end > sample)
+                    for (int channel = 0; channel < numChannels; ++channel)
+                        juce::FloatVectorOperations::multiply(channelData[channel] + start + sample, (SampleType) closedGain, end - sample);
                 
-                // 4. APPLY GAIN (in-place)
-                const float gainReductionLinear = juce::Decibels::decibelsToGain(currentGR_dB);
-                float processed = inputSample * gainReductionLinear;
-                channelData[sample] = (processed * mix) + (inputSample * (1.0f - mix));
+                sample = end;
+                
+                if (sample < numSamples)
+                {
+                    gate.state = open ? State::Hold : State::Attack;
+                    gate.holdCounter = holdSamples;
+                }
+                
+                continue;
             }
             
-            // Store the final envelope value for the start of the next block
-            envelope[channel] = currentGR_dB;        
+            // 2. TRANSITIONS: per-sample state machine and smoothed gain until fully open or closed
+            for (; sample < numSamples; ++sample)
+            {
+                const float level = levels[sample];
+                
+                switch (gate.state)
+                {
+                    case State::Attack:
+                        if (level < closeLevel)
+                        {
+                            gate.state = State::Hold;
+                            gate.holdCounter = holdSamples;
+                        }
+                        break;
+                    case State::Hold:
+                        // Back above the closing level before the hold ran out: still open. The next
+                        // dip starts a fresh hold, so zero crossings of a Peak detector don't add up
+                        if (level >= closeLevel)
+                            gate.state = State::Attack;
+                        else if (--gate.holdCounter < 0)
+                            gate.state = State::Release;
+                        break;
+                    case State::Release:
+                        if (level > openLevel)
+                            gate.state = State::Attack;
+                        break;
+                    case State::Closed:
+                    case State::Open:
+                    default:
+                        break;
+                }
+                
+                // Attack and hold head for 0 dB, release for the range
+                const float target = gate.state == State::Release ? rangedB : 0.0f;
+                gate.envelope_dB = updateEnvelope(target, gate.envelope_dB);
+                
+                if (gate.state == State::Attack && gate.envelope_dB > -gateSnap_dB)
+                {
+                    gate.envelope_dB = 0.0f;
+                    gate.state = State::Open;
+                }
+                else if (gate.state == State::Release && gate.envelope_dB < rangedB + gateSnap_dB)
+                {
+                    gate.envelope_dB = rangedB;
+                    gate.state = State::Closed;
+                }
+                
+                // APPLY GAIN (in-place)
+                const float gain = DynamicsDecibels::decibelsToGain(gate.envelope_dB) * mix + (1.0f - mix);
+                
+                for (int channel = 0; channel < numChannels; ++channel)
+                    channelData[channel][start + sample] *= (SampleType) gain;
+                
+                if (gate.state == State::Open || gate.state == State::Closed)
+                {
+                    ++sample;
+                    break;
+                }
+            }
         }
     }
+
+    template class Gate<float>;
+    template class Gate<double>;
 }
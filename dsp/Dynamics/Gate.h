@@ -1,16 +1,50 @@
 #pragma once
 
 #include "juce_dsp/juce_dsp.h"
+#include "DecibelConversions.h"
+#include "Lookahead.h"
+#include "ChannelLink.h"
+#include "LevelDetectors.h"
+#include "SidechainInput.h"
+#include "SidechainFilter.h"
+#include "SampleConversions.h"
 
 /**
  * @class Gate
- * @brief Implements a smooth downward expander (intended to be used as a Noise Gate).
+ * @brief Implements a noise gate as a per-channel state machine: closed, attack, open, hold, release.
  *
  * All core dynamics processing, including sidechain detection, gain computation,
  * and envelope smoothing, is contained here.
+ *
+ * The gate opens when the detector rises above the threshold and only starts closing once it
+ * falls below threshold - hysteresis, so a signal hovering around the threshold doesn't chatter.
+ * The gate holds open until the level has stayed below that closing level for the hold time (any
+ * sample back above it restarts the hold), then releases down to the range (the attenuation while
+ * closed). Attack and release are smoothed in dB.
+ *
+ * While fully closed or fully open the gain is constant: the gate only scans the detector for
+ * the sample that changes state and applies a single multiply (none at all when open), so the
+ * log/exp work runs only during attack, hold and release.
+ *
+ * With updateLookahead() > 0 the audio is delayed and the detector reads the peak of the
+ * lookahead window, so the gate is open before an attack arrives instead of chopping it.
+ * Report getLatencySamples() to the host.
+ *
+ * updateLink() other than Independent opens and closes every channel together from one
+ * detector and one state machine.
+ *
+ * updateDetector() picks the sidechain level: Peak (default), RMS or TruePeak. The channel loop
+ * is instantiated per detector, so only the selected one runs in the inner loop.
+ *
+ * updateSidechainFilter() puts a high-pass, low-pass or bell biquad in front of the detector
+ * (self-keyed or external); the audio itself is never filtered.
+ *
+ * SampleType is float or double (both instantiated in Gate.cpp). The audio, the lookahead delay
+ * and the key stay in SampleType; detection and the state machine run in float.
  */
 namespace punk_dsp
 {
+    template <typename SampleType>
     class Gate
     {
     public:
@@ -19,51 +53,113 @@ namespace punk_dsp
 
         void prepare(const juce::dsp::ProcessSpec& spec);
         void reset();
-        
-        void updateRatio(float newRatio);
-        void updateThres(float newThres);
-        void updateKnee(float newKnee);
+
+        void updateThres(float newThres);              // Opening threshold in dB
+        void updateHysteresis(float newHysteresis);    // dB below the threshold where the gate closes
+        void updateHold(float newHoldMs);
+        void updateRange(float newRange);              // Attenuation while closed in dB, [-120, 0]
         void updateAttack(float newAttMs);
         void updateRelease(float newRelMs);
         void updateMix(float newMix);
-        
+        void updateLookahead(float newLookaheadMs);    // [0, maxLookaheadMs], 0 = off
+        void updateLink(ChannelLink newLink);
+        void updateLinkWeight(float newWeight);        // % of Max in ChannelLink::Weighted, the rest Mean
+        void updateDetector(DetectorType newDetector);
+        void updateRmsWindow(float newWindowMs);       // RMS detector window, default 10 ms
+        void updateSidechainFilter(SidechainFilterType newType);
+        void updateSidechainFreq(float newFreqHz);
+        void updateSidechainQ(float newQ);
+        void updateSidechainGain(float newGain_dB);    // Bell only
+
         float getGainReduction();
+        int getLatencySamples() const noexcept { return lookahead.getDelay(); }
+
+        static constexpr float maxLookaheadMs = 20.0f;
 
         /**
-        * @brief Processes the audio buffer in-place, applying a Downward Expander topology.
+        * @brief Processes the audio buffer in-place, gating it.
         *
         * @param inputBuffer The buffer containing the signal to be processed.
         */
-        void process(juce::AudioBuffer<float>& inputBuffer);
+        void process(juce::AudioBuffer<SampleType>& inputBuffer);
 
-        void processWithSidechain(juce::AudioBuffer<float>& inputBuffer, juce::AudioBuffer<float>& sidechainBuffer);
+        /**
+        * @brief Processes the audio buffer in-place, opening and closing from an external key signal.
+        *
+        * The key is read in place: matching channels key 1:1, a mono key is broadcast, any other
+        * layout keys every channel with its mean. It must be at least as long as the buffer.
+        */
+        void processWithSidechain(juce::AudioBuffer<SampleType>& inputBuffer, const juce::dsp::AudioBlock<const SampleType>& sidechainBlock);
+        void processWithSidechain(juce::AudioBuffer<SampleType>& inputBuffer, const juce::AudioBuffer<SampleType>& sidechainBuffer);
 
     private:
+        enum class State
+        {
+            Closed,     // Constant gain at the range
+            Attack,     // Opening towards 0 dB
+            Open,       // Unity gain
+            Hold,       // Level below the closing level, staying open for holdSamples
+            Release     // Closing towards the range
+        };
+
+        struct ChannelState
+        {
+            State state = State::Closed;
+            float envelope_dB = -80.0f;     // Gain being applied, in dB
+            int holdCounter = 0;
+        };
+
         // Internal Math Methods
-        float calculateTargetGain (float inputDB);
         float updateEnvelope (float targetGR_dB, float currentEnv_dB);
-        void updateKneeRange();
+        void updateThresholds();
         float calculateTimeCoeff (float time_ms);
 
+        void processBlock (juce::AudioBuffer<SampleType>& inputBuffer, const SidechainInput<SampleType>* sidechain);
+
+        template <typename Detector>
+        void processChannel (Detector& levelDetector, int channel, SampleType* channelData, int numSamples,
+                             const SidechainInput<SampleType>* sidechain);
+        template <typename Detector>
+        void processLinked (Detector& levelDetector, SampleType* const* channelData, int numChannels, int numSamples,
+                            const SidechainInput<SampleType>* sidechain);
+
+        // Detector level of the key (lookahead peak of it) into peak; delays the audio when looking ahead
+        template <typename Detector>
+        void detectChannel (Detector& levelDetector, int channel, SampleType* channelData, int start, int numSamples,
+                            const SidechainInput<SampleType>* sidechain);
+
+        // Runs the state machine over levels and applies its gain to every given channel from start
+        void applyGate (ChannelState& gate, const float* levels, SampleType* const* channelData, int numChannels,
+                        int start, int numSamples);
+
         // --- Internal State ---
-        std::vector<float> envelope; // Stores the current applied linear gain factor
+        std::vector<ChannelState> channelStates;
         float currentGR_dB = 0.0f;
-        
+
+        Lookahead<SampleType> lookahead; // Delay line + sliding peak, allocated in prepare
+        std::vector<float> peak;        // Detector level scratch, maximumBlockSize
+        LinkedDetector linkedDetector;  // Channel link scratch, maximumBlockSize
+        LevelDetectors levelDetectors;  // Peak / RMS / true-peak sidechain level
+        SidechainFilter sidechainFilter; // HP / LP / bell on the detector path only
+        std::vector<SampleType> sidechainMix; // Key downmix scratch, maximumBlockSize
+
         // Parameters
-        float ratio         = 6.0f;     // Linear ratio
-        float thresdB       = -80.0f;   // Threshold in dB
-        float kneedB        = 9.0f;     // Knee width in dB
+        float thresdB       = -80.0f;   // Opening threshold in dB
+        float hysteresisdB  = 4.0f;     // Closing threshold = thresdB - hysteresisdB
+        float holdMs        = 10.0f;    // Hold time
+        float rangedB       = -80.0f;   // Attenuation while closed
         float attackCoeff   = 0.0f;     // Smoothing coefficient (Attack)
         float releaseCoeff  = 0.0f;     // Smoothing coefficient (Release)
         float mix           = 1.0f;     // Mix (dry/wet)
-        
+        float lookaheadMs   = 0.0f;     // Detector lookahead (and added latency)
+
         // Cached values for performance
         float sampleRate        = 44100.0f;
-        float expansionSlope    = 5.0f;     // ratio - 1.0f
-        float kneeStart         = -100.0f;
-        float kneeEnd           = -60.0f;
+        float openLevel         = 0.0001f;  // Linear opening threshold
+        float closeLevel        = 0.00006f; // Linear closing threshold
+        int holdSamples         = 441;
 
         // --- Prevent copy and move ---
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Gate)
     };
-}
\ No newline at end of file
+}
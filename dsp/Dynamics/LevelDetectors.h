@@ -0,0 +1,295 @@
+#pragma once
+
+#include "juce_dsp/juce_dsp.h"
+
+namespace punk_dsp
+{
+    /**
+     * Peak:     |x| per sample (the classic detector).
+     * RMS:      sqrt of the mean square over a sliding window (setRmsWindow), O(1) per sample.
+     * TruePeak: max |x| of a 4x polyphase FIR interpolation, catching inter-sample peaks.
+     */
+    enum class DetectorType
+    {
+        Peak,
+        RMS,
+        TruePeak
+    };
+
+    /**
+     * Every detector turns a block of input into a block of linear levels with
+     * process(channel, input, levels, numSamples). Channels beyond the ones given to prepare()
+     * fall back to |x|, so a resized bus never reads past the preallocated state.
+     */
+    struct PeakDetector
+    {
+        void prepare (double, int) {}
+        void reset() {}
+
+        void process (int, const float* input, float* levels, int numSamples) noexcept
+        {
+            juce::FloatVectorOperations::abs (levels, input, numSamples);
+        }
+    };
+
+    /**
+     * @class RmsDetector
+     * @brief Sliding-window RMS from a running sum of squares.
+     *
+     * Each sample adds its square and subtracts the one leaving the window. The sum is kept in
+     * double so its rounding error stays far below the quietest level the dynamics care about.
+     */
+    class RmsDetector
+    {
+    public:
+        static constexpr float maxWindowMs = 300.0f;
+
+        void prepare (double newSampleRate, int numChannels)
+        {
+            sampleRate = newSampleRate;
+            const int size = juce::nextPowerOfTwo ((int) std::ceil (maxWindowMs * 0.001 * sampleRate) + 1);
+            mask = (juce::uint32) size - 1;
+
+            channels.resize ((size_t) numChannels);
+
+            for (auto& ch : channels)
+                ch.squares.assign ((size_t) size, 0.0f);
+
+            setWindow (windowMs);
+        }
+
+        void reset()
+        {
+            for (auto& ch : channels)
+            {
+                std::fill (ch.squares.begin(), ch.squares.end(), 0.0f);
+                ch.sum = 0.0;
+                ch.writePos = 0;
+            }
+        }
+
+        // Clears the running sums when the window length changes
+        void setWindow (float newWindowMs)
+        {
+            windowMs = juce::jlimit (0.1f, maxWindowMs, newWindowMs);
+
+            if (channels.empty())
+                return;
+
+            const int newLength = juce::jlimit (1, (int) mask, juce::roundToInt (windowMs * 0.001 * sampleRate));
+
+            if (newLength != windowLength)
+            {
+                windowLength = newLength;
+                reset();
+            }
+        }
+
+        void process (int channel, const float* input, float* levels, int numSamples) noexcept
+        {
+            if (channel >= (int) channels.size())
+            {
+                juce::FloatVectorOperations::abs (levels, input, numSamples);
+                return;
+            }
+
+            auto& ch = channels[(size_t) channel];
+            float* squares = ch.squares.data();
+            const auto length = (juce::uint32) windowLength;
+            const double scale = 1.0 / (double) windowLength;
+            double sum = ch.sum;
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const float square = input[i] * input[i];
+                const juce::uint32 pos = ch.writePos++;
+
+                sum += (double) square - (double) squares[(pos - length) & mask];
+                squares[pos & mask] = square;
+
+                levels[i] = (float) std::sqrt (juce::jmax (0.0, sum * scale));
+            }
+
+            ch.sum = sum;
+        }
+
+    private:
+        struct ChannelState
+        {
+            std::vector<float> squares;     // Power-of-two ring of the last squares
+            double sum = 0.0;
+            juce::uint32 writePos = 0;      // Free-running, masked on access
+        };
+
+        std::vector<ChannelState> channels;
+        double sampleRate = 44100.0;
+        float windowMs = 10.0f;
+        int windowLength = 0;
+        juce::uint32 mask = 0;
+    };
+
+    /**
+     * @class TruePeakDetector
+     * @brief 4x oversampled peak: a 47-tap windowed-sinc interpolator split into 4 polyphase
+     *        branches of 12 taps, then the max |y| of the 4 phases per input sample.
+     *
+     * The input history is written twice into a ring of 2 * 12 samples, so every branch is a
+     * contiguous 12-tap dot product. The interpolator delays the detector by ~6 samples; pair it
+     * with lookahead where that matters.
+     */
+    class TruePeakDetector
+    {
+    public:
+        static constexpr int factor = 4;
+        static constexpr int tapsPerPhase = 12;
+
+        TruePeakDetector()
+        {
+            // Lowpass at the original Nyquist over 47 taps (the 48th is zero). The odd length centres
+            // the filter on a tap, so one phase is a pure delay and true peak never reads below |x|.
+            // Hann window, each phase normalised to unity DC gain
+            constexpr int length = factor * tapsPerPhase - 1;
+            constexpr int centre = length / 2;
+
+            for (int phase = 0; phase < factor; ++phase)
+            {
+                double sum = 0.0;
+
+                for (int tap = 0; tap < tapsPerPhase; ++tap)
+                {
+                    const int n = tap * factor + phase;
+                    double coeff = 0.0;
+
+                    if (n == centre)
+                        coeff = 1.0;
+                    else if (n < length)
+                    {
+                        const double x = juce::MathConstants<double>::pi * (double) (n - centre) / (double) factor;
+                        const double window = 0.5 - 0.5 * std::cos (2.0 * juce::MathConstants<double>::pi * (double) (n + 1) / (double) (length + 1));
+                        coeff = std::sin (x) / x * window;
+                    }
+
+                    // Taps run oldest -> newest, matching the history layout
+                    phases[phase][tapsPerPhase - 1 - tap] = (float) coeff;
+                    sum += coeff;
+                }
+
+                for (auto& coeff : phases[phase])
+                    coeff = (float) (coeff / sum);
+            }
+        }
+
+        void prepare (double, int numChannels)
+        {
+            channels.resize ((size_t) numChannels);
+            reset();
+        }
+
+        void reset()
+        {
+            for (auto& ch : channels)
+            {
+                ch.history.fill (0.0f);
+                ch.writePos = 0;
+            }
+        }
+
+        void process (int channel, const float* input, float* levels, int numSamples) noexcept
+        {
+            if (channel >= (int) channels.size())
+            {
+                juce::FloatVectorOperations::abs (levels, input, numSamples);
+                return;
+            }
+
+            auto& ch = channels[(size_t) channel];
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                // history[pos .. pos + tapsPerPhase) is always the newest tapsPerPhase samples, oldest first
+                ch.history[(size_t) ch.writePos] = ch.history[(size_t) (ch.writePos + tapsPerPhase)] = input[i];
+                ch.writePos = (ch.writePos + 1) % tapsPerPhase;
+                const float* recent = ch.history.data() + ch.writePos;
+
+                float level = 0.0f;
+
+                for (int phase = 0; phase < factor; ++phase)
+                {
+                    float y = 0.0f;
+
+                    for (int tap = 0; tap < tapsPerPhase; ++tap)
+                        y += phases[phase][tap] * recent[tap];
+
+                    level = juce::jmax (level, std::abs (y));
+                }
+
+                levels[i] = level;
+            }
+        }
+
+    private:
+        struct ChannelState
+        {
+            std::array<float, 2 * tapsPerPhase> history {};
+            int writePos = 0;
+        };
+
+        float phases[factor][tapsPerPhase] {};
+        std::vector<ChannelState> channels;
+    };
+
+    /**
+     * @class LevelDetectors
+     * @brief Holds one of each detector and hands the selected one to a generic callable.
+     *
+     * Processors call visit() once per block and run their detection loop as a template on the
+     * detector it passes, so the inner loop only ever contains the selected detector.
+     */
+    class LevelDetectors
+    {
+    public:
+        void prepare (double sampleRate, int numChannels)
+        {
+            peak.prepare (sampleRate, numChannels);
+            rms.prepare (sampleRate, numChannels);
+            truePeak.prepare (sampleRate, numChannels);
+        }
+
+        void reset()
+        {
+            rms.reset();
+            truePeak.reset();
+        }
+
+        void setType (DetectorType newType)
+        {
+            if (newType != type)
+            {
+                type = newType;
+                reset();
+            }
+        }
+
+        void setRmsWindow (float newWindowMs)   { rms.setWindow (newWindowMs); }
+
+        DetectorType getType() const noexcept   { return type; }
+
+        template <typename Fn>
+        void visit (Fn&& fn)
+        {
+            switch (type)
+            {
+                case DetectorType::RMS:         fn (rms); break;
+                case DetectorType::TruePeak:    fn (truePeak); break;
+                case DetectorType::Peak:
+                default:                        fn (peak); break;
+            }
+        }
+
+    private:
+        PeakDetector peak;
+        RmsDetector rms;
+        TruePeakDetector truePeak;
+        DetectorType type = DetectorType::Peak;
+    };
+}
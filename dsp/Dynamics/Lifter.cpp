@@ -5,76 +5,145 @@ static constexpr float lifterMinMagnitude = 0.0001f; // Approx -100 dB
 
 namespace punk_dsp
 {
-    Lifter::Lifter()
+    template <typename SampleType>
+    Lifter<SampleType>::Lifter()
     {
         // Initialize envelope vector size to 0
     }
 
-    void Lifter::prepare(const juce::dsp::ProcessSpec& spec)
+    template <typename SampleType>
+    void Lifter<SampleType>::prepare(const juce::dsp::ProcessSpec& spec)
     {
         sampleRate = spec.sampleRate;
         envelope.assign (spec.numChannels, 1.0f);
         
+        detector.assign (juce::jmax (1u, spec.maximumBlockSize), 0.0f);
+        linkedDetector.prepare ((int) detector.size());
+        sidechainMix.assign (detector.size(), 0.0f);
+        levelDetectors.prepare (sampleRate, (int) spec.numChannels);
+        sidechainFilter.prepare (sampleRate, (int) spec.numChannels);
+        
         // Recalculate time coefficients based on current sample rate
         attackCoeff = calculateTimeCoeff (10.0f);
         releaseCoeff = calculateTimeCoeff (100.0f); 
     }
 
-    void Lifter::reset()
+    template <typename SampleType>
+    void Lifter<SampleType>::reset()
     {
         std::fill (envelope.begin(), envelope.end(), 1.0f);
+        levelDetectors.reset();
+        sidechainFilter.reset();
     }
 
-    float Lifter::calculateTimeCoeff(float time_ms)
+    template <typename SampleType>
+    float Lifter<SampleType>::calculateTimeCoeff(float time_ms)
     {
         // return std::exp(-2.0f * juce::MathConstants<float>::pi * 1000.f / time_ms / sampleRate);
         return std::exp(-1.f / (0.001f * time_ms * sampleRate));
     }
 
-    void Lifter::updateRatio(float newRatio)
+    template <typename SampleType>
+    void Lifter<SampleType>::updateRatio(float newRatio)
     {
         ratio = newRatio;
         compressionSlope = 1.0f - (1.0f / ratio);
     }
 
-    void Lifter::updateRange(float newRange)
+    template <typename SampleType>
+    void Lifter<SampleType>::updateRange(float newRange)
     {
         rangedB = newRange;
     }
 
-    void Lifter::updateKnee(float newKnee)
+    template <typename SampleType>
+    void Lifter<SampleType>::updateKnee(float newKnee)
     {
         kneedB = newKnee;
     }
 
-    void Lifter::updateAttack(float newAttMs)
+    template <typename SampleType>
+    void Lifter<SampleType>::updateAttack(float newAttMs)
     {
         attackCoeff = calculateTimeCoeff(newAttMs);
     }
 
-    void Lifter::updateRelease(float newRelMs)
+    template <typename SampleType>
+    void Lifter<SampleType>::updateRelease(float newRelMs)
     {
         releaseCoeff = calculateTimeCoeff(newRelMs);
     }
 
-    void Lifter::updateMakeUp(float newMakeUp_dB)
+    template <typename SampleType>
+    void Lifter<SampleType>::updateMakeUp(float newMakeUp_dB)
     {
         makeUpGain_linear = juce::Decibels::decibelsToGain(newMakeUp_dB);
     }
 
-    void Lifter::updateMix(float newMix)
+    template <typename SampleType>
+    void Lifter<SampleType>::updateMix(float newMix)
     {
         mix = newMix / 100.0f;
     }
 
-    void Lifter::updateFeedForward(bool newFeedForward)
+    template <typename SampleType>
+    void Lifter<SampleType>::updateFeedForward(bool newFeedForward)
     {
         useFeedForward = newFeedForward;
     }
 
+    template <typename SampleType>
+    void Lifter<SampleType>::updateDetector(DetectorType newDetector)
+    {
+        levelDetectors.setType(newDetector);
+    }
+
+    template <typename SampleType>
+    void Lifter<SampleType>::updateRmsWindow(float newWindowMs)
+    {
+        levelDetectors.setRmsWindow(newWindowMs);
+    }
+
+    template <typename SampleType>
+    void Lifter<SampleType>::updateSidechainFilter(SidechainFilterType newType)
+    {
+        sidechainFilter.setType(newType);
+    }
+
+    template <typename SampleType>
+    void Lifter<SampleType>::updateSidechainFreq(float newFreqHz)
+    {
+        sidechainFilter.setFrequency(newFreqHz);
+    }
+
+    template <typename SampleType>
+    void Lifter<SampleType>::updateSidechainQ(float newQ)
+    {
+        sidechainFilter.setQ(newQ);
+    }
+
+    template <typename SampleType>
+    void Lifter<SampleType>::updateSidechainGain(float newGain_dB)
+    {
+        sidechainFilter.setGain(newGain_dB);
+    }
+
+    template <typename SampleType>
+    void Lifter<SampleType>::updateLink(ChannelLink newLink)
+    {
+        linkedDetector.setLink(newLink);
+    }
+
+    template <typename SampleType>
+    void Lifter<SampleType>::updateLinkWeight(float newWeight)
+    {
+        linkedDetector.setWeight(newWeight / 100.0f);
+    }
+
     // --- Core Math Logic ---
 
-    float Lifter::calculateTargetGain(float inputDB)
+    template <typename SampleType>
+    float Lifter<SampleType>::calculateTargetGain(float inputDB)
     {
         float targetGR = 0.0f;
         if (inputDB < kneeStart)
@@ -87,12 +156,13 @@ namespace punk_dsp
             targetGR = compressionSlope / (2.0f * kneedB) * (x * x);
         }
         
-        targetGR = juce::Decibels::decibelsToGain(targetGR);
+        targetGR = DynamicsDecibels::decibelsToGain(targetGR);
         
         return targetGR;
     }
 
-    float Lifter::updateEnvelope(float targetGR_lin, float currentEnv_lin)
+    template <typename SampleType>
+    float Lifter<SampleType>::updateEnvelope(float targetGR_lin, float currentEnv_lin)
     {
         float alpha = (targetGR_lin > currentEnv_lin) ? attackCoeff : releaseCoeff;
         
@@ -101,12 +171,41 @@ namespace punk_dsp
     }
 
     // --- Methods for GUI ---
-    float Lifter::getGainAddition()
+    template <typename SampleType>
+    float Lifter<SampleType>::getGainAddition()
     {
         return juce::Decibels::gainToDecibels(currentGA_linear);
     }
 
-    void Lifter::process(juce::AudioBuffer<float>& inputBuffer)
+    template <typename SampleType>
+    void Lifter<SampleType>::process(juce::AudioBuffer<SampleType>& inputBuffer)
+    {
+        processBlock(inputBuffer, nullptr);
+    }
+
+    template <typename SampleType>
+    void Lifter<SampleType>::processWithSidechain(juce::AudioBuffer<SampleType>& inputBuffer, const juce::dsp::AudioBlock<const SampleType>& sidechainBlock)
+    {
+        // A key shorter than the block can't drive it; fall back to self-keying rather than read past it
+        if (sidechainBlock.getNumChannels() == 0 || (int) sidechainBlock.getNumSamples() < inputBuffer.getNumSamples())
+        {
+            jassert (sidechainBlock.getNumChannels() == 0);
+            processBlock(inputBuffer, nullptr);
+            return;
+        }
+        
+        const SidechainInput<SampleType> sidechain (sidechainBlock, inputBuffer.getNumChannels());
+        processBlock(inputBuffer, &sidechain);
+    }
+
+    template <typename SampleType>
+    void Lifter<SampleType>::processWithSidechain(juce::AudioBuffer<SampleType>& inputBuffer, const juce::AudioBuffer<SampleType>& sidechainBuffer)
+    {
+        processWithSidechain(inputBuffer, juce::dsp::AudioBlock<const SampleType>(sidechainBuffer));
+    }
+
+    template <typename SampleType>
+    void Lifter<SampleType>::processBlock(juce::AudioBuffer<SampleType>& inputBuffer, const SidechainInput<SampleType>* sidechain)
     {
         const int numSamples = inputBuffer.getNumSamples();
         const int numChannels = inputBuffer.getNumChannels();
@@ -115,87 +214,145 @@ namespace punk_dsp
         if ((int)envelope.size() != numChannels)
             envelope.assign(numChannels, 1.0f);
 
-        for (int channel = 0; channel < numChannels; ++channel)
+        if (linkedDetector.isLinked() && numChannels > 1)
+        {
+            levelDetectors.visit([&](auto& levelDetector)
+            {
+                processLinked(levelDetector, inputBuffer.getArrayOfWritePointers(), numChannels, numSamples, sidechain);
+            });
+            return;
+        }
+
+        const bool keyed = sidechain != nullptr || sidechainFilter.isActive();
+
+        levelDetectors.visit([&](auto& levelDetector)
         {
-            // Pointers for reading input and writing wet output
-            float* channelData = inputBuffer.getWritePointer(channel);
-            currentGA_linear = envelope[channel];
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                SampleType* channelData = inputBuffer.getWritePointer(channel);
+                
+                if (keyed)
+                    processChannel<true>(levelDetector, channel, channelData, numSamples, sidechain);
+                else
+                    processChannel<false>(levelDetector, channel, channelData, numSamples, nullptr);
+            }
+        });
+    }
 
-            for (int sample = 0; sample < numSamples; ++sample)
+    template <typename SampleType>
+    template <bool keyed, typename Detector>
+    void Lifter<SampleType>::processChannel(Detector& levelDetector, int channel, SampleType* channelData, int numSamples,
+                                            const SidechainInput<SampleType>* sidechain)
+    {
+        currentGA_linear = envelope[channel];
+        
+        // Plain self-keyed peak detection stays inline; anything else detects a block at a time into the scratch
+        constexpr bool detectInline = ! keyed && std::is_same_v<Detector, PeakDetector>;
+        const int blockSize = detectInline ? numSamples : (int) detector.size();
+        
+        for (int start = 0; start < numSamples; start += blockSize)
+        {
+            SampleType* data = channelData + start;
+            const int num = juce::jmin(blockSize, numSamples - start);
+            
+            if constexpr (keyed)
             {
-                float inputSample = channelData[sample];
+                // External and/or filtered key; the filter writes into the scratch, which the detector reads in place
+                const SampleType* key = sidechain != nullptr ? sidechain->getChannel(channel, start, num, sidechainMix.data()) : data;
+                const float* detectorInput = toDetectorInput(key, detector.data(), num);
+                levelDetector.process(channel, sidechainFilter.process(channel, detectorInput, detector.data(), num), detector.data(), num);
+            }
+            else if constexpr (! detectInline)
+                levelDetector.process(channel, toDetectorInput(data, detector.data(), num), detector.data(), num);
+            
+            for (int sample = 0; sample < num; ++sample)
+            {
+                SampleType inputSample = data[sample];
                 
                 // 1. Identify Sidechain Input based on Topology
-                float sidechainInput = inputSample;
+                float sidechainInput = detectInline ? (float) std::abs(inputSample) : detector[(size_t) sample];
                 
                 if (!useFeedForward)
                 {
                     // Feed-back uses the PREVIOUS output (estimated by current envelope)
                     float prevGain = currentGA_linear * makeUpGain_linear;
-                    sidechainInput = inputSample * prevGain;
+                    sidechainInput = sidechainInput * prevGain;
                 }
 
                 // 2. Detection (Sidechain)
-                const float magnitude = std::max( std::abs(sidechainInput), lifterMinMagnitude );
-                const float inputDB = juce::Decibels::gainToDecibels(magnitude);
+                const float magnitude = std::max( sidechainInput, lifterMinMagnitude );
+                const float inputDB = DynamicsDecibels::gainToDecibels(magnitude);
                 
                 // 3. ENVELOPE SMOOTHING (in dB)
                 float targetGR_lin = calculateTargetGain(inputDB);
                 currentGA_linear = updateEnvelope(targetGR_lin, currentGA_linear);
                 
                 // 4. APPLY GAIN (in-place)
-                channelData[sample] = inputSample * currentGA_linear * makeUpGain_linear * mix + inputSample * (1.0f - mix);
+                data[sample] = inputSample * currentGA_linear * makeUpGain_linear * mix + inputSample * (1.0f - mix);
             }
-
-            // Store the final envelope value for the start of the next block
-            envelope[channel] = currentGA_linear;
         }
+
+        // Store the final envelope value for the start of the next block
+        envelope[channel] = currentGA_linear;
     }
 
-    void Lifter::processWithSidechain(juce::AudioBuffer<float>& inputBuffer, juce::AudioBuffer<float>& sidechainBuffer)
+    template <typename SampleType>
+    template <typename Detector>
+    void Lifter<SampleType>::processLinked(Detector& levelDetector, SampleType* const* channelData, int numChannels, int numSamples,
+                                           const SidechainInput<SampleType>* sidechain)
     {
-        const int numSamples = inputBuffer.getNumSamples();
-        const int numChannels = inputBuffer.getNumChannels();
+        if (detector.empty())
+            return;
         
-        // Ensure envelope vector is correctly sized (safety)
-        if ((int)envelope.size() != numChannels)
-            envelope.assign(numChannels, 1.0f);
-
-        for (int channel = 0; channel < numChannels; ++channel)
+        // One envelope for the whole bus, kept in every slot so unlinking carries on smoothly
+        currentGA_linear = envelope[0];
+        const int blockSize = (int) detector.size();
+        
+        for (int start = 0; start < numSamples; start += blockSize)
         {
-            // Pointers for reading input and writing wet output
-            float* sidechainData = sidechainBuffer.getReadPointer(ch);
-            float* channelData = inputBuffer.getWritePointer(channel);
-            currentGA_linear = envelope[channel];
-
-            for (int sample = 0; sample < numSamples; ++sample)
+            const int num = juce::jmin(blockSize, numSamples - start);
+            
+            // 1. Every channel feeds the one linked detector
+            for (int channel = 0; channel < numChannels; ++channel)
             {
-                float inputSample = channelData[sample];
-                
-                // 1. Identify Sidechain Input based on Topology
-                float sidechainInput = sidechainData[sample];
+                const SampleType* key = sidechain != nullptr ? sidechain->getChannel(channel, start, num, sidechainMix.data())
+                                                             : channelData[channel] + start;
+                const float* detectorInput = toDetectorInput(key, detector.data(), num);
+                levelDetector.process(channel, sidechainFilter.process(channel, detectorInput, detector.data(), num), detector.data(), num);
+                linkedDetector.accumulate(channel, detector.data(), num);
+            }
+            
+            const float* linked = linkedDetector.combine(numChannels, num);
+            
+            for (int sample = 0; sample < num; ++sample)
+            {
+                float sidechainInput = linked[sample];
                 
                 if (!useFeedForward)
                 {
                     // Feed-back uses the PREVIOUS output (estimated by current envelope)
-                    float prevGain = currentGA_linear * makeUpGain_linear;
-                    sidechainInput = sidechainInput * prevGain;
+                    sidechainInput *= currentGA_linear * makeUpGain_linear;
                 }
-
+                
                 // 2. Detection (Sidechain)
-                const float magnitude = std::max( std::abs(sidechainInput), lifterMinMagnitude );
-                const float inputDB = juce::Decibels::gainToDecibels(magnitude);
+                const float magnitude = std::max( sidechainInput, lifterMinMagnitude );
+                const float inputDB = DynamicsDecibels::gainToDecibels(magnitude);
                 
-                // 3. ENVELOPE SMOOTHING (in dB)
+                // 3. ENVELOPE SMOOTHING, once for all channels, into a gain curve (mix folded in)
                 float targetGR_lin = calculateTargetGain(inputDB);
                 currentGA_linear = updateEnvelope(targetGR_lin, currentGA_linear);
                 
-                // 4. APPLY GAIN (in-place)
-                channelData[sample] = inputSample * currentGA_linear * makeUpGain_linear * mix + inputSample * (1.0f - mix);
+                detector[(size_t) sample] = currentGA_linear * makeUpGain_linear * mix + (1.0f - mix);
             }
-
-            // Store the final envelope value for the start of the next block
-            envelope[channel] = currentGA_linear;
+            
+            // 4. APPLY GAIN (in-place) to every channel
+            for (int channel = 0; channel < numChannels; ++channel)
+                applyGains(channelData[channel] + start, detector.data(), num);
         }
+        
+        std::fill(envelope.begin(), envelope.end(), currentGA_linear);
     }
-}
+
+    template class Lifter<float>;
+    template class Lifter<double>;
+}
\ No newline at end of file
@@ -1,6 +1,12 @@
 #pragma once
 
 #include "juce_dsp/juce_dsp.h"
+#include "DecibelConversions.h"
+#include "ChannelLink.h"
+#include "LevelDetectors.h"
+#include "SidechainInput.h"
+#include "SidechainFilter.h"
+#include "SampleConversions.h"
 
 /**
  * @class Lifter
@@ -8,9 +14,22 @@
  *
  * All core dynamics processing, including sidechain detection, gain computation,
  * and envelope smoothing, is contained here.
+ *
+ * updateLink() other than Independent lifts every channel by the same gain from one detector,
+ * so the stereo image holds and the log/exp work runs once per sample for the whole bus.
+ *
+ * updateDetector() picks the sidechain level: Peak (default), RMS or TruePeak. The channel loop
+ * is instantiated per detector, so only the selected one runs in the inner loop.
+ *
+ * updateSidechainFilter() puts a high-pass, low-pass or bell biquad in front of the detector
+ * (self-keyed or external); the audio itself is never filtered.
+ *
+ * SampleType is float or double (both instantiated in Lifter.cpp). The audio and the key stay
+ * in SampleType; detection and the gain envelope run in float.
  */
 namespace punk_dsp
 {
+    template <typename SampleType>
     class Lifter
     {
     public:
@@ -28,6 +47,14 @@ namespace punk_dsp
         void updateMakeUp(float newMakeUp_dB);
         void updateMix(float newMix);
         void updateFeedForward(bool newFeedForward);
+        void updateLink(ChannelLink newLink);
+        void updateLinkWeight(float newWeight);        // % of Max in ChannelLink::Weighted, the rest Mean
+        void updateDetector(DetectorType newDetector);
+        void updateRmsWindow(float newWindowMs);       // RMS detector window, default 10 ms
+        void updateSidechainFilter(SidechainFilterType newType);
+        void updateSidechainFreq(float newFreqHz);
+        void updateSidechainQ(float newQ);
+        void updateSidechainGain(float newGain_dB);    // Bell only
         
         float getGainAddition();
         
@@ -37,9 +64,16 @@ namespace punk_dsp
         * @param inputBuffer This buffer is overwritten with the fully wet, compressed signal.
         * @param useFeedForward Select when the sidechain signal is measured
         */
-        void process(juce::AudioBuffer<float>& inputBuffer);
+        void process(juce::AudioBuffer<SampleType>& inputBuffer);
 
-        void processWithSidechain(juce::AudioBuffer<float>& inputBuffer, juce::AudioBuffer<float>& sidechainBuffer);
+        /**
+        * @brief Processes the audio buffer in-place, lifting it from an external key signal.
+        *
+        * The key is read in place: matching channels key 1:1, a mono key is broadcast, any other
+        * layout keys every channel with its mean. It must be at least as long as the buffer.
+        */
+        void processWithSidechain(juce::AudioBuffer<SampleType>& inputBuffer, const juce::dsp::AudioBlock<const SampleType>& sidechainBlock);
+        void processWithSidechain(juce::AudioBuffer<SampleType>& inputBuffer, const juce::AudioBuffer<SampleType>& sidechainBuffer);
 
     private:
         // Internal Math Methods
@@ -48,10 +82,25 @@ namespace punk_dsp
         void updateKneeRange();
         float calculateTimeCoeff (float time_ms);
 
+        void processBlock (juce::AudioBuffer<SampleType>& inputBuffer, const SidechainInput<SampleType>* sidechain);
+        
+        template <bool keyed, typename Detector>
+        void processChannel (Detector& levelDetector, int channel, SampleType* channelData, int numSamples,
+                             const SidechainInput<SampleType>* sidechain);
+        template <typename Detector>
+        void processLinked (Detector& levelDetector, SampleType* const* channelData, int numChannels, int numSamples,
+                            const SidechainInput<SampleType>* sidechain);
+
         // --- Internal State ---
         std::vector<float> envelope; // Stores the current applied linear gain factor
         float currentGA_linear = 1.0f;  // Gain reduction being applied currently
         
+        std::vector<float> detector;    // Detector level / gain curve scratch, maximumBlockSize
+        LinkedDetector linkedDetector;  // Channel link scratch, maximumBlockSize
+        LevelDetectors levelDetectors;  // Peak / RMS / true-peak sidechain level
+        SidechainFilter sidechainFilter; // HP / LP / bell on the detector path only
+        std::vector<SampleType> sidechainMix; // Key downmix scratch, maximumBlockSize
+        
         // Parameters
         float ratio             = 4.0f;     // Linear ratio (e.g., 4.0 for 4:1)
         float rangedB           = -40.0f;   // Threshold in dB
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "juce_dsp/juce_dsp.h"
+
+namespace punk_dsp
+{
+    /**
+     * @class Lookahead
+     * @brief Delays the audio by N samples and reports, for every delayed sample, the peak detector
+     *        level of the N + 1 input samples ending at the current one.
+     *
+     * The detector therefore sees a transient N samples before the gain is applied to it. The peak
+     * is a sliding-window maximum kept in a monotonic deque (values strictly decreasing from front to
+     * back): every sample is pushed and popped at most once, so the cost is O(1) amortised whatever
+     * the window length. All storage is allocated in prepare(). The delay line holds SampleType,
+     * the detector levels are float.
+     */
+    template <typename SampleType>
+    class Lookahead
+    {
+    public:
+        void prepare (int maxDelaySamples, int numChannels)
+        {
+            maxDelay = juce::jmax (0, maxDelaySamples);
+
+            // The deque never holds more than delay + 1 entries
+            const int size = juce::nextPowerOfTwo (maxDelay + 1);
+            mask = (juce::uint32) size - 1;
+
+            channels.resize ((size_t) numChannels);
+
+            for (auto& ch : channels)
+            {
+                ch.delayLine.assign ((size_t) size, SampleType (0));
+                ch.dequeValues.assign ((size_t) size, 0.0f);
+                ch.dequeIndices.assign ((size_t) size, 0);
+            }
+
+            delay = juce::jmin (delay, maxDelay);
+            reset();
+        }
+
+        void reset()
+        {
+            for (auto& ch : channels)
+            {
+                std::fill (ch.delayLine.begin(), ch.delayLine.end(), SampleType (0));
+                ch.head = ch.tail = ch.counter = 0;
+            }
+        }
+
+        // Clamped to the maximum given to prepare(); clears the delay line
+        void setDelay (int newDelaySamples)
+        {
+            const int clamped = juce::jlimit (0, maxDelay, newDelaySamples);
+
+            if (clamped != delay)
+            {
+                delay = clamped;
+                reset();
+            }
+        }
+
+        int getDelay() const noexcept { return delay; }
+        int getNumChannels() const noexcept { return (int) channels.size(); }
+
+        /**
+         * @brief Delays data in-place by getDelay() samples and replaces levels (the detector levels
+         *        of the undelayed data) by their window maximum. channel must be below getNumChannels().
+         */
+        void process (int channel, SampleType* data, float* levels, int numSamples) noexcept
+        {
+            auto& ch = channels[(size_t) channel];
+            SampleType* delayLine = ch.delayLine.data();
+            float* values = ch.dequeValues.data();
+            juce::uint32* indices = ch.dequeIndices.data();
+            const auto window = (juce::uint32) delay;
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const SampleType input = data[i];
+                const float magnitude = levels[i];
+                const juce::uint32 now = ch.counter++;
+
+                // Drop the entry that slid out of the window, then the ones this sample dominates.
+                // Expiring first keeps the deque at delay + 1 entries once this one is pushed.
+                if (ch.tail != ch.head && now - indices[ch.head & mask] > window)
+                    ++ch.head;
+
+                while (ch.tail != ch.head && values[(ch.tail - 1) & mask] <= magnitude)
+                    --ch.tail;
+
+                values[ch.tail & mask] = magnitude;
+                indices[ch.tail & mask] = now;
+                ++ch.tail;
+
+                levels[i] = values[ch.head & mask];
+
+                delayLine[now & mask] = input;
+                data[i] = delayLine[(now - window) & mask];
+            }
+        }
+
+    private:
+        struct ChannelState
+        {
+            std::vector<SampleType> delayLine;
+            std::vector<float> dequeValues;
+            std::vector<juce::uint32> dequeIndices;     // Sample counter at push time
+            juce::uint32 head = 0, tail = 0;            // Free-running, masked on access
+            juce::uint32 counter = 0;
+        };
+
+        std::vector<ChannelState> channels;
+        int maxDelay = 0;
+        int delay = 0;
+        juce::uint32 mask = 0;
+    };
+}
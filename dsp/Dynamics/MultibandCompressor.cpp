@@ -0,0 +1,246 @@
+#include "MultibandCompressor.h"
+
+namespace punk_dsp
+{
+    // Second-order sections of the LR4 crossover (RBJ cookbook, Butterworth Q)
+    struct CrossoverBiquad
+    {
+        float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+
+        enum Type { Identity, LowPass, HighPass, AllPass };
+
+        static CrossoverBiquad make(Type type, double frequency, double sampleRate)
+        {
+            CrossoverBiquad biquad;
+
+            if (type == Identity)
+                return biquad;
+
+            const double w0 = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+            const double cosW0 = std::cos(w0);
+            const double q = 1.0 / juce::MathConstants<double>::sqrt2;
+            const double alpha = std::sin(w0) / (2.0 * q);
+            const double a0 = 1.0 + alpha;
+
+            double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+
+            switch (type)
+            {
+                case LowPass:   b0 = (1.0 - cosW0) * 0.5; b1 = 1.0 - cosW0;     b2 = b0;           break;
+                case HighPass:  b0 = (1.0 + cosW0) * 0.5; b1 = -(1.0 + cosW0);  b2 = b0;           break;
+                case AllPass:   b0 = 1.0 - alpha;         b1 = -2.0 * cosW0;    b2 = 1.0 + alpha;  break;
+                case Identity:
+                default:        break;
+            }
+
+            biquad.b0 = (float) (b0 / a0);
+            biquad.b1 = (float) (b1 / a0);
+            biquad.b2 = (float) (b2 / a0);
+            biquad.a1 = (float) (-2.0 * cosW0 / a0);
+            biquad.a2 = (float) ((1.0 - alpha) / a0);
+            return biquad;
+        }
+    };
+
+    MultibandCompressor::MultibandCompressor()
+    {
+        updateCoefficients();
+    }
+
+    void MultibandCompressor::prepare(const juce::dsp::ProcessSpec& spec)
+    {
+        sampleRate = spec.sampleRate;
+        maxBlockSize = (int) spec.maximumBlockSize;
+
+        for (int band = 0; band < maxBands; ++band)
+        {
+            bands[(size_t) band].prepare(spec);
+            bands[(size_t) band].updateLookahead(lookaheadMs);
+            bandBuffers[(size_t) band].setSize((int) spec.numChannels, maxBlockSize, false, true);
+        }
+
+        channels.resize(spec.numChannels);
+        updateCoefficients();
+        reset();
+    }
+
+    void MultibandCompressor::reset()
+    {
+        for (auto& ch : channels)
+            for (int stage = 0; stage < maxStages; ++stage)
+                for (int r = 0; r < maxRegisters; ++r)
+                    ch.s1[stage][r] = ch.s2[stage][r] = SIMDFloat::expand(0.0f);
+
+        for (auto& band : bands)
+            band.reset();
+    }
+
+    void MultibandCompressor::setNumBands(int newNumBands)
+    {
+        numBands = juce::jlimit(minBands, maxBands, newNumBands);
+        updateCoefficients();
+
+        // The stage layout depends on the band count, so old filter state is meaningless
+        for (auto& ch : channels)
+            for (int stage = 0; stage < maxStages; ++stage)
+                for (int r = 0; r < maxRegisters; ++r)
+                    ch.s1[stage][r] = ch.s2[stage][r] = SIMDFloat::expand(0.0f);
+    }
+
+    void MultibandCompressor::setCrossover(int index, float newFrequencyHz)
+    {
+        if (! juce::isPositiveAndBelow(index, maxBands - 1))
+            return;
+
+        crossovers[(size_t) index] = newFrequencyHz;
+        updateCoefficients();
+    }
+
+    void MultibandCompressor::setLookahead(float newLookaheadMs)
+    {
+        lookaheadMs = juce::jlimit(0.0f, Compressor<float>::maxLookaheadMs, newLookaheadMs);
+
+        for (auto& band : bands)
+            band.updateLookahead(lookaheadMs);
+    }
+
+    int MultibandCompressor::getLatencySamples() const noexcept
+    {
+        return bands[0].getLatencySamples();
+    }
+
+    void MultibandCompressor::updateCoefficients()
+    {
+        numStages = 2 * (numBands - 1);
+        numRegisters = (numBands + simdLanes - 1) / simdLanes;
+
+        // Keep the crossovers ascending and below Nyquist
+        const double nyquistLimit = sampleRate * 0.49;
+        float previous = 10.0f;
+        std::array<double, maxBands - 1> frequencies {};
+
+        for (int i = 0; i < numBands - 1; ++i)
+        {
+            previous = juce::jlimit(previous, (float) nyquistLimit, crossovers[(size_t) i]);
+            frequencies[(size_t) i] = previous;
+        }
+
+        alignas (SIMDFloat) float b0[maxRegisters * simdLanes], b1[maxRegisters * simdLanes], b2[maxRegisters * simdLanes];
+        alignas (SIMDFloat) float a1[maxRegisters * simdLanes], a2[maxRegisters * simdLanes];
+
+        for (int section = 0; section < numBands - 1; ++section)
+        {
+            for (int half = 0; half < 2; ++half)
+            {
+                const int stage = 2 * section + half;
+
+                for (int lane = 0; lane < maxRegisters * simdLanes; ++lane)
+                {
+                    // Band k: HPs of the crossovers below it, the LP of its own, allpasses above.
+                    // An LR4 section is two identical Butterworth biquads; an allpass needs only one
+                    auto type = CrossoverBiquad::Identity;
+
+                    if (lane < numBands)
+                    {
+                        if (section < lane)
+                            type = CrossoverBiquad::HighPass;
+                        else if (section == lane)
+                            type = CrossoverBiquad::LowPass;
+                        else if (half == 0)
+                            type = CrossoverBiquad::AllPass;
+                    }
+
+                    const auto biquad = CrossoverBiquad::make(type, frequencies[(size_t) section], sampleRate);
+                    b0[lane] = biquad.b0; b1[lane] = biquad.b1; b2[lane] = biquad.b2;
+                    a1[lane] = biquad.a1; a2[lane] = biquad.a2;
+                }
+
+                for (int r = 0; r < maxRegisters; ++r)
+                {
+                    auto& c = coeffs[stage][r];
+                    c.b0 = SIMDFloat::fromRawArray(b0 + r * simdLanes);
+                    c.b1 = SIMDFloat::fromRawArray(b1 + r * simdLanes);
+                    c.b2 = SIMDFloat::fromRawArray(b2 + r * simdLanes);
+                    c.a1 = SIMDFloat::fromRawArray(a1 + r * simdLanes);
+                    c.a2 = SIMDFloat::fromRawArray(a2 + r * simdLanes);
+                }
+            }
+        }
+    }
+
+    void MultibandCompressor::splitBands(int channel, const float* input, int startSample, int numSamples)
+    {
+        auto& state = channels[(size_t) channel];
+        alignas (SIMDFloat) float lanes[maxRegisters * simdLanes];
+
+        float* bandData[maxBands] = {};
+        for (int band = 0; band < numBands; ++band)
+            bandData[band] = bandBuffers[(size_t) band].getWritePointer(channel);
+
+        for (int sample = 0; sample < numSamples; ++sample)
+        {
+            // Every band lane starts from the same input sample
+            const SIMDFloat x = SIMDFloat::expand(input[startSample + sample]);
+
+            for (int r = 0; r < numRegisters; ++r)
+            {
+                SIMDFloat y = x;
+
+                for (int stage = 0; stage < numStages; ++stage)
+                {
+                    const auto& c = coeffs[stage][r];
+                    const SIMDFloat in = y;
+
+                    y = c.b0 * in + state.s1[stage][r];
+                    state.s1[stage][r] = c.b1 * in - c.a1 * y + state.s2[stage][r];
+                    state.s2[stage][r] = c.b2 * in - c.a2 * y;
+                }
+
+                y.copyToRawArray(lanes + r * simdLanes);
+            }
+
+            for (int band = 0; band < numBands; ++band)
+                bandData[band][sample] = lanes[band];
+        }
+    }
+
+    void MultibandCompressor::process(juce::AudioBuffer<float>& inputBuffer)
+    {
+        const int numSamples = inputBuffer.getNumSamples();
+        const int numChannels = juce::jmin(inputBuffer.getNumChannels(), (int) channels.size());
+
+        if (maxBlockSize == 0)
+            return;
+
+        // A band delayed differently from the others would break the allpass sum
+        for (int band = 1; band < numBands; ++band)
+            if (bands[(size_t) band].getLatencySamples() != bands[0].getLatencySamples())
+                setLookahead(lookaheadMs);
+
+        for (int start = 0; start < numSamples; start += maxBlockSize)
+        {
+            const int num = juce::jmin(maxBlockSize, numSamples - start);
+
+            // 1. Split
+            for (int ch = 0; ch < numChannels; ++ch)
+                splitBands(ch, inputBuffer.getReadPointer(ch), start, num);
+
+            // 2. Compress each band in its own buffer (referenced, no copy)
+            for (int band = 0; band < numBands; ++band)
+            {
+                juce::AudioBuffer<float> bandView(bandBuffers[(size_t) band].getArrayOfWritePointers(), numChannels, num);
+                bands[(size_t) band].process(bandView);
+            }
+
+            // 3. Sum
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                float* output = inputBuffer.getWritePointer(ch, start);
+                juce::FloatVectorOperations::copy(output, bandBuffers[0].getReadPointer(ch), num);
+
+                for (int band = 1; band < numBands; ++band)
+                    juce::FloatVectorOperations::add(output, bandBuffers[(size_t) band].getReadPointer(ch), num);
+            }
+        }
+    }
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "juce_dsp/juce_dsp.h"
+#include "Compressor.h"
+
+/**
+ * @class MultibandCompressor
+ * @brief Splits the signal into 2-5 bands with Linkwitz-Riley (LR4) crossovers, compresses each
+ *        band with its own punk_dsp::Compressor and sums the bands back together.
+ *
+ * The crossover is the usual LR4 tree with allpass compensation: a band below a split sees the
+ * allpass (LP + HP) of every higher crossover, so with all compressors idle the bands sum to an
+ * allpass and the magnitude response stays flat.
+ *
+ * The tree is evaluated in parallel form: every band is a chain of N - 1 LR4 sections (HPs of the
+ * crossovers below it, the LP of its upper crossover, allpasses of the ones above), i.e. 2 (N - 1)
+ * biquads fed by the same input. Band filters are stored SoA, one band per SIMDRegister lane, so
+ * each biquad stage runs for all bands at once. Band buffers are allocated in prepare().
+ *
+ * Lookahead delays a band's audio, so bands with different lookahead would no longer sum to the
+ * allpass. It is therefore set once, with setLookahead(), for every band; process() puts back in
+ * line a band whose lookahead was changed through getBand().
+ *
+ * Usage:
+ *  - setNumBands(...) / setCrossover(...), then prepare(spec)
+ *  - Configure each band through getBand(band) (ratio, threshold, attack, ...), lookahead with setLookahead(...)
+ *  - Call process(audioBuffer) each block
+ */
+namespace punk_dsp
+{
+    class MultibandCompressor
+    {
+    public:
+        static constexpr int minBands = 2;
+        static constexpr int maxBands = 5;
+
+        MultibandCompressor();
+        ~MultibandCompressor() = default;
+
+        void prepare(const juce::dsp::ProcessSpec& spec);
+        void reset();
+
+        void setNumBands(int newNumBands);                      // [minBands, maxBands], resets the crossover state
+        void setCrossover(int index, float newFrequencyHz);     // index in [0, numBands - 2], ascending
+        void setLookahead(float newLookaheadMs);                // Every band, [0, Compressor::maxLookaheadMs]
+
+        int getNumBands() const noexcept { return numBands; }
+        Compressor<float>& getBand(int band) { return bands[(size_t) band]; }
+
+        // The shared lookahead of the bands
+        int getLatencySamples() const noexcept;
+
+        /**
+        * @brief Processes the audio buffer in-place.
+        *
+        * @param inputBuffer The buffer containing the signal to be processed.
+        */
+        void process(juce::AudioBuffer<float>& inputBuffer);
+
+    private:
+        using SIMDFloat = juce::dsp::SIMDRegister<float>;
+        static constexpr int simdLanes = (int) SIMDFloat::SIMDNumElements;
+        static constexpr int maxStages = 2 * (maxBands - 1);
+        static constexpr int maxRegisters = (maxBands + simdLanes - 1) / simdLanes;
+
+        // One biquad stage for every band lane of a register (transposed direct form II)
+        struct StageCoeffs
+        {
+            SIMDFloat b0, b1, b2, a1, a2;
+        };
+
+        struct ChannelState
+        {
+            SIMDFloat s1[maxStages][maxRegisters];
+            SIMDFloat s2[maxStages][maxRegisters];
+        };
+
+        void updateCoefficients();
+        void splitBands(int channel, const float* input, int startSample, int numSamples);
+
+        std::array<Compressor<float>, maxBands> bands;
+        std::array<juce::AudioBuffer<float>, maxBands> bandBuffers;
+
+        StageCoeffs coeffs[maxStages][maxRegisters];
+        std::vector<ChannelState> channels;
+
+        // Parameters
+        int numBands = 3;
+        std::array<float, maxBands - 1> crossovers { 120.0f, 1000.0f, 5000.0f, 10000.0f };
+        float lookaheadMs = 0.0f;
+
+        // Cached values
+        double sampleRate = 44100.0;
+        int maxBlockSize = 0;
+        int numStages = 4;      // 2 * (numBands - 1)
+        int numRegisters = 1;   // Registers needed for numBands lanes
+
+        // --- Prevent copy and move ---
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MultibandCompressor)
+    };
+}
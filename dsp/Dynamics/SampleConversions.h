@@ -0,0 +1,42 @@
+#pragma once
+
+#include "juce_dsp/juce_dsp.h"
+
+namespace punk_dsp
+{
+    /**
+     * The dynamics processors are templated on the audio sample type, but their detectors and gain
+     * computers always run in float: levels and gains live in the dB domain, where float resolves
+     * far below anything audible. These two helpers are the only places the types meet, so the
+     * float instantiation compiles down to exactly what it was before (no copies, no loops added).
+     */
+
+    // Detector input for a key: the key itself in float, otherwise narrowed into scratch
+    template <typename SampleType>
+    inline const float* toDetectorInput (const SampleType* key, float* scratch, int numSamples) noexcept
+    {
+        if constexpr (std::is_same_v<SampleType, float>)
+        {
+            juce::ignoreUnused (scratch, numSamples);
+            return key;
+        }
+        else
+        {
+            for (int i = 0; i < numSamples; ++i)
+                scratch[i] = (float) key[i];
+
+            return scratch;
+        }
+    }
+
+    // data[i] *= gains[i], in the sample type
+    template <typename SampleType>
+    inline void applyGains (SampleType* data, const float* gains, int numSamples) noexcept
+    {
+        if constexpr (std::is_same_v<SampleType, float>)
+            juce::FloatVectorOperations::multiply (data, gains, numSamples);
+        else
+            for (int i = 0; i < numSamples; ++i)
+                data[i] *= (SampleType) gains[i];
+    }
+}
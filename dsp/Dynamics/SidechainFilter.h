@@ -0,0 +1,139 @@
+#pragma once
+
+#include "juce_dsp/juce_dsp.h"
+
+namespace punk_dsp
+{
+    /**
+     * Off:      the detector reads the key unfiltered (no cost).
+     * HighPass: ignore the low end (kick / bass pumping), 12 dB/oct.
+     * LowPass:  ignore the top end, 12 dB/oct.
+     * Bell:     boost or cut a band (de-essing, emphasising a source), setGain() in dB.
+     */
+    enum class SidechainFilterType
+    {
+        Off,
+        HighPass,
+        LowPass,
+        Bell
+    };
+
+    /**
+     * @class SidechainFilter
+     * @brief One RBJ biquad (transposed direct form II) per channel on the detector path only.
+     *
+     * process() filters the key straight into the caller's detector scratch, which the level
+     * detector then reads in place, so the audio is never copied and costs one biquad per sample.
+     * When Off, process() hands back the key untouched. Channels beyond the ones given to
+     * prepare() are passed through unfiltered.
+     */
+    class SidechainFilter
+    {
+    public:
+        void prepare (double newSampleRate, int numChannels)
+        {
+            sampleRate = newSampleRate;
+            states.resize ((size_t) numChannels);
+            updateCoefficients();
+            reset();
+        }
+
+        void reset()
+        {
+            for (auto& state : states)
+                state = {};
+        }
+
+        // Clears the filter state when the response changes shape
+        void setType (SidechainFilterType newType)
+        {
+            if (newType != type)
+            {
+                type = newType;
+                updateCoefficients();
+                reset();
+            }
+        }
+
+        void setFrequency (float newFrequencyHz)    { frequency = newFrequencyHz; updateCoefficients(); }
+        void setQ (float newQ)                      { q = juce::jlimit (0.1f, 18.0f, newQ); updateCoefficients(); }
+        void setGain (float newGainDB)              { gainDB = newGainDB; updateCoefficients(); }
+
+        bool isActive() const noexcept              { return type != SidechainFilterType::Off; }
+
+        // Returns the key to detect from: input itself when Off, otherwise output holding the filtered key
+        const float* process (int channel, const float* input, float* output, int numSamples) noexcept
+        {
+            if (! isActive() || channel >= (int) states.size())
+                return input;
+
+            auto& state = states[(size_t) channel];
+            float s1 = state.s1, s2 = state.s2;
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const float x = input[i];
+                const float y = b0 * x + s1;
+                s1 = b1 * x - a1 * y + s2;
+                s2 = b2 * x - a2 * y;
+                output[i] = y;
+            }
+
+            state.s1 = s1;
+            state.s2 = s2;
+            return output;
+        }
+
+    private:
+        void updateCoefficients()
+        {
+            const double w0 = juce::MathConstants<double>::twoPi
+                            * juce::jlimit (10.0, sampleRate * 0.49, (double) frequency) / sampleRate;
+            const double cosW0 = std::cos (w0);
+            const double alpha = std::sin (w0) / (2.0 * (double) q);
+            const double A = std::pow (10.0, (double) gainDB / 40.0);
+
+            double c0 = 1.0, c1 = 0.0, c2 = 0.0;
+            double d0 = 1.0, d1 = 0.0, d2 = 0.0;
+
+            switch (type)
+            {
+                case SidechainFilterType::HighPass:
+                    c0 = (1.0 + cosW0) * 0.5; c1 = -(1.0 + cosW0); c2 = c0;
+                    d0 = 1.0 + alpha; d1 = -2.0 * cosW0; d2 = 1.0 - alpha;
+                    break;
+                case SidechainFilterType::LowPass:
+                    c0 = (1.0 - cosW0) * 0.5; c1 = 1.0 - cosW0; c2 = c0;
+                    d0 = 1.0 + alpha; d1 = -2.0 * cosW0; d2 = 1.0 - alpha;
+                    break;
+                case SidechainFilterType::Bell:
+                    c0 = 1.0 + alpha * A; c1 = -2.0 * cosW0; c2 = 1.0 - alpha * A;
+                    d0 = 1.0 + alpha / A; d1 = -2.0 * cosW0; d2 = 1.0 - alpha / A;
+                    break;
+                case SidechainFilterType::Off:
+                default:
+                    break;
+            }
+
+            b0 = (float) (c0 / d0);
+            b1 = (float) (c1 / d0);
+            b2 = (float) (c2 / d0);
+            a1 = (float) (d1 / d0);
+            a2 = (float) (d2 / d0);
+        }
+
+        struct ChannelState
+        {
+            float s1 = 0.0f, s2 = 0.0f;
+        };
+
+        std::vector<ChannelState> states;
+        SidechainFilterType type = SidechainFilterType::Off;
+        float frequency = 100.0f;
+        float q = 0.707f;
+        float gainDB = 0.0f;
+        double sampleRate = 44100.0;
+
+        float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+    };
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "juce_dsp/juce_dsp.h"
+
+namespace punk_dsp
+{
+    /**
+     * @class SidechainInput
+     * @brief Maps an external key signal onto the channels being processed, without copying it.
+     *
+     * Same channel count: channel n is keyed by sidechain channel n.
+     * Mono sidechain:     broadcast to every channel.
+     * Anything else:      every channel is keyed by the mean of all sidechain channels, mixed into
+     *                     the caller's scratch a block at a time. Channels asking for the same range
+     *                     share one mix, so the scratch must not be written between their calls.
+     */
+    template <typename SampleType>
+    class SidechainInput
+    {
+    public:
+        SidechainInput (const juce::dsp::AudioBlock<const SampleType>& sidechainBlock, int numProcessedChannels) noexcept
+            : block (sidechainBlock),
+              numSidechainChannels ((int) sidechainBlock.getNumChannels()),
+              needsDownmix (numSidechainChannels != numProcessedChannels && numSidechainChannels > 1)
+        {
+        }
+
+        int getNumSamples() const noexcept { return (int) block.getNumSamples(); }
+        bool hasChannels() const noexcept { return numSidechainChannels > 0; }
+
+        // Key signal for channel over [start, start + numSamples); scratch is only written when downmixing
+        const SampleType* getChannel (int channel, int start, int numSamples, SampleType* scratch) const noexcept
+        {
+            if (! needsDownmix)
+                return block.getChannelPointer ((size_t) (numSidechainChannels == 1 ? 0 : channel)) + start;
+
+            // Every channel gets the same mix: only mix again when the range (or the scratch) moves
+            if (scratch == mixedScratch && start == mixedStart && numSamples == mixedNumSamples)
+                return scratch;
+
+            mixedScratch = scratch;
+            mixedStart = start;
+            mixedNumSamples = numSamples;
+
+            juce::FloatVectorOperations::copy (scratch, block.getChannelPointer (0) + start, numSamples);
+
+            for (int ch = 1; ch < numSidechainChannels; ++ch)
+                juce::FloatVectorOperations::add (scratch, block.getChannelPointer ((size_t) ch) + start, numSamples);
+
+            juce::FloatVectorOperations::multiply (scratch, (SampleType) 1 / (SampleType) numSidechainChannels, numSamples);
+            return scratch;
+        }
+
+    private:
+        juce::dsp::AudioBlock<const SampleType> block;
+        int numSidechainChannels = 0;
+        bool needsDownmix = false;
+
+        // The range currently mixed into the caller's scratch
+        mutable const SampleType* mixedScratch = nullptr;
+        mutable int mixedStart = 0, mixedNumSamples = 0;
+    };
+}
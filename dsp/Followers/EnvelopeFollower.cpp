@@ -2,11 +2,13 @@
 
 namespace punk_dsp
 {
-    EnvelopeFollower::EnvelopeFollower()
+    template <typename SampleType>
+    EnvelopeFollower<SampleType>::EnvelopeFollower()
     {
     }
 
-    void EnvelopeFollower::prepare(const juce::dsp::ProcessSpec& spec)
+    template <typename SampleType>
+    void EnvelopeFollower<SampleType>::prepare(const juce::dsp::ProcessSpec& spec)
     {
         sampleRate = spec.sampleRate;
         
@@ -15,40 +17,49 @@ namespace punk_dsp
         releaseCoeff = calculateTimeCoeff (releaseTime);
     }
 
-    void EnvelopeFollower::reset()
+    template <typename SampleType>
+    void EnvelopeFollower<SampleType>::reset()
     {
         envelope = 0.0f;
     }
 
-    float EnvelopeFollower::calculateTimeCoeff(float time_ms)
+    template <typename SampleType>
+    SampleType EnvelopeFollower<SampleType>::calculateTimeCoeff(float time_ms)
     {
-        return std::exp(-2.0f * juce::MathConstants<float>::pi * 1000.f / time_ms / sampleRate);
+        return std::exp((SampleType) -2 * juce::MathConstants<SampleType>::pi * (SampleType) 1000 / (SampleType) time_ms / (SampleType) sampleRate);
     }
 
-    void EnvelopeFollower::setAttack(float newAttMs)
+    template <typename SampleType>
+    void EnvelopeFollower<SampleType>::setAttack(float newAttMs)
     {
         attackTime = std::max(0.1f, newAttMs);
         attackCoeff = calculateTimeCoeff(attackTime);
     }
 
-    void EnvelopeFollower::setRelease(float newRelMs)
+    template <typename SampleType>
+    void EnvelopeFollower<SampleType>::setRelease(float newRelMs)
     {
         releaseTime = std::max(0.1f, newRelMs);
         releaseCoeff = calculateTimeCoeff(releaseTime);
     }
 
-    float EnvelopeFollower::process(float input_lin)
+    template <typename SampleType>
+    SampleType EnvelopeFollower<SampleType>::process(SampleType input_lin)
     {
-        float target = std::abs(input_lin);
+        SampleType target = std::abs(input_lin);
         
-        float alpha = (target > envelope) ? attackCoeff : releaseCoeff;
+        SampleType alpha = (target > envelope) ? attackCoeff : releaseCoeff;
         envelope = alpha * (envelope - target) + target;
         
         return envelope;
     }
     
-    float EnvelopeFollower::getEnvelope()
+    template <typename SampleType>
+    SampleType EnvelopeFollower<SampleType>::getEnvelope()
     {
         return envelope;
     }
+
+    template class EnvelopeFollower<float>;
+    template class EnvelopeFollower<double>;
 }
@@ -0,0 +1,104 @@
+#include "FormantShifter.h"
+
+namespace punk_dsp
+{
+    FormantShifter::FormantShifter()
+    {
+        setFormantSemitones(0.0f);
+    }
+
+    void FormantShifter::prepareSpectrum()
+    {
+        // Below the shortest pitch period of interest, so harmonics don't leak into the envelope
+        lifterLength = juce::jlimit(2, numBins - 1, juce::roundToInt(sampleRate * cutoffMs * 0.001));
+
+        cepstrum.resize(2 * fftSize);
+        logEnvelope.resize(numBins);
+        flattened.resize(numBins);
+
+        formantSmoothed.reset(sampleRate, 0.05);
+        formantSmoothed.setCurrentAndTargetValue(formantSmoothed.getTargetValue());
+        currentFormantRatio = formantSmoothed.getTargetValue();
+    }
+
+    // --- --- PARAMETER UPDATES --- ---
+    void FormantShifter::setFormantSemitones(float semitones)
+    {
+        setFormantRatio(std::pow(2.0f, semitones / 12.0f));
+    }
+
+    void FormantShifter::setFormantRatio(float ratio)
+    {
+        formantSmoothed.setTargetValue(juce::jlimit(0.5f, 2.0f, ratio)); // {-12st, +12st}
+    }
+
+    void FormantShifter::setEnvelopeCutoffMs(float newCutoffMs)
+    {
+        cutoffMs = juce::jlimit(0.5f, 5.0f, newCutoffMs);
+    }
+
+    void FormantShifter::advanceParameters(int numSamples)
+    {
+        PhaseVocoderShifter::advanceParameters(numSamples);
+        currentFormantRatio = formantSmoothed.skip(numSamples);
+    }
+
+    // --- --- PROCESSING --- ---
+    void FormantShifter::estimateEnvelope(const std::complex<float>* spectrum, float* envelope)
+    {
+        float* cep = cepstrum.data();
+
+        // Log magnitude as a real, even spectrum
+        for (int k = 0; k < numBins; ++k)
+        {
+            const float power = spectrum[k].real() * spectrum[k].real() + spectrum[k].imag() * spectrum[k].imag();
+            cep[2 * k] = 0.5f * std::log(power + 1.0e-20f);
+            cep[2 * k + 1] = 0.0f;
+        }
+
+        // Real cepstrum; lifter away the high quefrencies (harmonic fine structure)
+        fft->performRealOnlyInverseTransform(cep);
+        juce::FloatVectorOperations::clear(cep + lifterLength, fftSize - 2 * lifterLength + 1);
+        juce::FloatVectorOperations::clear(cep + fftSize, fftSize);
+
+        // Back to a smoothed log magnitude (the cepstrum is even, so the result is real)
+        fft->performRealOnlyForwardTransform(cep, true);
+
+        for (int k = 0; k < numBins; ++k)
+            envelope[k] = cep[2 * k];
+    }
+
+    void FormantShifter::processSpectrum(ChannelState& ch, const std::complex<float>* analysis, std::complex<float>* synthesis)
+    {
+        const float formantRatio = currentFormantRatio;
+
+        // Nothing to do: let the base class pass the spectrum through
+        if (std::abs(currentRatio - 1.0f) < 1.0e-4f && std::abs(formantRatio - 1.0f) < 1.0e-4f)
+        {
+            PhaseVocoderShifter::processSpectrum(ch, analysis, synthesis);
+            return;
+        }
+
+        estimateEnvelope(analysis, logEnvelope.data());
+
+        // 1. Flatten; a positive real gain keeps the phases ch.lastAnalysis is compared against
+        for (int k = 0; k < numBins; ++k)
+            flattened[k] = analysis[k] * std::exp(-logEnvelope[k]);
+
+        // 2. Shift the excitation
+        shiftSpectrum(ch, flattened.data(), synthesis);
+
+        // 3. Re-apply the envelope, stretched by the formant ratio
+        const float readStep = 1.0f / formantRatio;
+
+        for (int k = 0; k < numBins; ++k)
+        {
+            const float readPos = juce::jmin((float)k * readStep, (float)(numBins - 1));
+            const int index = juce::jmin((int)readPos, numBins - 2);
+            const float frac = readPos - (float)index;
+            const float logGain = logEnvelope[index] + frac * (logEnvelope[index + 1] - logEnvelope[index]);
+
+            synthesis[k] *= std::exp(logGain);
+        }
+    }
+}
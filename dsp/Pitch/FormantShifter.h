@@ -0,0 +1,60 @@
+#pragma once
+
+#include "juce_dsp/juce_dsp.h"
+#include "PhaseVocoderShifter.h"
+
+/**
+ * @class FormantShifter
+ * @brief Phase vocoder with independent pitch and formant shifting.
+ *
+ * Runs on the PhaseVocoderShifter STFT. Once per frame the spectral envelope is estimated by
+ * cepstral liftering (log magnitude -> real cepstrum -> keep the low quefrencies -> back),
+ * using the same FFT. The spectrum is flattened by that envelope, pitch shifted, and then
+ * re-coloured by the envelope stretched by the formant ratio. With the formant shift at 0 the
+ * original formants are kept whatever the pitch shift.
+ *
+ * Usage:
+ *  - Same as PhaseVocoderShifter, plus setFormantSemitones(...) / setFormantRatio(...)
+ *  - setEnvelopeCutoffMs(...) before prepare to trade envelope detail against pitch leakage
+ *
+ * The envelope costs one inverse and one forward real FFT plus 3 * N/2 log/exp per frame
+ * and channel, independent of the block size.
+ */
+namespace punk_dsp
+{
+    class FormantShifter : public PhaseVocoderShifter
+    {
+    public:
+        FormantShifter();
+        ~FormantShifter() override = default;
+
+        void setFormantSemitones(float semitones);  // [-12, +12], 0 = keep the formants
+        void setFormantRatio(float ratio);          // direct ratio (e.g. 1.2 = formants 20% higher)
+
+        // Call before prepare
+        void setEnvelopeCutoffMs(float newCutoffMs);    // Lifter quefrency, [0.5, 5] ms, default 1.5 ms
+
+    protected:
+        void prepareSpectrum() override;
+        void advanceParameters(int numSamples) override;
+        void processSpectrum(ChannelState& ch, const std::complex<float>* analysis, std::complex<float>* synthesis) override;
+
+    private:
+        // Smoothed log envelope (natural log of magnitude) of `spectrum`, one value per bin
+        void estimateEnvelope(const std::complex<float>* spectrum, float* logEnvelope);
+
+        float cutoffMs = 1.5f;
+        int lifterLength = 72;                      // Kept quefrencies [0, lifterLength)
+
+        // Per-frame scratch
+        std::vector<float> cepstrum;                // 2 * fftSize, real FFT in-place
+        std::vector<float> logEnvelope;             // numBins
+        std::vector<std::complex<float>> flattened; // numBins
+
+        juce::SmoothedValue<float> formantSmoothed;
+        float currentFormantRatio = 1.0f;
+
+        // --- Prevent copy and move ---
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FormantShifter)
+    };
+}
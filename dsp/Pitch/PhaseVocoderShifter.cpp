@@ -0,0 +1,249 @@
+#include "PhaseVocoderShifter.h"
+
+// Bins quieter than this (power, ~ -120 dBFS for a full-scale frame) never become peaks
+static constexpr float pvMinPeakPower = 1.0e-12f;
+
+namespace punk_dsp
+{
+    PhaseVocoderShifter::PhaseVocoderShifter()
+    {
+        setSemitones(0.0f);
+        setMix(1.0f);
+    }
+
+    void PhaseVocoderShifter::prepare(const juce::dsp::ProcessSpec& spec)
+    {
+        sampleRate = spec.sampleRate;
+
+        fftSize = 1 << fftOrder;
+        hopSize = fftSize / overlapFactor;
+        numBins = fftSize / 2 + 1;
+
+        fft = std::make_unique<juce::dsp::FFT>(fftOrder);
+
+        // Periodic Hann, used for both analysis and synthesis
+        window.resize(fftSize);
+        for (int n = 0; n < fftSize; ++n)
+            window[n] = 0.5f - 0.5f * std::cos(juce::MathConstants<float>::twoPi * (float)n / (float)fftSize);
+
+        // Windows overlap-add to a constant; normalise by it
+        float windowSum = 0.0f;
+        for (int n = 0; n < fftSize; n += hopSize)
+            windowSum += window[n] * window[n];
+        outputScale = 1.0f / windowSum;
+
+        analysisFrame.resize(2 * fftSize);
+        synthesisFrame.resize(2 * fftSize);
+        binPower.resize(numBins);
+        peaks.resize(numBins);
+
+        channels.resize(spec.numChannels);
+        for (auto& ch : channels)
+        {
+            ch.inputFifo.resize(fftSize + hopSize);
+            ch.outputAccum.resize(fftSize);
+            ch.outputFifo.resize(hopSize);
+            ch.lastAnalysis.resize(numBins);
+            ch.lastSynthesis.resize(numBins);
+        }
+
+        prepareSpectrum();
+
+        ratioSmoothed.reset(sampleRate, 0.05);
+        mixSmoothed.reset(sampleRate, 0.05);
+
+        reset();
+    }
+
+    void PhaseVocoderShifter::reset()
+    {
+        for (auto& ch : channels)
+        {
+            std::fill(ch.inputFifo.begin(), ch.inputFifo.end(), 0.0f);
+            std::fill(ch.outputAccum.begin(), ch.outputAccum.end(), 0.0f);
+            std::fill(ch.outputFifo.begin(), ch.outputFifo.end(), 0.0f);
+            std::fill(ch.lastAnalysis.begin(), ch.lastAnalysis.end(), std::complex<float>());
+            std::fill(ch.lastSynthesis.begin(), ch.lastSynthesis.end(), std::complex<float>());
+            ch.rover = fftSize;
+        }
+
+        ratioSmoothed.setCurrentAndTargetValue(ratioSmoothed.getTargetValue());
+        mixSmoothed.setCurrentAndTargetValue(mixSmoothed.getTargetValue());
+        currentRatio = ratioSmoothed.getTargetValue();
+    }
+
+    // --- --- PARAMETER UPDATES --- ---
+    void PhaseVocoderShifter::setSemitones(float semitones)
+    {
+        // ratio = 2^(st/12)
+        setPitchRatio(std::pow(2.0f, semitones / 12.0f));
+    }
+
+    void PhaseVocoderShifter::setPitchRatio(float ratio)
+    {
+        ratioSmoothed.setTargetValue(juce::jlimit(0.25f, 4.0f, ratio)); // {-24st, +24st}
+    }
+
+    void PhaseVocoderShifter::setMix(float newMix)
+    {
+        mixSmoothed.setTargetValue(juce::jlimit(0.0f, 1.0f, newMix));
+    }
+
+    void PhaseVocoderShifter::setFftOrder(int newOrder)
+    {
+        fftOrder = juce::jlimit(9, 13, newOrder);
+    }
+
+    void PhaseVocoderShifter::setOverlapFactor(int newFactor)
+    {
+        overlapFactor = newFactor >= 8 ? 8 : 4;
+    }
+
+    // --- --- PROCESSING --- ---
+    void PhaseVocoderShifter::process(juce::AudioBuffer<float>& buffer)
+    {
+        if (fft == nullptr)
+            return;
+
+        const int numSamples = buffer.getNumSamples();
+        const int numChannels = juce::jmin(buffer.getNumChannels(), (int)channels.size());
+
+        // The ratio is applied per frame; the mix ramps linearly across the block
+        advanceParameters(numSamples);
+        const float mixStart = mixSmoothed.getCurrentValue();
+        const float mixStep = (mixSmoothed.skip(numSamples) - mixStart) / (float)juce::jmax(1, numSamples);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto& ch = channels[channel];
+            float* channelData = buffer.getWritePointer(channel);
+            float mix = mixStart;
+
+            for (int sample = 0; sample < numSamples; ++sample)
+            {
+                ch.inputFifo[ch.rover] = channelData[sample];
+
+                // Both paths are fftSize samples behind the input
+                const float dry = ch.inputFifo[ch.rover - fftSize];
+                const float wet = ch.outputFifo[ch.rover - fftSize];
+
+                mix += mixStep;
+                channelData[sample] = dry + mix * (wet - dry);
+
+                if (++ch.rover >= fftSize + hopSize)
+                {
+                    ch.rover = fftSize;
+                    processFrame(ch);
+                }
+            }
+        }
+    }
+
+    void PhaseVocoderShifter::advanceParameters(int numSamples)
+    {
+        currentRatio = ratioSmoothed.skip(numSamples);
+    }
+
+    void PhaseVocoderShifter::processFrame(ChannelState& ch)
+    {
+        // --- Analysis: the newest fftSize input samples ---
+        juce::FloatVectorOperations::multiply(analysisFrame.data(), ch.inputFifo.data() + hopSize, window.data(), fftSize);
+        juce::FloatVectorOperations::clear(analysisFrame.data() + fftSize, fftSize);
+        fft->performRealOnlyForwardTransform(analysisFrame.data(), true);
+
+        // --- Spectral shift ---
+        juce::FloatVectorOperations::clear(synthesisFrame.data(), 2 * fftSize);
+        auto* analysis = reinterpret_cast<const std::complex<float>*>(analysisFrame.data());
+        auto* synthesis = reinterpret_cast<std::complex<float>*>(synthesisFrame.data());
+
+        processSpectrum(ch, analysis, synthesis);
+
+        std::copy(analysis, analysis + numBins, ch.lastAnalysis.begin());
+        std::copy(synthesis, synthesis + numBins, ch.lastSynthesis.begin());
+
+        // --- Synthesis: window and overlap-add ---
+        fft->performRealOnlyInverseTransform(synthesisFrame.data());
+        juce::FloatVectorOperations::multiply(synthesisFrame.data(), window.data(), fftSize);
+        juce::FloatVectorOperations::addWithMultiply(ch.outputAccum.data(), synthesisFrame.data(), outputScale, fftSize);
+
+        // One hop is finished; slide the accumulator and the input
+        juce::FloatVectorOperations::copy(ch.outputFifo.data(), ch.outputAccum.data(), hopSize);
+        std::copy(ch.outputAccum.begin() + hopSize, ch.outputAccum.end(), ch.outputAccum.begin());
+        juce::FloatVectorOperations::clear(ch.outputAccum.data() + fftSize - hopSize, hopSize);
+
+        std::copy(ch.inputFifo.begin() + hopSize, ch.inputFifo.end(), ch.inputFifo.begin());
+    }
+
+    void PhaseVocoderShifter::processSpectrum(ChannelState& ch, const std::complex<float>* analysis, std::complex<float>* synthesis)
+    {
+        shiftSpectrum(ch, analysis, synthesis);
+    }
+
+    void PhaseVocoderShifter::shiftSpectrum(ChannelState& ch, const std::complex<float>* analysis, std::complex<float>* synthesis)
+    {
+        // Expected phase advance of bin 1 over one hop
+        const float binAdvance = juce::MathConstants<float>::twoPi * (float)hopSize / (float)fftSize;
+        const float ratio = currentRatio;
+
+        // Unity ratio: pass the spectrum through, so the output nulls against the dry path
+        if (std::abs(ratio - 1.0f) < 1.0e-4f)
+        {
+            std::copy(analysis, analysis + numBins, synthesis);
+            return;
+        }
+
+        // 1. Power spectrum (no sqrt/atan2 per bin)
+        for (int k = 0; k < numBins; ++k)
+            binPower[k] = analysis[k].real() * analysis[k].real() + analysis[k].imag() * analysis[k].imag();
+
+        // 2. Peaks = local maxima
+        int numPeaks = 0;
+        for (int k = 1; k < numBins - 1; ++k)
+        {
+            if (binPower[k] > pvMinPeakPower && binPower[k] > binPower[k - 1] && binPower[k] >= binPower[k + 1])
+                peaks[numPeaks++] = k;
+        }
+
+        // 3. Move each peak's region of influence (bounded by the quietest bin between peaks)
+        int regionStart = 0;
+
+        for (int i = 0; i < numPeaks; ++i)
+        {
+            const int peak = peaks[i];
+
+            int regionEnd = numBins - 1;
+            if (i + 1 < numPeaks)
+            {
+                regionEnd = peak;
+                for (int k = peak + 1; k < peaks[i + 1]; ++k)
+                    if (binPower[k] < binPower[regionEnd])
+                        regionEnd = k;
+            }
+
+            // True frequency of the peak (in bins) from its phase advance since the last frame
+            float deviation = std::arg(analysis[peak] * std::conj(ch.lastAnalysis[peak])) - binAdvance * (float)peak;
+            deviation -= juce::MathConstants<float>::twoPi * std::round(deviation / juce::MathConstants<float>::twoPi);
+            const float trueBin = (float)peak + deviation / binAdvance;
+
+            const int target = juce::roundToInt(trueBin * ratio);
+            const int shift = target - peak;
+
+            if (target > 0 && target < numBins)
+            {
+                // Continue the phase the shifted partial had in the last output frame,
+                // and rotate the whole region by the same amount as its peak
+                const float synthesisPhase = std::arg(ch.lastSynthesis[target]) + binAdvance * trueBin * ratio;
+                const std::complex<float> rotor = std::polar(1.0f, synthesisPhase)
+                                                * std::conj(analysis[peak]) / std::sqrt(binPower[peak]);
+
+                const int first = juce::jmax(regionStart, -shift);
+                const int last = juce::jmin(regionEnd, numBins - 1 - shift);
+
+                for (int k = first; k <= last; ++k)
+                    synthesis[k + shift] += analysis[k] * rotor;
+            }
+
+            regionStart = regionEnd + 1;
+        }
+    }
+}
@@ -2,271 +2,480 @@
 #include "PitchShifter.h"
 #include <cmath>
 
-PitchShifter::PitchShifter()
+namespace punk_dsp
 {
-    pitchRatioSmoothed.reset(44100, 0.05);   // default; updated in prepare
-    setWindowSizeMs(40.0);
-    setOverlap(0.5);
-    setSmoothingTimeMs(50.0);
-    setSemitones(0.0f);
-    setMix(1.0f);
-}
-
-void PitchShifter::prepare(double sampleRate, int maxBlockSize, int numChannels)
-{
-    sr = sampleRate;
-    maxBlock = maxBlockSize;
-    numCh = juce::jmax(1, numChannels);
+    PitchShifter::PitchShifter()
+    {
+        pitchRatioSmoothed.reset(44100, 0.05);   // default; updated in prepare
+        setWindowSizeMs(40.0);
+        setOverlap(0.5);
+        setSmoothingTimeMs(50.0);
+        setSemitones(0.0f);
+        setMix(1.0f);
+
+        // Fewer octave errors than plain correlation on voice and bass
+        follower.setAlgorithm(PitchFollower::Algorithm::YIN);
+    }
 
-    pitchRatioSmoothed.reset(sr, (float)(pitchRatioSmoothed.getRampDurationSeconds()));
-    pitchRatioSmoothed.setCurrentAndTargetValue(targetRatio);
+    void PitchShifter::prepare(double sampleRate, int maxBlockSize, int numChannels)
+    {
+        sr = sampleRate;
+        maxBlock = maxBlockSize;
+        numCh = juce::jmax(1, numChannels);
 
-    mixSmoothed.reset(sr, (float)(mixSmoothed.getRampDurationSeconds()));
-    mixSmoothed.setCurrentAndTargetValue(targetMix);
+        pitchRatioSmoothed.reset(sr, (float)(pitchRatioSmoothed.getRampDurationSeconds()));
+        pitchRatioSmoothed.setCurrentAndTargetValue(targetRatio);
 
-    updateDerived();
-    allocateBuffers();
-    reset();
-}
+        mixSmoothed.reset(sr, (float)(mixSmoothed.getRampDurationSeconds()));
+        mixSmoothed.setCurrentAndTargetValue(targetMix);
 
-void PitchShifter::reset()
-{
-    for (auto& ch : channels)
-    {
-        ch.delayBuffer.clear();
-        ch.dryDelayBuffer.clear();
+        updateDerived();
+        allocateBuffers();
 
-        ch.writeIndex = 0;
-        ch.dryWriteIndex = 0;
+        if (mode == Mode::Psola)
+        {
+            // Window of two longest periods, analysed straight from the channel-0 delay line, so
+            // the follower keeps no history of its own
+            follower.setMinFrequency(psolaMinFrequency);
+            follower.setMaxFrequency(psolaMaxFrequency);
+            follower.prepareForRing(sr);
+        }
 
-        ch.g1.pos = ch.g2.pos = 0.0;
-        ch.g1.startIndex = ch.g2.startIndex = 0;
+        reset();
     }
-}
 
-void PitchShifter::setSemitones(float semitones)
-{
-    // ratio = 2^(st/12)
-    setPitchRatio(std::pow(2.0, semitones / 12.0));
-}
+    void PitchShifter::reset()
+    {
+        for (auto& ch : channels)
+        {
+            ch.delayBuffer.clear();
+            ch.dryDelayBuffer.clear();
 
-void PitchShifter::setPitchRatio(double ratio)
-{
-    targetRatio = juce::jlimit(0.25, 4.0, ratio); // constrain to sane range = {-24st, +24st}
-    pitchRatioSmoothed.setTargetValue(targetRatio);
-}
+            ch.writeIndex = 0;
+            ch.dryWriteIndex = 0;
 
-void PitchShifter::setWindowSizeMs(double ms)
-{
-    windowSizeMs = juce::jlimit(10.0, 80.0, ms); // typical safe range
-}
+            ch.g1 = ch.g2 = Grain{};
+            ch.grainsStarted = false;
 
-void PitchShifter::setOverlap(double fractional)
-{
-    overlap = juce::jlimit(0.33, 0.75, fractional); // 33–75%
-}
+            ch.olaBuffer.clear();
+        }
 
-void PitchShifter::setRetriggerDelayMs(double ms)
-{
-    retriggerDelayMs = ms; // -1 => auto (window size)
-}
+        // Psola: start on an unvoiced grid at position 0
+        currentPeriod = unvoicedPeriod;
+        std::fill(marks.begin(), marks.end(), PitchMark{});
+        if (!marks.empty())
+            marks[0].period = unvoicedPeriod;
+
+        numMarks = 1;
+        synthesisMark = 0;
+        lastMarkPosition = 0;
+        nextSynthesisPosition = 0.0;
+        inputPosition = 0;
+        samplesSinceAnalysis = 0;
+
+        if (mode == Mode::Psola)
+            follower.reset();
+    }
 
-void PitchShifter::setSmoothingTimeMs(double ms)
-{
-    const double seconds = juce::jlimit(5.0, 2000.0, ms) / 1000.0;
-    pitchRatioSmoothed.reset(sr, (float)seconds);
-    mixSmoothed.reset(sr, (float)seconds);
-}
+    void PitchShifter::setSemitones(float semitones)
+    {
+        // ratio = 2^(st/12)
+        setPitchRatio(std::pow(2.0, semitones / 12.0));
+    }
 
-void PitchShifter::setMix(float mix)
-{
-    targetMix = juce::jlimit(0.0f, 1.0f, mix);
-    mixSmoothed.setTargetValue(targetMix);
-}
+    void PitchShifter::setPitchRatio(double ratio)
+    {
+        targetRatio = juce::jlimit(0.25, 4.0, ratio); // constrain to sane range = {-24st, +24st}
+        pitchRatioSmoothed.setTargetValue(targetRatio);
+    }
 
-void PitchShifter::updateDerived()
-{
-    windowSize = (int)std::round(sr * (windowSizeMs / 1000.0));
-    windowSize = juce::jlimit(64, 8192, windowSize);
+    void PitchShifter::setWindowSizeMs(double ms)
+    {
+        windowSizeMs = juce::jlimit(10.0, 80.0, ms); // typical safe range
+    }
 
-    hopSize = (int)std::round(windowSize * (1.0 - overlap));
-    hopSize = juce::jmax(1, hopSize);
+    void PitchShifter::setOverlap(double fractional)
+    {
+        overlap = juce::jlimit(0.33, 0.75, fractional); // 33–75%
+    }
 
-    retriggerDelay = (retriggerDelayMs > 0.0)
-        ? (int)std::round(sr * (retriggerDelayMs / 1000.0))
-        : windowSize;
+    void PitchShifter::setRetriggerDelayMs(double ms)
+    {
+        retriggerDelayMs = ms; // -1 => auto (window size)
+    }
 
-    // Allocate at least a few windows worth to be safe
-    delayBufferSize = juce::jmax(4 * windowSize, maxBlock * 4);
+    void PitchShifter::setSmoothingTimeMs(double ms)
+    {
+        const double seconds = juce::jlimit(5.0, 2000.0, ms) / 1000.0;
+        pitchRatioSmoothed.reset(sr, (float)seconds);
+        mixSmoothed.reset(sr, (float)seconds);
+    }
 
-    // Latency ~ one window (worst case). Report safely.
-    latencySamples = windowSize;
+    void PitchShifter::setMix(float mix)
+    {
+        targetMix = juce::jlimit(0.0f, 1.0f, mix);
+        mixSmoothed.setTargetValue(targetMix);
+    }
 
-    // Precompute Hann table for [0..windowSize]
-    hannTableSize = windowSize + 1;
-    hannTable.allocate(hannTableSize, true);
-    for (int n = 0; n < hannTableSize; ++n)
+    void PitchShifter::setMode(Mode newMode)
     {
-        const double x = (double)n / (double)windowSize; // 0..1
-        // Hann: 0.5 - 0.5 cos(2πx)
-        hannTable[n] = (float)(0.5 - 0.5 * std::cos(juce::MathConstants<double>::twoPi * x));
+        mode = newMode;
     }
-}
 
-void PitchShifter::allocateBuffers()
-{
-    channels.resize(numCh);
+    void PitchShifter::setPsolaFrequencyRange(float minHz, float maxHz)
+    {
+        psolaMinFrequency = juce::jlimit(30.0f, 500.0f, minHz);
+        psolaMaxFrequency = juce::jlimit(2.0f * psolaMinFrequency, 4000.0f, maxHz);
+    }
+
+    void PitchShifter::updateDerived()
+    {
+        windowSize = (int)std::round(sr * (windowSizeMs / 1000.0));
+        windowSize = juce::jlimit(64, 8192, windowSize);
+
+        hopSize = (int)std::round(windowSize * (1.0 - overlap));
+        hopSize = juce::jmax(1, hopSize);
+
+        retriggerDelay = (retriggerDelayMs > 0.0)
+            ? (int)std::round(sr * (retriggerDelayMs / 1000.0))
+            : windowSize;
+
+        // Psola periods (same rounding as PitchFollower's lag range)
+        maxPeriod = juce::jmax(2, (int)(sr / psolaMinFrequency));
+        minPeriod = juce::jlimit(1, maxPeriod, (int)(sr / psolaMaxFrequency));
+        unvoicedPeriod = juce::jmin(maxPeriod, (int)std::round(sr * 0.01));
+        analysisHop = juce::jmax(1, maxPeriod / 2);
+
+        // Allocate at least a few windows worth to be safe; power of two so indices wrap with a mask.
+        // Psola reads grains up to ~3 periods behind the newest chunk and also keeps its dry path there.
+        const int psolaSpan = (mode == Mode::Psola) ? 4 * maxPeriod + 2 * maxBlock : 0;
+        delayBufferSize = juce::nextPowerOfTwo(juce::jmax(4 * windowSize, maxBlock * 4, psolaSpan));
+        delayMask = delayBufferSize - 1;
+
+        // Latency ~ one window (worst case). Report safely.
+        // Psola: a grain centred one period ahead of the output needs input one period past its centre.
+        latencySamples = (mode == Mode::Psola) ? 2 * maxPeriod : windowSize;
+
+        dryBufferSize = juce::nextPowerOfTwo(juce::jmax(latencySamples + maxBlock, 2 * maxBlock));
+        dryMask = dryBufferSize - 1;
+
+        // Precompute Hann table for [0..windowSize]
+        hannTableSize = windowSize + 1;
+        hannTable.allocate(hannTableSize, true);
+        for (int n = 0; n < hannTableSize; ++n)
+        {
+            const double x = (double)n / (double)windowSize; // 0..1
+            // Hann: 0.5 - 0.5 cos(2πx)
+            hannTable[n] = (float)(0.5 - 0.5 * std::cos(juce::MathConstants<double>::twoPi * x));
+        }
+    }
 
-    for (auto& ch : channels)
+    void PitchShifter::allocateBuffers()
     {
-        ch.delayBuffer.setSize(1, delayBufferSize, false, true, true);
-        ch.delayBuffer.clear();
-        ch.writeIndex = 0;
+        channels.resize(numCh);
+
+        ratioRamp.allocate(maxBlock, true);
+        mixRamp.allocate(maxBlock, true);
 
-        const int drySize = juce::jmax(latencySamples + maxBlock, 2 * maxBlock);
-        ch.dryDelayBuffer.setSize(1, drySize, false, true, true);
-        ch.dryDelayBuffer.clear();
-        ch.dryWriteIndex = 0;
+        rampSteps.allocate(maxBlock, false);
+        for (int i = 0; i < maxBlock; ++i)
+            rampSteps[i] = (float)(i + 1);
 
-        ch.g1.pos = ch.g2.pos = 0.0;
-        ch.g1.startIndex = ch.g2.startIndex = 0;
+        for (auto& ch : channels)
+        {
+            ch.delayBuffer.setSize(1, delayBufferSize, false, true, true);
+            ch.delayBuffer.clear();
+            ch.writeIndex = 0;
+
+            ch.dryDelayBuffer.setSize(1, dryBufferSize, false, true, true);
+            ch.dryDelayBuffer.clear();
+            ch.dryWriteIndex = 0;
+
+            ch.g1 = ch.g2 = Grain{};
+            ch.grainsStarted = false;
+
+            ch.olaBuffer.setSize(1, mode == Mode::Psola ? delayBufferSize : 0, false, true, true);
+        }
+
+        if (mode == Mode::Psola)
+        {
+            // Marks between the synthesis side (one period behind the newest input) and the newest
+            // input, spaced at least 3/4 of the shortest period
+            marks.resize((size_t)juce::nextPowerOfTwo(2 * (maxPeriod + maxBlock) / juce::jmax(1, minPeriod) + 8));
+            markMask = (int)marks.size() - 1;
+
+            // Grain spacing >= minPeriod / 4 (ratio <= 4)
+            psolaGrains.resize((size_t)(4 * maxBlock / juce::jmax(1, minPeriod) + 4));
+
+            psolaWindow.allocate(psolaWindowSize + 1, true);
+            for (int n = 0; n <= psolaWindowSize; ++n)
+                psolaWindow[n] = (float)(0.5 - 0.5 * std::cos(juce::MathConstants<double>::twoPi * (double)n / (double)psolaWindowSize));
+        }
     }
-}
 
-inline float PitchShifter::hannAt(double x01) const noexcept
-{
-    if (x01 <= 0.0) return 0.0f;
-    if (x01 >= 1.0) return 0.0f;
+    inline float PitchShifter::readInterpolated(const float* delayData, juce::uint64 phase) const noexcept
+    {
+        // Integer part wraps with the mask; the fraction is the low 32 bits
+        const int i0 = (int)(phase >> fixedShift) & delayMask;
+        const int i1 = (i0 + 1) & delayMask;
+        const float frac = (float)(juce::uint32)phase * (float)(1.0 / fixedOne);
+
+        const float s0 = delayData[i0];
+        const float s1 = delayData[i1];
+        return s0 + frac * (s1 - s0);
+    }
 
-    const double idx = x01 * (double)windowSize;
-    const int i = (int)idx;
-    const double frac = idx - i;
+    void PitchShifter::retriggerGrain(ChannelState& ch, Grain& g, int delaySamples)
+    {
+        // Start the new grain 'delaySamples' behind the current writeIndex
+        const int start = (ch.writeIndex - delaySamples) & delayMask;
 
-    const float a = hannTable[juce::jlimit(0, hannTableSize - 1, i)];
-    const float b = hannTable[juce::jlimit(0, hannTableSize - 1, i + 1)];
-    return a + (float)frac * (b - a);
-}
+        g.phase = (juce::uint64)start << fixedShift;
+        g.pos = 0;
+    }
 
-inline float PitchShifter::readInterpolated(const ChannelState& ch, int /*channel*/, double readIndex) const noexcept
-{
-    // readIndex is in circular buffer space [0..delayBufferSize)
-    const int i0 = (int)std::floor(readIndex);
-    const int i1 = (i0 + 1) % delayBufferSize;
-    const float frac = (float)(readIndex - i0);
-
-    const float* d = ch.delayBuffer.getReadPointer(0);
-    const float s0 = d[i0];
-    const float s1 = d[i1];
-    return s0 + frac * (s1 - s0);
-}
+    void PitchShifter::fillRamp(LinearSmoother& smoother, float* dest, int numSamples) const noexcept
+    {
+        const double start = smoother.getCurrentValue();
 
-void PitchShifter::retriggerGrain(ChannelState& ch, Grain& g, int delaySamples)
-{
-    // Start the new grain 'delaySamples' behind the current writeIndex
-    int start = ch.writeIndex - delaySamples;
-    while (start < 0) start += delayBufferSize;
-    start %= delayBufferSize;
+        if (!smoother.isSmoothing())
+        {
+            juce::FloatVectorOperations::fill(dest, (float)start, numSamples);
+            return;
+        }
 
-    g.startIndex = start;
-    g.pos = 0.0;
-}
+        // One step tells us the slope; the ramp ends where it reaches the target
+        const double target = smoother.getTargetValue();
+        const double step = smoother.getNextValue() - start;
+        const int rampLength = juce::jlimit(1, numSamples, (int)std::round((target - start) / step));
 
-void PitchShifter::process(juce::AudioBuffer<float>& buffer)
-{
-    const int numSamples = buffer.getNumSamples();
-    if (numCh <= 0 || windowSize <= 0 || delayBufferSize <= 0)
-        return;
+        // start + step * (i + 1): the values getNextValue() would return sample by sample, to float rounding
+        juce::FloatVectorOperations::fill(dest, (float)start, rampLength);
+        juce::FloatVectorOperations::addWithMultiply(dest, rampSteps.get(), (float)step, rampLength);
 
-    // Bypass when ratio ~ 1.0 to avoid coloration
-    const double currentRatio = pitchRatioSmoothed.getNextValue();
-    const float mix = mixSmoothed.getNextValue();
-    const float dryGain = 1.0f - mix;
-    const float wetGain = mix;
+        juce::FloatVectorOperations::fill(dest + rampLength, (float)target, numSamples - rampLength);
 
-    const bool bypass = std::abs(currentRatio - 1.0) < epsilonBypass;
+        smoother.skip(numSamples - 1);
+    }
 
-    // Initialize grains on first run
-    for (auto& ch : channels)
+    void PitchShifter::process(juce::AudioBuffer<float>& buffer)
     {
-        if (ch.g1.pos == 0.0 && ch.g1.startIndex == 0)
-            retriggerGrain(ch, ch.g1, retriggerDelay);
-        if (ch.g2.pos == 0.0 && ch.g2.startIndex == 0)
-            retriggerGrain(ch, ch.g2, retriggerDelay + hopSize);
+        if (numCh <= 0 || windowSize <= 0 || delayBufferSize <= 0)
+            return;
+
+        // Ramps are preallocated for maxBlock samples
+        const int numSamples = buffer.getNumSamples();
+        for (int start = 0; start < numSamples; start += maxBlock)
+            processChunk(buffer, start, juce::jmin(maxBlock, numSamples - start));
     }
 
-    // Process per channel
-    for (int chIndex = 0; chIndex < buffer.getNumChannels(); ++chIndex)
+    void PitchShifter::processChunk(juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
     {
-        auto& ch = channels[chIndex];
-        float* out = buffer.getWritePointer(chIndex);
-        const float* in = buffer.getReadPointer(chIndex);
+        // Sample-accurate smoothing, computed once per block and shared by every channel
+        fillRamp(pitchRatioSmoothed, ratioRamp.get(), numSamples);
+        fillRamp(mixSmoothed, mixRamp.get(), numSamples);
+
+        // Bypass when ratio ~ 1.0 for the whole block (the ramp is linear) to avoid coloration
+        const bool bypass = std::abs(ratioRamp[0] - 1.0f) < (float)epsilonBypass
+                         && std::abs(ratioRamp[numSamples - 1] - 1.0f) < (float)epsilonBypass;
+
+        if (mode == Mode::Psola)
+        {
+            processPsolaChunk(buffer, startSample, numSamples, bypass);
+            return;
+        }
 
-        float* wetDelayWrite = ch.delayBuffer.getWritePointer(0);
-        float* dryDelayWrite = ch.dryDelayBuffer.getWritePointer(0);
-        const int drySize = ch.dryDelayBuffer.getNumSamples();
+        // Process per channel
+        const int numChannels = juce::jmin(buffer.getNumChannels(), numCh);
 
-        for (int n = 0; n < numSamples; ++n)
+        for (int chIndex = 0; chIndex < numChannels; ++chIndex)
         {
-            // --- Push input into both buffers ---
-            wetDelayWrite[ch.writeIndex] = in[n];
-            dryDelayWrite[ch.dryWriteIndex] = in[n];
-            
-            // Compute dry (latency-compensated) sample: read back latencySamples behind write
-            int dryReadIndex = ch.dryWriteIndex - latencySamples;
-            while (dryReadIndex < 0) dryReadIndex += drySize;
-            dryReadIndex %= drySize;
-            const float drySample = ch.dryDelayBuffer.getReadPointer(0)[dryReadIndex];
-
-            // --- Wet path ---
-            float wetSample = 0.0f;
-
-            if (!bypass)
+            auto& ch = channels[chIndex];
+            float* out = buffer.getWritePointer(chIndex, startSample);
+            const float* in = buffer.getReadPointer(chIndex, startSample);
+
+            float* wetDelay = ch.delayBuffer.getWritePointer(0);
+            float* dryDelay = ch.dryDelayBuffer.getWritePointer(0);
+            const float* hann = hannTable.get();
+            const float* ratio = ratioRamp.get();
+            const float* mix = mixRamp.get();
+
+            // Initialize grains on first run
+            if (!ch.grainsStarted)
             {
-                const double inc = currentRatio;
+                retriggerGrain(ch, ch.g1, retriggerDelay);
+                retriggerGrain(ch, ch.g2, retriggerDelay + hopSize);
+                ch.grainsStarted = true;
+            }
 
-                // Grain 1
-                double g1Phase01 = ch.g1.pos / (double)windowSize;
-                double g1ReadIndex = (double)ch.g1.startIndex + ch.g1.pos * inc;
-                while (g1ReadIndex >= delayBufferSize) g1ReadIndex -= delayBufferSize;
-                while (g1ReadIndex < 0.0) g1ReadIndex += delayBufferSize;
+            for (int n = 0; n < numSamples; ++n)
+            {
+                // --- Push input into both buffers ---
+                wetDelay[ch.writeIndex] = in[n];
+                dryDelay[ch.dryWriteIndex] = in[n];
+
+                // Compute dry (latency-compensated) sample: read back latencySamples behind write
+                const float drySample = dryDelay[(ch.dryWriteIndex - latencySamples) & dryMask];
+
+                // --- Wet path ---
+                float wetSample = 0.0f;
+
+                if (!bypass)
+                {
+                    // Grain 1 & 2: window position is an integer, so the Hann table is read directly
+                    const float g1Samp = readInterpolated(wetDelay, ch.g1.phase) * hann[ch.g1.pos];
+                    const float g2Samp = readInterpolated(wetDelay, ch.g2.phase) * hann[ch.g2.pos];
+
+                    wetSample = g1Samp + g2Samp;
+
+                    // Advance grains by this sample's fixed-point increment
+                    const juce::uint64 inc = (juce::uint64)((double)ratio[n] * fixedOne);
+                    ch.g1.phase += inc;
+                    ch.g2.phase += inc;
+
+                    if (++ch.g1.pos >= windowSize)
+                        retriggerGrain(ch, ch.g1, retriggerDelay);
+                    if (++ch.g2.pos >= windowSize)
+                        retriggerGrain(ch, ch.g2, retriggerDelay + hopSize);
+                }
+                else
+                {
+                    // If bypassing (ratio ~ 1), the wet path is the latency-aligned dry signal
+                    wetSample = drySample;
+                }
+
+                // --- Mix and write output ---
+                out[n] = drySample + mix[n] * (wetSample - drySample);
+
+                // Advance write pointers
+                ch.writeIndex = (ch.writeIndex + 1) & delayMask;
+                ch.dryWriteIndex = (ch.dryWriteIndex + 1) & dryMask;
+            }
+        }
+    }
 
-                const float g1Win = hannAt(g1Phase01);
-                const float g1Samp = readInterpolated(ch, chIndex, g1ReadIndex) * g1Win;
+    void PitchShifter::processPsolaChunk(juce::AudioBuffer<float>& buffer, int startSample, int numSamples, bool bypass)
+    {
+        const int numChannels = juce::jmin(buffer.getNumChannels(), numCh);
 
-                // Grain 2
-                double g2Phase01 = ch.g2.pos / (double)windowSize;
-                double g2ReadIndex = (double)ch.g2.startIndex + ch.g2.pos * inc;
-                while (g2ReadIndex >= delayBufferSize) g2ReadIndex -= delayBufferSize;
-                while (g2ReadIndex < 0.0) g2ReadIndex += delayBufferSize;
+        // --- Push input; the delay line is also the dry path and the detector's frame ---
+        for (int chIndex = 0; chIndex < numChannels; ++chIndex)
+        {
+            const float* in = buffer.getReadPointer(chIndex, startSample);
+            float* ring = channels[(size_t)chIndex].delayBuffer.getWritePointer(0);
 
-                const float g2Win = hannAt(g2Phase01);
-                const float g2Samp = readInterpolated(ch, chIndex, g2ReadIndex) * g2Win;
+            for (int n = 0; n < numSamples; ++n)
+                ring[(int)((inputPosition + n) & delayMask)] = in[n];
+        }
+
+        // --- Marks and grains, computed once from channel 0 ---
+        const float* analysisRing = channels[0].delayBuffer.getReadPointer(0);
+        const juce::int64 newestPosition = inputPosition + numSamples - 1;
+
+        samplesSinceAnalysis += numSamples;
+        if (samplesSinceAnalysis >= analysisHop)
+        {
+            follower.analyseRing(analysisRing, delayMask, (int)(newestPosition & delayMask));
+            samplesSinceAnalysis = 0;
 
-                wetSample = g1Samp + g2Samp;
+            currentPeriod = follower.isPitchDetected()
+                ? juce::jlimit(minPeriod, maxPeriod, (int)std::round(sr / follower.getCurrentFrequency()))
+                : unvoicedPeriod;
+        }
+
+        placePitchMarks(analysisRing, newestPosition);
+        const int numGrains = schedulePsolaGrains(newestPosition - latencySamples, numSamples);
 
-                // Advance grains
-                ch.g1.pos += 1.0;
-                ch.g2.pos += 1.0;
+        // --- Overlap-add and output, per channel ---
+        const float* window = psolaWindow.get();
+        const float* mix = mixRamp.get();
+
+        for (int chIndex = 0; chIndex < numChannels; ++chIndex)
+        {
+            auto& ch = channels[(size_t)chIndex];
+            const float* ring = ch.delayBuffer.getReadPointer(0);
+            float* ola = ch.olaBuffer.getWritePointer(0);
+            float* out = buffer.getWritePointer(chIndex, startSample);
 
-                if (ch.g1.pos >= (double)windowSize)
-                    retriggerGrain(ch, ch.g1, retriggerDelay);
-                if (ch.g2.pos >= (double)windowSize)
-                    retriggerGrain(ch, ch.g2, retriggerDelay + hopSize);
+            for (int i = 0; i < numGrains; ++i)
+            {
+                const auto& grain = psolaGrains[(size_t)i];
+                const int length = 2 * grain.period;
+                const float windowStep = (float)psolaWindowSize / (float)length;
+                const juce::int64 source = grain.analysisPosition - grain.period;
+                const juce::int64 destination = grain.synthesisPosition - grain.period;
+
+                for (int k = 0; k < length; ++k)
+                    ola[(int)((destination + k) & delayMask)] += ring[(int)((source + k) & delayMask)]
+                                                              * window[(int)((float)k * windowStep)] * grain.gain;
             }
-            else
+
+            for (int n = 0; n < numSamples; ++n)
             {
-                // If bypassing (ratio ~ 1), treat wet as zero to avoid coloration,
-                // i.e., output becomes latency-aligned dry only.
-                wetSample = 0.0f;
+                const int index = (int)((inputPosition + n - latencySamples) & delayMask);
+                const float drySample = ring[index];
+                const float wetSample = bypass ? drySample : ola[index];
+                ola[index] = 0.0f;
+
+                out[n] = drySample + mix[n] * (wetSample - drySample);
             }
+        }
+
+        inputPosition += numSamples;
+    }
+
+    void PitchShifter::placePitchMarks(const float* analysisRing, juce::int64 newestPosition)
+    {
+        const bool voiced = follower.isPitchDetected();
+
+        // A mark needs a quarter period of input past it to be refined
+        while (lastMarkPosition + currentPeriod + currentPeriod / 4 <= newestPosition)
+        {
+            juce::int64 position = lastMarkPosition + currentPeriod;
 
-            // --- Mix and write output ---
-            out[n] = dryGain * drySample + wetGain * wetSample;
+            if (voiced)
+                position = PitchFollower::findPitchMark(analysisRing, delayMask, position, currentPeriod);
 
-            // Advance write pointers
-            ch.writeIndex = (ch.writeIndex + 1) % delayBufferSize;
-            ch.dryWriteIndex = (ch.dryWriteIndex + 1) % drySize;
+            // Drop the oldest mark rather than overwrite one the synthesis side still needs
+            if (numMarks - synthesisMark > markMask)
+                ++synthesisMark;
 
+            marks[(size_t)(numMarks & markMask)] = { position, currentPeriod };
+            ++numMarks;
+            lastMarkPosition = position;
         }
     }
+
+    int PitchShifter::schedulePsolaGrains(juce::int64 lastOutputPosition, int numSamples)
+    {
+        // A grain is added while its start is still ahead of the output (centre one period ahead).
+        // By then the input reaches one period past its analysis mark, which is at or before it.
+        const juce::int64 firstOutputPosition = lastOutputPosition - numSamples + 1;
+        const int maxGrains = (int)psolaGrains.size();
+        int numGrains = 0;
+
+        while (nextSynthesisPosition <= (double)(lastOutputPosition + maxPeriod) && numGrains < maxGrains)
+        {
+            const juce::int64 synthesisPosition = (juce::int64)std::round(nextSynthesisPosition);
+
+            // Latest analysis mark at or before the synthesis position
+            while (synthesisMark + 1 < numMarks
+                   && marks[(size_t)((synthesisMark + 1) & markMask)].position <= synthesisPosition)
+                ++synthesisMark;
+
+            const auto& mark = marks[(size_t)(synthesisMark & markMask)];
+
+            // Ratio at the sample where this grain becomes due
+            const int offset = (int)juce::jlimit<juce::int64>(0, numSamples - 1, synthesisPosition - maxPeriod - firstOutputPosition);
+            const float ratio = ratioRamp[offset];
+
+            // Grains overlap 'ratio' times on average; 1 / ratio keeps the level
+            psolaGrains[(size_t)numGrains++] = { synthesisPosition, mark.position, mark.period, 1.0f / ratio };
+
+            // Kept fractional so the output period is exact on average
+            nextSynthesisPosition += juce::jmax(1.0, (double)mark.period / (double)ratio);
+        }
+
+        return numGrains;
+    }
 }
@@ -2,11 +2,21 @@
 #pragma once
 #include <juce_audio_basics/juce_audio_basics.h>
 #include <juce_dsp/juce_dsp.h>
+#include "../followers/PitchFollower.h"
 
 /**
- * PitchShifter: Time-domain granular pitch shifter (dual-head Hann OLA).
+ * PitchShifter: Time-domain pitch shifter.
+ *
+ * Modes:
+ *  - Granular: dual-head Hann OLA with fixed window/hop retriggering. Works on anything.
+ *  - Psola:    pitch-synchronous OLA for monophonic material (vocals, bass). A PitchFollower
+ *              runs on the channel-0 delay line and places pitch marks one period apart;
+ *              grains are two periods long around those marks and are laid out every
+ *              period / ratio. Latency is two of the longest periods (getLatencySamples()),
+ *              ~29 ms at the default 70 Hz floor. Unvoiced input falls back to 10 ms grains.
  *
  * Usage:
+ *  - Optionally setMode(...) and setPsolaFrequencyRange(...)
  *  - Call prepare(sampleRate, maxBlockSize, numChannels)
  *  - Update pitch via setSemitones(...) or setPitchRatio(...)
  *  - Call process(audioBuffer) each block
@@ -15,90 +25,169 @@
  * Notes:
  *  - For best results, use window sizes ~20–60 ms depending on material.
  *  - Bypasses internally when ratio is ~1.0 to avoid coloration.
- * Potential enhancements
- *  - Pitch-detection guided PSOLA for vocal formants (more complex)
- *  - Phase vocoder (FFT-based) for higher fidelity at large ratios; add phase locking to reduce “phasiness”
- *  - Formant preservation by shifting spectral envelope separately
+ *  - Larger ratios at higher fidelity: PhaseVocoderShifter. Formant control: FormantShifter.
  */
-class PitchShifter
+namespace punk_dsp
 {
-public:
-    PitchShifter();
-
-    void prepare(double sampleRate, int maxBlockSize, int numChannels);
-    void reset();
-
-    void setSemitones(float semitones);      // [-24, +24] default range
-    void setPitchRatio(double ratio);        // direct ratio (e.g. 2.0 = +12 st)
-
-    // Tunables (call before prepare or between blocks)
-    void setWindowSizeMs(double ms);         // default 40 ms
-                                             // Shorter (20–30 ms): snappier, less smearing; may warble more on complex material
-                                             // Longer (50–60 ms): smoother, more stable; adds latency and can smear transients
-    void setOverlap(double fractional);      // default 0.5 (50%)
-    void setRetriggerDelayMs(double ms);     // default = window size
-    void setSmoothingTimeMs(double ms);      // default 50 ms
-    void setMix(float newMix);
-
-    void process(juce::AudioBuffer<float>& buffer);
-
-    int getLatencySamples() const noexcept { return latencySamples; }
-
-private:
-    struct Grain
+    class PitchShifter
     {
-        double pos = 0.0;       // position inside window [0, windowSize)
-        int startIndex = 0;     // index in circular buffer where grain begins
+    public:
+        enum class Mode
+        {
+            Granular,
+            Psola
+        };
+
+        PitchShifter();
+
+        void prepare(double sampleRate, int maxBlockSize, int numChannels);
+        void reset();
+
+        void setSemitones(float semitones);      // [-24, +24] default range
+        void setPitchRatio(double ratio);        // direct ratio (e.g. 2.0 = +12 st)
+
+        // Tunables (call before prepare or between blocks)
+        void setWindowSizeMs(double ms);         // default 40 ms
+                                                 // Shorter (20–30 ms): snappier, less smearing; may warble more on complex material
+                                                 // Longer (50–60 ms): smoother, more stable; adds latency and can smear transients
+        void setOverlap(double fractional);      // default 0.5 (50%)
+        void setRetriggerDelayMs(double ms);     // default = window size
+        void setSmoothingTimeMs(double ms);      // default 50 ms
+        void setMix(float newMix);
+
+        // Call before prepare
+        void setMode(Mode newMode);                                  // default Granular
+        void setPsolaFrequencyRange(float minHz, float maxHz);       // default 70 - 1000 Hz; the floor sets the latency
+
+        // Detector used in Psola mode (algorithm, thresholds); configure before prepare
+        PitchFollower& getPitchFollower() noexcept { return follower; }
+
+        void process(juce::AudioBuffer<float>& buffer);
+
+        int getLatencySamples() const noexcept { return latencySamples; }
+
+    private:
+        // Read positions are 32.32 fixed point: the integer part is masked into the ring,
+        // the low 32 bits are the interpolation fraction.
+        static constexpr int fixedShift = 32;
+        static constexpr double fixedOne = 4294967296.0; // 2^32
+
+        struct Grain
+        {
+            int pos = 0;            // position inside window [0, windowSize)
+            juce::uint64 phase = 0; // fixed-point read position in the circular buffer
+        };
+
+        // Per-channel state
+        struct ChannelState
+        {
+            juce::AudioBuffer<float> delayBuffer; // [1 x bufferSize] storage, power of two
+            int writeIndex = 0;
+
+            // Dry delay (for latency compensation), power of two
+            juce::AudioBuffer<float> dryDelayBuffer;
+            int dryWriteIndex = 0;
+
+            Grain g1, g2;           // dual grains
+            bool grainsStarted = false;
+
+            // Psola: overlap-add ring indexed by absolute output position (delayMask)
+            juce::AudioBuffer<float> olaBuffer;
+        };
+
+        // Psola analysis mark: grain centre in the input and the period around it
+        struct PitchMark
+        {
+            juce::int64 position = 0;
+            int period = 0;
+        };
+
+        // Psola grain due in the current chunk (shared by all channels)
+        struct PsolaGrain
+        {
+            juce::int64 synthesisPosition = 0;  // Centre in the output
+            juce::int64 analysisPosition = 0;   // Centre in the input
+            int period = 0;
+            float gain = 1.0f;
+        };
+
+        // Internal helpers
+        void allocateBuffers();
+        void updateDerived();
+        void retriggerGrain(ChannelState& ch, Grain& g, int delaySamples);
+        inline float readInterpolated(const float* delayData, juce::uint64 phase) const noexcept;
+        void processChunk(juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+        void processPsolaChunk(juce::AudioBuffer<float>& buffer, int startSample, int numSamples, bool bypass);
+        void placePitchMarks(const float* analysisRing, juce::int64 newestPosition);
+        int schedulePsolaGrains(juce::int64 lastOutputPosition, int numSamples);
+
+        using LinearSmoother = juce::SmoothedValue<double, juce::ValueSmoothingTypes::Linear>;
+        void fillRamp(LinearSmoother& smoother, float* dest, int numSamples) const noexcept;
+
+        // Configuration
+        double sr = 44100.0;
+        int maxBlock = 512;
+        int numCh = 0;
+
+        int windowSize = 0;         // samples
+        int hopSize = 0;            // samples (overlap 0.5 -> hop = window/2)
+        int retriggerDelay = 0;     // samples (default equals windowSize)
+        int delayBufferSize = 0;    // samples per channel (power of two)
+        int delayMask = 0;          // delayBufferSize - 1
+        int dryBufferSize = 0;      // samples per channel (power of two)
+        int dryMask = 0;            // dryBufferSize - 1
+
+        double windowSizeMs = 40.0;
+        double overlap = 0.5;
+        double retriggerDelayMs = -1.0; // -1 => use window size
+        int latencySamples = 0;
+
+        // Smoothed pitch ratio and mix
+        LinearSmoother pitchRatioSmoothed;
+        double targetRatio = 1.0;
+
+        LinearSmoother mixSmoothed;
+        double targetMix = 1.0;
+
+        // Per-sample values of both smoothers for the current block (maxBlock long)
+        juce::HeapBlock<float> ratioRamp;
+        juce::HeapBlock<float> mixRamp;
+        juce::HeapBlock<float> rampSteps;   // 1, 2, 3, ... scaled by the smoother step
+
+        // Hann table
+        juce::HeapBlock<float> hannTable;
+        int hannTableSize = 0;
+
+        std::vector<ChannelState> channels;
+
+        // Psola
+        Mode mode = Mode::Granular;
+        float psolaMinFrequency = 70.0f;
+        float psolaMaxFrequency = 1000.0f;
+        int maxPeriod = 0;                  // Longest period (samples), half the latency
+        int minPeriod = 0;
+        int unvoicedPeriod = 0;             // Grain spacing when no pitch is detected
+        int analysisHop = 0;                // Detection interval (samples)
+        int samplesSinceAnalysis = 0;
+
+        PitchFollower follower;
+        int currentPeriod = 0;              // Period of the marks being placed
+
+        std::vector<PitchMark> marks;       // Ring of marks, power-of-two size
+        int markMask = 0;
+        juce::int64 numMarks = 0;           // Marks placed so far (absolute count)
+        juce::int64 synthesisMark = 0;      // Mark currently used by the synthesis side
+        juce::int64 lastMarkPosition = 0;
+        double nextSynthesisPosition = 0.0; // Centre of the next grain in the output
+        juce::int64 inputPosition = 0;      // Absolute position of the next input sample
+
+        std::vector<PsolaGrain> psolaGrains;
+
+        // Grain window, read with a per-grain step
+        static constexpr int psolaWindowSize = 1024;
+        juce::HeapBlock<float> psolaWindow;
+
+        // Constants
+        static constexpr double epsilonBypass = 1e-3; // threshold for bypassing near 1.0
     };
-
-    // Per-channel state
-    struct ChannelState
-    {
-        juce::AudioBuffer<float> delayBuffer; // [1 x bufferSize] storage
-        int writeIndex = 0;
-
-        // Dry delay (for latency compensation)
-        juce::AudioBuffer<float> dryDelayBuffer;
-        int dryWriteIndex = 0;
-
-        Grain g1, g2;           // dual grains
-    };
-
-    // Internal helpers
-    void allocateBuffers();
-    void updateDerived();
-    void retriggerGrain(ChannelState& ch, Grain& g, int delaySamples);
-    inline float readInterpolated(const ChannelState& ch, int channel, double readIndex) const noexcept;
-    inline float hannAt(double x01) const noexcept; // x in [0,1]
-
-    // Configuration
-    double sr = 44100.0;
-    int maxBlock = 512;
-    int numCh = 0;
-
-    int windowSize = 0;         // samples
-    int hopSize = 0;            // samples (overlap 0.5 -> hop = window/2)
-    int retriggerDelay = 0;     // samples (default equals windowSize)
-    int delayBufferSize = 0;    // samples per channel
-
-    double windowSizeMs = 40.0;
-    double overlap = 0.5;
-    double retriggerDelayMs = -1.0; // -1 => use window size
-    int latencySamples = 0;
-
-    // Smoothed pitch ratio and mix
-    juce::SmoothedValue<double, juce::ValueSmoothingTypes::Linear> pitchRatioSmoothed;
-    double targetRatio = 1.0;
-
-    juce::SmoothedValue<double, juce::ValueSmoothingTypes::Linear> mixSmoothed;
-    double targetMix = 1.0;
-
-    // Hann table
-    juce::HeapBlock<float> hannTable;
-    int hannTableSize = 0;
-
-    std::vector<ChannelState> channels;
-
-    // Constants
-    static constexpr double epsilonBypass = 1e-3; // threshold for bypassing near 1.0
-};
+}
@@ -4,6 +4,7 @@
 
 namespace punk_dsp
 {
+    template <typename SampleType>
     class EnvelopeFollower
     {
     public:
@@ -17,19 +18,20 @@ namespace punk_dsp
         void setAttack(float newAttMs);
         void setRelease(float newRelMs);
         
-        float getEnvelope();
-        float process(float input_lin);
+        SampleType getEnvelope();
+        SampleType process(SampleType input_lin);
 
     private:
-        float calculateTimeCoeff (float time_ms);
+        SampleType calculateTimeCoeff (float time_ms);
 
         // --- Envelope State ---
-        float envelope { 0.0f };    // Current envelope value
-                                    // Should be confined between 0 and 1
+        SampleType envelope { 0.0f };   // Current envelope value
+                                        // Should be confined between 0 and 1
         
         // Parameters
-        float attackCoeff  { 0.0f };   // Smoothing coefficient (Attack)
-        float releaseCoeff { 0.0f };   // Smoothing coefficient (Release)
+        // The recursion runs in SampleType: long times at high rates keep their precision in double
+        SampleType attackCoeff  { 0.0f };   // Smoothing coefficient (Attack)
+        SampleType releaseCoeff { 0.0f };   // Smoothing coefficient (Release)
         float attackTime   { 1.0f };   // Attack time in ms
         float releaseTime  { 1.0f };   // Release time in ms
         
@@ -7,20 +7,81 @@ namespace punk_dsp
     class PitchFollower
     {
     public:
+        /**
+         * NormalisedCorrelation: peak of the normalised autocorrelation (FFT based).
+         * YIN:                   cumulative mean normalised difference + absolute threshold.
+         * MPM:                   McLeod normalised square difference, first key maximum.
+         *
+         * All three start from the same frequency-domain correlation of the analysis frame; YIN
+         * and MPM derive their difference function from it, d(lag) = E(window) + E(lagged) -
+         * 2 r(lag). An analysis costs one FFT round trip plus one walk over maxLag lags, and
+         * nothing is done per input sample beyond storing it.
+         */
+        enum class Algorithm
+        {
+            NormalisedCorrelation,
+            YIN,
+            MPM
+        };
+        
+        /**
+         * AudioThread:      detection runs inside processBlock (every analysis hop, or once per
+         *                   block when the hop is 0).
+         * BackgroundThread: processBlock only mixes down and pushes into a lock-free FIFO; a
+         *                   worker thread runs detection every hop and publishes the result.
+         */
+        enum class AnalysisThread
+        {
+            AudioThread,
+            BackgroundThread
+        };
+        
         PitchFollower()
         {
             setMinFrequency(40.0f);   // Low E on guitar
             setMaxFrequency(2000.0f); // High notes
         }
         
+        ~PitchFollower()
+        {
+            stopWorker();
+        }
+        
         void prepare(const juce::dsp::ProcessSpec& spec)
         {
-            currentSampleRate = spec.sampleRate;
+            stopWorker();
+            
+            maxBlockSize = juce::jmax(1, static_cast<int>(spec.maximumBlockSize));
+            prepareAnalysis(spec.sampleRate);
+            
+            // Mirrored circular buffer: every frame of the history is contiguous
+            audioBuffer.resize(2 * frameLength);
+            monoBuffer.resize(maxBlockSize);
+            
+            // FIFO holds ~100 ms (and several blocks) so the worker can fall behind briefly
+            const int fifoSize = juce::jmax(4 * maxBlockSize, static_cast<int>(currentSampleRate / 10)) + 1;
+            fifoBuffer.resize(fifoSize);
+            fifo.setTotalSize(fifoSize);
+            
+            reset();
+        }
+        
+        /**
+         * For analyseRing() only: sizes the detection scratch but keeps no history, mono mix-down
+         * or worker FIFO, since the caller's ring is the history. processBlock() does nothing and
+         * the analysis runs on the audio thread whatever setAnalysisThread() says.
+         */
+        void prepareForRing(double sampleRate)
+        {
+            stopWorker();
+            
+            maxBlockSize = 1;
+            prepareAnalysis(sampleRate);
             
-            // Allocate buffer for autocorrelation
-            int maxLag = static_cast<int>(sampleRate / minFrequency);
-            audioBuffer.resize(maxLag * 2);
-            autocorrelation.resize(maxLag);
+            std::vector<float>().swap(audioBuffer);
+            std::vector<float>().swap(monoBuffer);
+            std::vector<float>().swap(fifoBuffer);
+            fifo.setTotalSize(1);
             
             reset();
         }
@@ -40,135 +101,646 @@ namespace punk_dsp
             confidenceThreshold = juce::jlimit(0.0f, 1.0f, threshold);
         }
         
+        void setAlgorithm(Algorithm newAlgorithm)
+        {
+            algorithm = newAlgorithm; // Picked up by the analysis side at its next detection
+        }
+        
+        // YIN absolute threshold on the normalised difference (0.1 - 0.2 is typical)
+        void setYinThreshold(float threshold)
+        {
+            yinThreshold = juce::jlimit(0.01f, 1.0f, threshold);
+        }
+        
+        // MPM key maximum cutoff, relative to the highest maximum (0.8 - 0.95 is typical)
+        void setMpmCutoff(float cutoff)
+        {
+            mpmCutoff = juce::jlimit(0.5f, 1.0f, cutoff);
+        }
+        
+        /**
+         * Runs detection every 'hopSamples' input samples, independent of the host block size.
+         * 0 = once per processBlock (or once per FIFO drain on the background thread).
+         * Call before prepare() or while the audio is stopped.
+         */
+        void setAnalysisHop(int hopSamples)
+        {
+            analysisHop = juce::jmax(0, hopSamples);
+        }
+        
+        /**
+         * Moves detection off the audio thread. Call from the message thread: switching to
+         * BackgroundThread after prepare() starts the worker straight away. The history is
+         * cleared by whichever side analyses next, never from the calling thread.
+         */
+        void setAnalysisThread(AnalysisThread newThread)
+        {
+            if (newThread == analysisThread)
+                return;
+            
+            stopWorker();
+            analysisThread = newThread;
+            resetPending = true;
+            
+            if (newThread == AnalysisThread::BackgroundThread && !fifoBuffer.empty())
+                startWorker();
+        }
+        
+        /**
+         * Worst-case age (in samples) of the newest input that the current estimate has not
+         * seen yet: one hop (or block), plus one worker polling period when running
+         * in the background. The analysis window itself spans getAnalysisWindowSamples().
+         */
+        int getAnalysisLatencySamples() const
+        {
+            const int hop = analysisHop > 0 ? analysisHop.load() : maxBlockSize;
+            
+            if (analysisThread == AnalysisThread::BackgroundThread)
+                return hop + getWorkerIntervalSamples();
+            
+            return hop;
+        }
+        
+        int getAnalysisWindowSamples() const
+        {
+            return frameLength;
+        }
+        
+        // Samples dropped because the worker could not keep up (FIFO full)
+        int getNumDroppedSamples() const
+        {
+            return droppedSamples.load();
+        }
+        
         void processBlock(const juce::AudioBuffer<float>& buffer)
         {
             int numSamples = buffer.getNumSamples();
             int numChannels = buffer.getNumChannels();
             
-            // Mix down to mono and store in circular buffer
-            for (int sample = 0; sample < numSamples; ++sample)
+            if (audioBuffer.empty() || numChannels == 0)
+                return;
+            
+            const float channelGain = 1.0f / static_cast<float>(numChannels);
+            const bool inBackground = analysisThread == AnalysisThread::BackgroundThread;
+            
+            // Just switched back from the worker: skip the block if it is still finishing a drain
+            const juce::SpinLock::ScopedTryLockType lock(analysisLock, ! inBackground);
+            
+            if (! inBackground)
             {
-                float monoSample = 0.0f;
-                for (int channel = 0; channel < numChannels; ++channel)
-                    monoSample += buffer.getSample(channel, sample);
-                
-                monoSample /= static_cast<float>(numChannels);
+                if (! lock.isLocked())
+                    return;
                 
-                audioBuffer[writePosition] = monoSample;
-                writePosition = (writePosition + 1) % audioBuffer.size();
+                if (resetPending.exchange(false))
+                    resetAnalysis();
             }
             
-            // Perform pitch detection
-            detectPitch();
+            for (int start = 0; start < numSamples; start += maxBlockSize)
+            {
+                const int chunk = juce::jmin(maxBlockSize, numSamples - start);
+                
+                // Mix down to mono
+                juce::FloatVectorOperations::copyWithMultiply(monoBuffer.data(), buffer.getReadPointer(0, start), channelGain, chunk);
+                for (int channel = 1; channel < numChannels; ++channel)
+                    juce::FloatVectorOperations::addWithMultiply(monoBuffer.data(), buffer.getReadPointer(channel, start), channelGain, chunk);
+                
+                if (inBackground)
+                    pushToWorker(monoBuffer.data(), chunk);
+                else
+                    analyseSamples(monoBuffer.data(), chunk);
+            }
         }
-        
+
+        /**
+         * Runs one detection on the newest getAnalysisWindowSamples() samples of a caller-owned
+         * power-of-two ring (e.g. a pitch shifter's delay line), so detector and shifter share
+         * one analysis buffer instead of each keeping a history. 'newestIndex' is the ring index
+         * of the newest sample; the ring must hold at least getAnalysisWindowSamples(). The frame
+         * is copied from the ring's (at most two) contiguous spans straight into the FFT input.
+         * Prepare with prepareForRing() (or prepare()); audio thread only, and don't mix with
+         * processBlock on the same instance.
+         */
+        void analyseRing(const float* ring, int ringMask, int newestIndex)
+        {
+            if (fft == nullptr)
+                return;
+
+            const int oldest = (newestIndex - frameLength + 1) & ringMask;
+            const int firstSpan = juce::jmin(frameLength, ringMask + 1 - oldest);
+
+            std::copy(ring + oldest, ring + oldest + firstSpan, fftFrame.begin());
+            std::copy(ring, ring + frameLength - firstSpan, fftFrame.begin() + firstSpan);
+
+            detectPitchInFrame();
+        }
+
+        /**
+         * Pitch mark (epoch) for PSOLA: position of the largest sample within a quarter period
+         * of 'predictedPosition', read from a power-of-two ring indexed by absolute position.
+         * Marks placed one period apart land on the same point of every cycle, so grains cut
+         * around them stay phase-coherent.
+         */
+        static juce::int64 findPitchMark(const float* ring, int ringMask, juce::int64 predictedPosition, int period)
+        {
+            const int radius = juce::jmax(1, period / 4);
+            juce::int64 bestPosition = predictedPosition;
+            float bestValue = ring[static_cast<int>(predictedPosition & ringMask)];
+
+            for (juce::int64 position = predictedPosition - radius; position <= predictedPosition + radius; ++position)
+            {
+                const float value = ring[static_cast<int>(position & ringMask)];
+
+                if (value > bestValue)
+                {
+                    bestValue = value;
+                    bestPosition = position;
+                }
+            }
+
+            return bestPosition;
+        }
+
         float getCurrentFrequency() const
         {
-            return detectedFrequency;
+            return estimate.load().frequency;
         }
         
         juce::String getCurrentNote() const
         {
-            if (!isPitchDetected())
+            const auto current = estimate.load();
+            
+            if (current.confidence < confidenceThreshold)
                 return "---";
             
-            return frequencyToNoteName(detectedFrequency);
+            return frequencyToNoteName(current.frequency);
         }
         
         int getCurrentMidiNote() const
         {
-            if (!isPitchDetected())
+            const auto current = estimate.load();
+            
+            if (current.confidence < confidenceThreshold)
                 return -1;
             
-            return frequencyToMidiNote(detectedFrequency);
+            return frequencyToMidiNote(current.frequency);
         }
         
         float getConfidence() const
         {
-            return confidence;
+            return estimate.load().confidence;
         }
         
         bool isPitchDetected() const
         {
-            return confidence >= confidenceThreshold;
+            return getConfidence() >= confidenceThreshold;
         }
         
+        // Call while the audio is stopped (prepare() does)
         void reset()
         {
-            std::fill(audioBuffer.begin(), audioBuffer.end(), 0.0f);
-            writePosition = 0;
-            detectedFrequency = 0.0f;
-            confidence = 0.0f;
+            stopWorker();
+            
+            resetAnalysis();
+            resetPending = false;
+            
+            fifo.reset();
+            droppedSamples = 0;
+            
+            if (analysisThread == AnalysisThread::BackgroundThread && !fifoBuffer.empty())
+                startWorker();
         }
 
     private:
+        // --- Analysis (audio thread or worker) ---
+        
+        struct Estimate
+        {
+            float frequency = 0.0f;
+            float confidence = 0.0f;
+        };
+        
+        // Lag range, frame length and the FFT scratch shared by both prepare paths
+        void prepareAnalysis(double sampleRate)
+        {
+            currentSampleRate = sampleRate;
+            
+            // Analysis window = longest period (and the lag past it, which the peak search compares
+            // against), plus the same amount of history to slide it over
+            maxLag = juce::jmax(2, static_cast<int>(currentSampleRate / minFrequency) + 2);
+            frameLength = 2 * maxLag;
+            
+            lagCurve.resize(maxLag + 2);
+            energyPrefix.resize(frameLength + 1);
+            
+            // Frame length is enough for a linear (non-wrapping) correlation of every lag
+            int fftOrder = 1;
+            while ((1 << fftOrder) < frameLength)
+                ++fftOrder;
+            
+            fft = std::make_unique<juce::dsp::FFT>(fftOrder);
+            fftFrame.resize(2 * fft->getSize());
+            fftWindow.resize(2 * fft->getSize());
+        }
+        
+        void resetAnalysis()
+        {
+            std::fill(audioBuffer.begin(), audioBuffer.end(), 0.0f);
+            writePosition = 0;
+            samplesSinceAnalysis = 0;
+            estimate = Estimate {};
+        }
+        
+        void analyseSamples(const float* samples, int numSamples)
+        {
+            const int hop = analysisHop;
+            
+            while (numSamples > 0)
+            {
+                // Store up to the next detection (or the whole chunk) in one go
+                const int chunk = hop > 0 ? juce::jmin(numSamples, hop - samplesSinceAnalysis) : numSamples;
+                storeSamples(samples, chunk);
+                
+                samples += chunk;
+                numSamples -= chunk;
+                
+                if (hop > 0 && (samplesSinceAnalysis += chunk) >= hop)
+                {
+                    detectPitch();
+                    samplesSinceAnalysis = 0;
+                }
+            }
+            
+            if (hop == 0)
+                detectPitch();
+        }
+        
+        // Writes both halves of the mirrored history, wrapping at most once per half
+        void storeSamples(const float* samples, int numSamples)
+        {
+            while (numSamples > 0)
+            {
+                const int chunk = juce::jmin(numSamples, frameLength - writePosition);
+                
+                std::copy(samples, samples + chunk, audioBuffer.begin() + writePosition);
+                std::copy(samples, samples + chunk, audioBuffer.begin() + writePosition + frameLength);
+                
+                samples += chunk;
+                numSamples -= chunk;
+                writePosition += chunk;
+                
+                if (writePosition == frameLength)
+                    writePosition = 0;
+            }
+        }
+        
+        // --- Background analysis ---
+        
+        class Worker : public juce::Thread
+        {
+        public:
+            explicit Worker(PitchFollower& ownerToUse)
+                : juce::Thread("PitchFollower analysis"), owner(ownerToUse) {}
+            
+            void run() override
+            {
+                while (!threadShouldExit())
+                {
+                    owner.drainFifo();
+                    wait(owner.getWorkerIntervalMs());
+                }
+            }
+            
+        private:
+            PitchFollower& owner;
+        };
+        
+        // Audio thread: lock-free single-producer write, drops what does not fit
+        void pushToWorker(const float* samples, int numSamples)
+        {
+            int start1, size1, start2, size2;
+            fifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+            
+            if (size1 > 0) std::copy(samples, samples + size1, fifoBuffer.begin() + start1);
+            if (size2 > 0) std::copy(samples + size1, samples + size1 + size2, fifoBuffer.begin() + start2);
+            
+            fifo.finishedWrite(size1 + size2);
+            
+            if (size1 + size2 < numSamples)
+                droppedSamples += numSamples - (size1 + size2);
+        }
+        
+        // Worker thread: single-consumer read
+        void drainFifo()
+        {
+            const juce::SpinLock::ScopedLockType lock(analysisLock);
+            
+            // Fresh start after a switch: drop what was queued before it
+            if (resetPending.exchange(false))
+            {
+                resetAnalysis();
+                fifo.finishedRead(fifo.getNumReady());
+                return;
+            }
+            
+            int start1, size1, start2, size2;
+            fifo.prepareToRead(fifo.getNumReady(), start1, size1, start2, size2);
+            
+            if (size1 > 0) analyseSamples(fifoBuffer.data() + start1, size1);
+            if (size2 > 0) analyseSamples(fifoBuffer.data() + start2, size2);
+            
+            fifo.finishedRead(size1 + size2);
+        }
+        
+        // Polls at half the hop (or block) period, at least every millisecond
+        int getWorkerIntervalMs() const
+        {
+            const int hop = analysisHop > 0 ? analysisHop.load() : maxBlockSize;
+            return juce::jmax(1, static_cast<int>(500.0 * hop / currentSampleRate));
+        }
+        
+        int getWorkerIntervalSamples() const
+        {
+            return static_cast<int>(std::ceil(getWorkerIntervalMs() * currentSampleRate / 1000.0));
+        }
+        
+        void startWorker()
+        {
+            worker = std::make_unique<Worker>(*this);
+            worker->startThread();
+        }
+        
+        void stopWorker()
+        {
+            if (worker != nullptr)
+            {
+                worker->stopThread(1000);
+                worker.reset();
+            }
+        }
+        
+        // --- Detection ---
+        
+        // Detection on the newest frame of the internal history
         void detectPitch()
         {
-            int minLag = static_cast<int>(currentSampleRate / maxFrequency);
-            int maxLag = static_cast<int>(currentSampleRate / minFrequency);
-            int bufferSize = audioBuffer.size() / 2;
+            const float* frame = audioBuffer.data() + writePosition; // Oldest sample first
+            std::copy(frame, frame + frameLength, fftFrame.begin());
             
-            // Autocorrelation using YIN-like approach
-            float threshold = 0.1f;
-            int bestLag = -1;
-            float bestCorrelation = 0.0f;
+            detectPitchInFrame();
+        }
+        
+        // Detection on the frame in fftFrame[0, frameLength), oldest sample first
+        void detectPitchInFrame()
+        {
+            const int minLag = juce::jmax(2, static_cast<int>(currentSampleRate / maxFrequency));
+            const int lagLimit = juce::jmin(static_cast<int>(currentSampleRate / minFrequency) + 1, maxLag - 1);
+            
+            float refinedLag = 0.0f;
+            float newConfidence = 0.0f;
             
-            for (int lag = minLag; lag < maxLag && lag < bufferSize; ++lag)
+            if (minLag < lagLimit)
             {
-                float sum = 0.0f;
-                float energy1 = 0.0f;
-                float energy2 = 0.0f;
+                computeCorrelationTerms();
                 
-                for (int i = 0; i < bufferSize; ++i)
+                switch (algorithm.load())
                 {
-                    int pos1 = (writePosition - bufferSize + i + audioBuffer.size()) % audioBuffer.size();
-                    int pos2 = (writePosition - bufferSize + i + lag + audioBuffer.size()) % audioBuffer.size();
-                    
-                    float sample1 = audioBuffer[pos1];
-                    float sample2 = audioBuffer[pos2];
+                    case Algorithm::YIN:    detectYin(minLag, lagLimit, refinedLag, newConfidence); break;
+                    case Algorithm::MPM:    detectMpm(minLag, lagLimit, refinedLag, newConfidence); break;
+                    case Algorithm::NormalisedCorrelation:
+                    default:                detectCorrelationPeak(minLag, lagLimit, refinedLag, newConfidence); break;
+                }
+            }
+            
+            // Publish frequency and confidence together
+            Estimate newEstimate;
+            
+            if (refinedLag > 0.0f)
+            {
+                newEstimate.frequency = static_cast<float>(currentSampleRate / refinedLag);
+                newEstimate.confidence = juce::jlimit(0.0f, 1.0f, newConfidence);
+            }
+            
+            estimate = newEstimate;
+        }
+        
+        void detectCorrelationPeak(int minLag, int lagLimit, float& refinedLag, float& newConfidence)
+        {
+            computeNormalisedCorrelation(lagLimit);
+            
+            const float threshold = 0.1f;
+            float bestCorrelation = 0.0f;
+            
+            for (int lag = minLag; lag < lagLimit; ++lag)
+                bestCorrelation = juce::jmax(bestCorrelation, lagCurve[lag]);
+            
+            if (bestCorrelation <= threshold)
+                return;
+            
+            // Every multiple of the period correlates about as well as the period itself: take the
+            // first peak close to the best one rather than the best, which is often an octave down
+            const float cutoff = correlationPeakCutoff * bestCorrelation;
+            
+            for (int lag = minLag; lag < lagLimit; ++lag)
+            {
+                if (lagCurve[lag] >= cutoff && lagCurve[lag] >= lagCurve[lag - 1] && lagCurve[lag] >= lagCurve[lag + 1])
+                {
+                    refinedLag = refineLagEstimate(lag, newConfidence);
+                    return;
+                }
+            }
+        }
+        
+        void detectYin(int minLag, int lagLimit, float& refinedLag, float& newConfidence)
+        {
+            // Cumulative mean normalised difference: d'(lag) = d(lag) * lag / sum(d(1..lag))
+            const double windowEnergy = getWindowEnergy(0);
+            lagCurve[0] = 1.0f;
+            double runningSum = 0.0;
+            
+            for (int lag = 1; lag <= lagLimit; ++lag)
+            {
+                const double d = juce::jmax(0.0, windowEnergy + getWindowEnergy(lag) - 2.0 * getCorrelation(lag));
+                runningSum += d;
+                lagCurve[lag] = runningSum > 1e-12 ? static_cast<float>(d * lag / runningSum) : 1.0f;
+            }
+            
+            // First dip under the absolute threshold, followed down to its minimum
+            const float threshold = yinThreshold;
+            int bestLag = -1;
+            for (int lag = minLag; lag < lagLimit; ++lag)
+            {
+                if (lagCurve[lag] < threshold)
+                {
+                    while (lag + 1 < lagLimit && lagCurve[lag + 1] < lagCurve[lag])
+                        ++lag;
                     
-                    sum += sample1 * sample2;
-                    energy1 += sample1 * sample1;
-                    energy2 += sample2 * sample2;
+                    bestLag = lag;
+                    break;
+                }
+            }
+            
+            if (bestLag < 0)
+                return; // Unvoiced
+            
+            // Interpolate on the negated curve so the helper always refines a maximum
+            float peak = 0.0f;
+            refinedLag = refineLagEstimate(bestLag, peak, -1.0f);
+            newConfidence = 1.0f + peak; // peak = -d'(lag)
+        }
+        
+        void detectMpm(int minLag, int lagLimit, float& refinedLag, float& newConfidence)
+        {
+            // NSDF: n(lag) = 2 r(lag) / m(lag) = 1 - d(lag) / m(lag), with m the energy of both windows
+            const double windowEnergy = getWindowEnergy(0);
+            lagCurve[0] = 1.0f;
+            
+            for (int lag = 1; lag <= lagLimit; ++lag)
+            {
+                const double m = windowEnergy + getWindowEnergy(lag);
+                lagCurve[lag] = m > 1e-9 ? static_cast<float>(2.0 * getCorrelation(lag) / m) : 0.0f;
+            }
+            
+            // Key maxima: the highest point between each positive-going zero crossing and the next
+            // negative-going one. Skip the lobe around lag 0.
+            int lag = 1;
+            while (lag < lagLimit && lagCurve[lag] > 0.0f)
+                ++lag;
+            
+            int numKeyMaxima = 0;
+            float highestMaximum = 0.0f;
+            
+            while (lag < lagLimit && numKeyMaxima < maxKeyMaxima)
+            {
+                while (lag < lagLimit && lagCurve[lag] <= 0.0f)
+                    ++lag;
+                
+                int peakLag = lag;
+                while (lag < lagLimit && lagCurve[lag] > 0.0f)
+                {
+                    if (lagCurve[lag] > lagCurve[peakLag])
+                        peakLag = lag;
+                    ++lag;
                 }
                 
-                // Normalized correlation
-                float denominator = std::sqrt(energy1 * energy2);
-                if (denominator > 1e-6f)
+                if (peakLag < lagLimit && peakLag >= minLag)
                 {
-                    float correlation = sum / denominator;
-                    
-                    if (correlation > bestCorrelation)
-                    {
-                        bestCorrelation = correlation;
-                        bestLag = lag;
-                    }
+                    keyMaxima[numKeyMaxima++] = peakLag;
+                    highestMaximum = juce::jmax(highestMaximum, lagCurve[peakLag]);
                 }
             }
             
-            // Update detected frequency and confidence
-            if (bestLag > 0 && bestCorrelation > threshold)
+            // The first key maximum close enough to the highest avoids the octave-down pick
+            const float cutoff = mpmCutoff;
+            for (int i = 0; i < numKeyMaxima; ++i)
             {
-                // Parabolic interpolation for sub-sample accuracy
-                float refinedLag = refinelagEstimate(bestLag);
-                detectedFrequency = static_cast<float>(currentSampleRate / refinedLag);
-                confidence = bestCorrelation;
+                if (lagCurve[keyMaxima[i]] >= cutoff * highestMaximum)
+                {
+                    refinedLag = refineLagEstimate(keyMaxima[i], newConfidence);
+                    return;
+                }
             }
-            else
+        }
+        
+        // --- Frequency-domain correlation ---
+        
+        /**
+         * Fills lagCurve[lag] with the normalised correlation between the newest
+         * maxLag samples and the same window 'lag' samples earlier.
+         */
+        void computeNormalisedCorrelation(int lagLimit)
+        {
+            const double windowEnergy = getWindowEnergy(0);
+            
+            lagCurve[0] = 1.0f;
+            for (int lag = 1; lag <= lagLimit; ++lag)
             {
-                detectedFrequency = 0.0f;
-                confidence = 0.0f;
+                const double denominator = std::sqrt(windowEnergy * getWindowEnergy(lag));
+                
+                lagCurve[lag] = denominator > 1e-6
+                    ? static_cast<float>(getCorrelation(lag) / denominator)
+                    : 0.0f;
             }
         }
         
-        float refinelagEstimate(int lag)
+        /**
+         * Wiener-Khinchin: the raw cross-correlation of every lag comes out of one
+         * IFFT(conj(A) * F), where F is the whole history frame and A the newest window
+         * zero-padded. The frame fits in the FFT without wrapping, so the result is the
+         * same as the direct O(lags x window) sum. Energies come from a running sum of
+         * squares, so each lag costs O(1) afterwards.
+         *
+         * Expects the frame in fftFrame[0, frameLength), oldest sample first. Afterwards
+         * fftFrame[k] = sum(window[i] * frame[i + k]), i.e. lag = maxLag - k.
+         */
+        void computeCorrelationTerms()
         {
-            // Simple parabolic interpolation
-            if (lag <= 0 || lag >= autocorrelation.size() - 1)
+            const int fftSize = fft->getSize();
+            const float* frame = fftFrame.data();
+            
+            std::fill(fftFrame.begin() + frameLength, fftFrame.end(), 0.0f);
+            
+            // Newest window, zero-padded
+            std::copy(frame + frameLength - maxLag, frame + frameLength, fftWindow.begin());
+            std::fill(fftWindow.begin() + maxLag, fftWindow.end(), 0.0f);
+            
+            computeEnergyPrefix(frame);
+            
+            fft->performRealOnlyForwardTransform(fftFrame.data(), true);
+            fft->performRealOnlyForwardTransform(fftWindow.data(), true);
+            
+            auto* frameBins = reinterpret_cast<std::complex<float>*>(fftFrame.data());
+            const auto* windowBins = reinterpret_cast<const std::complex<float>*>(fftWindow.data());
+            
+            for (int bin = 0; bin <= fftSize / 2; ++bin)
+                frameBins[bin] *= std::conj(windowBins[bin]);
+            
+            fft->performRealOnlyInverseTransform(fftFrame.data());
+        }
+        
+        // Raw correlation r(lag) between the newest window and the one 'lag' samples earlier
+        double getCorrelation(int lag) const
+        {
+            return fftFrame[maxLag - lag];
+        }
+        
+        // Running sum of squares over the frame (oldest sample first)
+        void computeEnergyPrefix(const float* frame)
+        {
+            energyPrefix[0] = 0.0;
+            for (int i = 0; i < frameLength; ++i)
+                energyPrefix[i + 1] = energyPrefix[i] + static_cast<double>(frame[i]) * frame[i];
+        }
+        
+        // Energy of the maxLag-long window that ends 'lag' samples before the newest one
+        double getWindowEnergy(int lag) const
+        {
+            const int end = frameLength - lag;
+            return energyPrefix[end] - energyPrefix[end - maxLag];
+        }
+        
+        /**
+         * Parabolic interpolation of the peak of lagCurve around 'lag'.
+         * 'sign' = -1 refines a minimum instead. peakValue receives the interpolated height.
+         */
+        float refineLagEstimate(int lag, float& peakValue, float sign = 1.0f) const
+        {
+            peakValue = sign * lagCurve[lag];
+            
+            if (lag <= 0 || lag >= static_cast<int>(lagCurve.size()) - 1)
                 return static_cast<float>(lag);
             
-            // Return the lag as-is for now (can be enhanced with interpolation)
-            return static_cast<float>(lag);
+            const float left = sign * lagCurve[lag - 1];
+            const float centre = peakValue;
+            const float right = sign * lagCurve[lag + 1];
+            
+            const float curvature = left - 2.0f * centre + right;
+            if (curvature >= 0.0f)
+                return static_cast<float>(lag); // Not a strict maximum
+            
+            const float offset = juce::jlimit(-0.5f, 0.5f, 0.5f * (left - right) / curvature);
+            peakValue = centre - 0.25f * (left - right) * offset;
+            
+            return static_cast<float>(lag) + offset;
         }
         
         static juce::String frequencyToNoteName(float frequency)
@@ -214,19 +786,55 @@ namespace punk_dsp
             return 1200.0f * std::log2(frequency / targetFreq);
         }
         
-        std::vector<float> audioBuffer;
-        std::vector<float> autocorrelation;
+        std::vector<float> audioBuffer;     // Mirrored: [frame | frame]
+        std::vector<float> lagCurve;        // Per-lag curve of the current algorithm
         int writePosition = 0;
+        int maxLag = 0;                     // Longest lag (samples) the buffers were sized for
+        int frameLength = 0;                // Window + lags
+        
+        // Frequency-domain autocorrelation (allocated in prepare)
+        std::unique_ptr<juce::dsp::FFT> fft;
+        std::vector<float> fftFrame;        // Whole history frame -> correlation of every lag
+        std::vector<float> fftWindow;       // Newest window, zero-padded
+        std::vector<double> energyPrefix;
+        
+        static constexpr float correlationPeakCutoff = 0.9f;
+        static constexpr int maxKeyMaxima = 32;
+        std::array<int, maxKeyMaxima> keyMaxima {};
+        
         
         double currentSampleRate = 44100.0;
-        float minFrequency = 40.0f;
-        float maxFrequency = 2000.0f;
-        float confidenceThreshold = 0.3f;
+        int maxBlockSize = 512;
+        
+        // Parameters (written by the message thread, read by whichever thread analyses)
+        std::atomic<float> minFrequency { 40.0f };
+        std::atomic<float> maxFrequency { 2000.0f };
+        std::atomic<float> confidenceThreshold { 0.3f };
+        std::atomic<Algorithm> algorithm { Algorithm::NormalisedCorrelation };
+        std::atomic<float> yinThreshold { 0.15f };
+        std::atomic<float> mpmCutoff { 0.9f };
+        
+        // Result, published as one lock-free 64-bit value
+        std::atomic<Estimate> estimate { Estimate {} };
+        
+        // Analysis scheduling (hop and thread are set by the message thread, read by both sides)
+        std::atomic<int> analysisHop { 0 };     // 0 = once per block / per drain
+        std::atomic<AnalysisThread> analysisThread { AnalysisThread::AudioThread };
+        int samplesSinceAnalysis = 0;
+        
+        // Whoever analyses holds analysisLock (the audio thread only ever tries it); a switch of
+        // thread asks that side to clear the history first
+        juce::SpinLock analysisLock;
+        std::atomic<bool> resetPending { false };
         
-        float detectedFrequency = 0.0f;
-        float confidence = 0.0f;
+        // Audio thread -> worker
+        std::vector<float> monoBuffer;
+        std::vector<float> fifoBuffer;
+        juce::AbstractFifo fifo { 1 };
+        std::atomic<int> droppedSamples { 0 };
+        std::unique_ptr<Worker> worker;
 
         // --- Prevent copy and move ---
-        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Compressor)
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PitchFollower)
     };
 }
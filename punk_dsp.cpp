@@ -13,16 +13,19 @@
 #include "dsp/Dynamics/Compressor.cpp"
 #include "dsp/Dynamics/Lifter.cpp"
 #include "dsp/Dynamics/Gate.cpp"
+#include "dsp/Dynamics/MultibandCompressor.cpp"
 
 #include "dsp/Distortion/Waveshaper.cpp"
 #include "dsp/Distortion/TubeModel.cpp"
 #include "dsp/Distortion/Wavefolder.cpp"
 #include "dsp/Distortion/ParametricWaveshaper.cpp"
+#include "dsp/Distortion/TableShaper.cpp"
 
 #include "dsp/Followers/EnvelopeFollower.cpp"
 
-// #include "dsp/Pitch/PitchShifter.cpp"
-// #include "dsp/Pitch/FormantShifter.cpp"
+#include "dsp/Pitch/PitchShifter.cpp"
+#include "dsp/Pitch/PhaseVocoderShifter.cpp"
+#include "dsp/Pitch/FormantShifter.cpp"
 
 // GUI C++ Files
 #include "gui/ExamplesLnF.cpp"
@@ -10,7 +10,7 @@
   license:          MIT License
   minimumCppStandard: 17
 
-  dependencies:     juce_audio_basics, juce_gui_basics
+  dependencies:     juce_audio_basics, juce_dsp, juce_gui_basics
   OSXFrameworks:
   iOSFrameworks:
   linuxLibs:
@@ -22,24 +22,39 @@
 #pragma once
 #define PUNK_DSP_H_INCLUDED
 
+//==============================================================================
+/** Config: PUNK_DSP_DECIBEL_ACCURACY
+    Selects the gain <-> dB conversions used by Compressor, Gate and Lifter:
+    0 = juce::Decibels (reference), 1 = fast, 2 = balanced, 3 = precise.
+    See dsp/Dynamics/DecibelConversions.h for the error of each tier.
+*/
+#ifndef PUNK_DSP_DECIBEL_ACCURACY
+ #define PUNK_DSP_DECIBEL_ACCURACY 2
+#endif
+
 // --- DSP ---
 // Dynamics
 #include "dsp/Dynamics/Compressor.h"
 #include "dsp/Dynamics/Lifter.h"
 #include "dsp/Dynamics/Gate.h"
+#include "dsp/Dynamics/MultibandCompressor.h"
 
 // Distortion
 #include "dsp/Distortion/Waveshaper.h"
 #include "dsp/Distortion/TubeModel.h"
 #include "dsp/Distortion/Wavefolder.h"
 #include "dsp/Distortion/ParametricWaveshaper.h"
+#include "dsp/Distortion/TableShaper.h"
+#include "dsp/Distortion/Oversampled.h"
 
 // Followers
 #include "dsp/Followers/EnvelopeFollower.h"
+#include "dsp/Followers/PitchFollower.h"
 
 // Pitch
-// #include "dsp/Pitch/PitchShifter.h"
-// #include "dsp/Pitch/FormantShifter.h"
+#include "dsp/Pitch/PitchShifter.h"
+#include "dsp/Pitch/PhaseVocoderShifter.h"
+#include "dsp/Pitch/FormantShifter.h"
 
 // --- GUI ---
 #include "gui/ExamplesLnF.h"
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <juce_core/juce_core.h>
+#include <chrono>
+#include <limits>
+
+namespace punk_dsp::benchmark
+{
+    /**
+     * Time per call of body, in nanoseconds: the best of 'runs' runs of 'iterations' calls each.
+     * The best run is the one the scheduler disturbed least, which is what a before/after
+     * comparison on the same machine needs.
+     */
+    template <typename Body>
+    double nanosecondsPerCall(int runs, int iterations, Body&& body)
+    {
+        double best = std::numeric_limits<double>::max();
+
+        for (int run = 0; run < runs; ++run)
+        {
+            const auto start = std::chrono::steady_clock::now();
+
+            for (int i = 0; i < iterations; ++i)
+                body();
+
+            const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+            best = juce::jmin(best, elapsed.count() / iterations);
+        }
+
+        return best;
+    }
+
+    // Deterministic test signal: a chord plus a little noise, different on every channel
+    inline void fillTestSignal(juce::AudioBuffer<float>& buffer, double sampleRate, juce::int64 startSample)
+    {
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        {
+            float* data = buffer.getWritePointer(channel);
+            juce::uint32 noise = 0x9e3779b9u * (juce::uint32) (channel + 1) + (juce::uint32) startSample;
+
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+            {
+                const double t = (double) (startSample + i) / sampleRate;
+                noise = noise * 1664525u + 1013904223u;
+
+                data[i] = (float) (0.3 * std::sin(juce::MathConstants<double>::twoPi * 220.0 * (1.0 + 0.01 * channel) * t)
+                                 + 0.2 * std::sin(juce::MathConstants<double>::twoPi * 330.0 * t)
+                                 + 0.05 * ((double) (noise >> 8) / 8388608.0 - 1.0));
+            }
+        }
+    }
+}
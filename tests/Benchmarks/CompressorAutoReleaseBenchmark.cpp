@@ -0,0 +1,173 @@
+#include <juce_dsp/juce_dsp.h>
+#include "dsp/Dynamics/Compressor.h"
+#include "Benchmark.h"
+
+namespace
+{
+    /**
+     * The stereo block path as it was before auto release: the same detection and dB stages, with
+     * the ballistics loop tracking the target directly and its state read and written through the
+     * per-channel envelope. Feed-forward, Peak detector, no lookahead, K = 1.
+     */
+    class LegacyBlockCompressor
+    {
+    public:
+        void prepare(float newSampleRate, int maxBlockSize, int numChannels)
+        {
+            sampleRate = newSampleRate;
+            detectorSize = (maxBlockSize + simdLanes - 1) / simdLanes * simdLanes;
+            storage.allocate((size_t) (detectorSize + simdLanes), true);
+            detector = SIMDFloat::getNextSIMDAlignedPtr(storage.get());
+            envelope.assign((size_t) numChannels, 0.0f);
+        }
+
+        void setParameters(float thresdB, float ratio, float kneedB, float attackMs, float releaseMs)
+        {
+            knee = juce::jmax(kneedB, 1.0e-6f);
+            compressionSlope = 1.0f - 1.0f / ratio;
+            kneeStart = thresdB - kneedB / 2.0f;
+            kneeEnd = thresdB + kneedB / 2.0f;
+            attackCoeff = std::exp(-1.f / (0.001f * attackMs * sampleRate));
+            releaseCoeff = std::exp(-1.f / (0.001f * releaseMs * sampleRate));
+        }
+
+        void process(juce::AudioBuffer<float>& buffer)
+        {
+            const int numSamples = buffer.getNumSamples();
+            const int numPadded = (numSamples + simdLanes - 1) / simdLanes * simdLanes;
+            const float kneeCurve = compressionSlope / (2.0f * knee);
+
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+            {
+                float* data = buffer.getWritePointer(channel);
+                float& reduction = envelope[(size_t) channel];
+                reduction = -reduction;
+
+                juce::FloatVectorOperations::abs(detector, data, numSamples);
+                juce::FloatVectorOperations::max(detector, detector, 0.00001f, numSamples);
+                juce::FloatVectorOperations::fill(detector + numSamples, 0.00001f, numPadded - numSamples);
+
+                for (int i = 0; i < numPadded; i += simdLanes)
+                    punk_dsp::DynamicsDecibels::gainToDecibels(SIMDFloat::fromRawArray(detector + i)).copyToRawArray(detector + i);
+
+                for (int sample = 0; sample < numSamples; ++sample)
+                {
+                    const float inputDB = detector[sample];
+                    const float intoKnee = juce::jlimit(0.0f, knee, inputDB - kneeStart);
+                    const float target = intoKnee * intoKnee * kneeCurve + juce::jmax(0.0f, inputDB - kneeEnd) * compressionSlope;
+
+                    const float alpha = target > reduction ? attackCoeff : releaseCoeff;
+                    reduction = target + alpha * (reduction - target);
+
+                    detector[sample] = -reduction;
+                }
+
+                for (int i = 0; i < numPadded; i += simdLanes)
+                    punk_dsp::DynamicsDecibels::decibelsToGain(SIMDFloat::fromRawArray(detector + i)).copyToRawArray(detector + i);
+
+                juce::FloatVectorOperations::multiply(detector, mix, numSamples);
+                juce::FloatVectorOperations::add(detector, 1.0f - mix, numSamples);
+                juce::FloatVectorOperations::multiply(data, detector, numSamples);
+
+                reduction = -reduction;
+            }
+        }
+
+    private:
+        using SIMDFloat = juce::dsp::SIMDRegister<float>;
+        static constexpr int simdLanes = (int) SIMDFloat::SIMDNumElements;
+
+        juce::HeapBlock<float> storage;
+        float* detector = nullptr;
+        int detectorSize = 0;
+        std::vector<float> envelope;
+
+        float sampleRate = 44100.0f, knee = 0.0f, compressionSlope = 0.0f, kneeStart = 0.0f, kneeEnd = 0.0f;
+        float attackCoeff = 0.0f, releaseCoeff = 0.0f, mix = 1.0f;
+    };
+}
+
+class CompressorAutoReleaseBenchmark : public juce::UnitTest
+{
+public:
+    CompressorAutoReleaseBenchmark() : juce::UnitTest("Compressor auto release", "Benchmarks") {}
+
+    void runTest() override
+    {
+        beginTest("256-sample blocks at 48 kHz: before / auto release off / on");
+
+        // Stereo takes the block path; eight channels take the lane-per-channel path
+        for (const int numChannels : { 2, 8 })
+        {
+            std::vector<juce::AudioBuffer<float>> input((size_t) numBlocks);
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                input[(size_t) block].setSize(numChannels, blockSize);
+                punk_dsp::benchmark::fillTestSignal(input[(size_t) block], sampleRate, (juce::int64) block * blockSize);
+                input[(size_t) block].applyGain(2.0f);
+            }
+
+            punk_dsp::Compressor<float> off, on;
+            for (auto* compressor : { &off, &on })
+            {
+                compressor->prepare({ sampleRate, (juce::uint32) blockSize, (juce::uint32) numChannels });
+                compressor->updateThres(-24.0f);
+                compressor->updateRatio(4.0f);
+                compressor->updateKnee(6.0f);
+                compressor->updateAttack(5.0f);
+                compressor->updateRelease(100.0f);
+            }
+
+            on.updateAutoRelease(true);
+
+            juce::AudioBuffer<float> output(numChannels, blockSize);
+            const auto nsPerSample = [&](auto& processor)
+            {
+                int block = 0;
+                return punk_dsp::benchmark::nanosecondsPerCall(5, 400, [&]
+                {
+                    output.makeCopyOf(input[(size_t) (block++ % numBlocks)]);
+                    processor.process(output);
+                }) / (blockSize * numChannels);
+            };
+
+            juce::String timings = juce::String(numChannels) + " channels, ns per sample:";
+
+            if (numChannels == 2)
+            {
+                LegacyBlockCompressor legacy;
+                legacy.prepare((float) sampleRate, blockSize, numChannels);
+                legacy.setParameters(-24.0f, 4.0f, 6.0f, 5.0f, 100.0f);
+
+                // Off, auto release must leave the block path exactly as it was
+                juce::AudioBuffer<float> legacyOut(numChannels, blockSize);
+                int differences = 0;
+
+                for (int block = 0; block < numBlocks; ++block)
+                {
+                    legacyOut.makeCopyOf(input[(size_t) block]);
+                    output.makeCopyOf(input[(size_t) block]);
+                    legacy.process(legacyOut);
+                    off.process(output);
+
+                    for (int channel = 0; channel < numChannels; ++channel)
+                        for (int i = 0; i < blockSize; ++i)
+                            differences += legacyOut.getSample(channel, i) != output.getSample(channel, i) ? 1 : 0;
+                }
+
+                expectEquals(differences, 0, "Auto release off differs from the block path before it");
+                timings += " before " + juce::String(nsPerSample(legacy), 2) + ",";
+            }
+
+            timings += " off " + juce::String(nsPerSample(off), 2) + ", on " + juce::String(nsPerSample(on), 2);
+            logMessage(timings);
+        }
+    }
+
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int blockSize = 256;
+    static constexpr int numBlocks = 64;
+};
+
+static CompressorAutoReleaseBenchmark compressorAutoReleaseBenchmark;
@@ -0,0 +1,159 @@
+#include <juce_dsp/juce_dsp.h>
+#include "dsp/Dynamics/Compressor.h"
+#include "Benchmark.h"
+
+namespace
+{
+    /**
+     * Compressor::process as it was before the SIMD paths: one channel after the other, one
+     * sample at a time, with juce::Decibels on both conversions and the branchy knee and
+     * ballistics. Feed-back estimates the previous output with an extra decibelsToGain.
+     */
+    class LegacyScalarCompressor
+    {
+    public:
+        void prepare(float newSampleRate, int numChannels)
+        {
+            sampleRate = newSampleRate;
+            envelope.assign((size_t) numChannels, 0.0f);
+        }
+
+        void setParameters(float newThresdB, float ratio, float newKneedB, float attackMs, float releaseMs, bool newFeedForward)
+        {
+            thresdB = newThresdB;
+            kneedB = newKneedB;
+            compressionSlope = 1.0f - 1.0f / ratio;
+            kneeStart = thresdB - kneedB / 2.0f;
+            kneeEnd = thresdB + kneedB / 2.0f;
+            attackCoeff = std::exp(-1.f / (0.001f * attackMs * sampleRate));
+            releaseCoeff = std::exp(-1.f / (0.001f * releaseMs * sampleRate));
+            useFeedForward = newFeedForward;
+        }
+
+        void process(juce::AudioBuffer<float>& buffer)
+        {
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+            {
+                float* channelData = buffer.getWritePointer(channel);
+                float currentEnv = envelope[(size_t) channel];
+
+                for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+                {
+                    const float input = channelData[sample];
+                    float sidechainInput = input;
+
+                    if (! useFeedForward)
+                        sidechainInput = input * juce::Decibels::decibelsToGain(currentEnv + makeUpGaindB);
+
+                    const float inputDB = juce::Decibels::gainToDecibels(std::max(std::abs(sidechainInput), 0.00001f));
+
+                    float targetGR = 0.0f;
+                    if (inputDB > kneeEnd)
+                        targetGR = (inputDB - thresdB) * compressionSlope;
+                    else if (inputDB > kneeStart)
+                        targetGR = (compressionSlope / (2.0f * kneedB)) * juce::square(inputDB - kneeStart);
+
+                    const float alpha = targetGR > -currentEnv ? attackCoeff : releaseCoeff;
+                    currentEnv = -((alpha * -currentEnv) + ((1.0f - alpha) * targetGR));
+
+                    const float gainLinear = juce::Decibels::decibelsToGain(currentEnv + makeUpGaindB);
+                    channelData[sample] = (input * gainLinear * mix) + (input * (1.0f - mix));
+                }
+
+                envelope[(size_t) channel] = currentEnv;
+            }
+        }
+
+    private:
+        std::vector<float> envelope;
+
+        float sampleRate = 44100.0f, thresdB = 0.0f, kneedB = 0.0f, compressionSlope = 0.0f, kneeStart = 0.0f, kneeEnd = 0.0f;
+        float attackCoeff = 0.0f, releaseCoeff = 0.0f, makeUpGaindB = 0.0f, mix = 1.0f;
+        bool useFeedForward = true;
+    };
+}
+
+/**
+ * Cost per channel and sample of the default path (peak detector, no lookahead or key) against the
+ * scalar loop it replaced. Below a register's worth of channels the SIMD work runs across samples;
+ * from there on one channel per lane, with leftover channels (5 on SSE/NEON) going sample-wise.
+ */
+class CompressorLanesBenchmark : public juce::UnitTest
+{
+public:
+    CompressorLanesBenchmark() : juce::UnitTest("Compressor lanes", "Benchmarks") {}
+
+    void runTest() override
+    {
+        for (const bool feedForward : { true, false })
+        {
+            beginTest(juce::String(feedForward ? "Feed-forward" : "Feed-back") + ", 256-sample blocks at 48 kHz: before / after");
+
+            for (const int numChannels : { 1, 2, 5, 8, 32 })
+                measure(numChannels, feedForward);
+        }
+    }
+
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int blockSize = 256;
+    static constexpr int numBlocks = 64;
+
+    void measure(int numChannels, bool feedForward)
+    {
+        std::vector<juce::AudioBuffer<float>> input((size_t) numBlocks);
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            input[(size_t) block].setSize(numChannels, blockSize);
+            punk_dsp::benchmark::fillTestSignal(input[(size_t) block], sampleRate, (juce::int64) block * blockSize);
+            input[(size_t) block].applyGain(2.0f);
+        }
+
+        LegacyScalarCompressor legacy;
+        legacy.prepare((float) sampleRate, numChannels);
+        legacy.setParameters(-24.0f, 4.0f, 6.0f, 5.0f, 100.0f, feedForward);
+
+        punk_dsp::Compressor<float> current;
+        current.prepare({ sampleRate, (juce::uint32) blockSize, (juce::uint32) numChannels });
+        current.updateThres(-24.0f);
+        current.updateRatio(4.0f);
+        current.updateKnee(6.0f);
+        current.updateAttack(5.0f);
+        current.updateRelease(100.0f);
+        current.updateFeedForward(feedForward);
+
+        // Same settings, so the two only differ by the dB conversion error
+        juce::AudioBuffer<float> output(numChannels, blockSize), legacyOut(numChannels, blockSize);
+        float maxDifference = 0.0f;
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            legacyOut.makeCopyOf(input[(size_t) block]);
+            output.makeCopyOf(input[(size_t) block]);
+            legacy.process(legacyOut);
+            current.process(output);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                for (int i = 0; i < blockSize; ++i)
+                    maxDifference = juce::jmax(maxDifference, std::abs(legacyOut.getSample(channel, i) - output.getSample(channel, i)));
+        }
+
+        expectLessThan(maxDifference, 1.0e-4f, juce::String(numChannels) + " channels differ from the scalar loop");
+
+        const auto nsPerSample = [&](auto& processor)
+        {
+            int block = 0;
+            return punk_dsp::benchmark::nanosecondsPerCall(5, 400, [&]
+            {
+                output.makeCopyOf(input[(size_t) (block++ % numBlocks)]);
+                processor.process(output);
+            }) / (blockSize * numChannels);
+        };
+
+        const double legacyNs = nsPerSample(legacy), currentNs = nsPerSample(current);
+        logMessage(juce::String(numChannels) + " channels, ns per channel and sample: before " + juce::String(legacyNs, 2)
+                   + ", after " + juce::String(currentNs, 2) + " (" + juce::String(legacyNs / currentNs, 2) + "x)");
+    }
+};
+
+static CompressorLanesBenchmark compressorLanesBenchmark;
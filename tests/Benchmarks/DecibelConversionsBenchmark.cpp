@@ -0,0 +1,100 @@
+#include <juce_dsp/juce_dsp.h>
+#include "dsp/Dynamics/DecibelConversions.h"
+#include "Benchmark.h"
+
+/**
+ * Per-sample cost of each accuracy tier, scalar and SIMDRegister, against juce::Decibels: a block of
+ * detector levels through gainToDecibels, and a block of gain reductions through decibelsToGain.
+ */
+class DecibelConversionsBenchmark : public juce::UnitTest
+{
+public:
+    DecibelConversionsBenchmark() : juce::UnitTest("DecibelConversions", "Benchmarks") {}
+
+    void runTest() override
+    {
+        beginTest("gain <-> dB, ns per sample over 4096-sample blocks");
+
+        // Levels from the test signal, gain reductions spread over the usual compressor range
+        juce::AudioBuffer<float> levels(1, blockSize);
+        punk_dsp::benchmark::fillTestSignal(levels, 48000.0, 0);
+        juce::FloatVectorOperations::abs(levels.getWritePointer(0), levels.getReadPointer(0), blockSize);
+
+        for (int i = 0; i < blockSize; ++i)
+            reductions[(size_t) i] = -40.0f * (float) i / (float) blockSize;
+
+        const double referenceDb = perSample([&]
+        {
+            for (int i = 0; i < blockSize; ++i)
+                output[(size_t) i] = juce::Decibels::gainToDecibels(levels.getSample(0, i));
+        });
+
+        const double referenceGain = perSample([&]
+        {
+            for (int i = 0; i < blockSize; ++i)
+                output[(size_t) i] = juce::Decibels::decibelsToGain(reductions[(size_t) i]);
+        });
+
+        logMessage("juce::Decibels  gainToDecibels " + juce::String(referenceDb, 2) + " ns   decibelsToGain "
+                   + juce::String(referenceGain, 2) + " ns");
+
+        measureTier<punk_dsp::DecibelAccuracy::Reference>("Reference", levels.getReadPointer(0));
+        measureTier<punk_dsp::DecibelAccuracy::Fast>("Fast", levels.getReadPointer(0));
+        measureTier<punk_dsp::DecibelAccuracy::Balanced>("Balanced", levels.getReadPointer(0));
+        measureTier<punk_dsp::DecibelAccuracy::Precise>("Precise", levels.getReadPointer(0));
+
+        expect(std::isfinite(output[0]));
+    }
+
+private:
+    using SIMDFloat = juce::dsp::SIMDRegister<float>;
+    static constexpr int lanes = (int) SIMDFloat::SIMDNumElements;
+    static constexpr int blockSize = 4096;
+
+    template <typename Body>
+    static double perSample(Body&& body)
+    {
+        return punk_dsp::benchmark::nanosecondsPerCall(5, 200, body) / blockSize;
+    }
+
+    template <punk_dsp::DecibelAccuracy accuracy>
+    void measureTier(const juce::String& tierName, const float* levels)
+    {
+        using Conversions = punk_dsp::DecibelConversions<accuracy>;
+
+        alignas(SIMDFloat) float alignedLevels[blockSize];
+        std::copy(levels, levels + blockSize, alignedLevels);
+
+        const double scalarDb = perSample([&]
+        {
+            for (int i = 0; i < blockSize; ++i)
+                output[(size_t) i] = Conversions::gainToDecibels(alignedLevels[i]);
+        });
+
+        const double scalarGain = perSample([&]
+        {
+            for (int i = 0; i < blockSize; ++i)
+                output[(size_t) i] = Conversions::decibelsToGain(reductions[(size_t) i]);
+        });
+
+        const double simdDb = perSample([&]
+        {
+            for (int i = 0; i < blockSize; i += lanes)
+                Conversions::gainToDecibels(SIMDFloat::fromRawArray(alignedLevels + i)).copyToRawArray(output.data() + i);
+        });
+
+        const double simdGain = perSample([&]
+        {
+            for (int i = 0; i < blockSize; i += lanes)
+                Conversions::decibelsToGain(SIMDFloat::fromRawArray(reductions.data() + i)).copyToRawArray(output.data() + i);
+        });
+
+        logMessage(tierName.paddedRight(' ', 16) + "gainToDecibels " + juce::String(scalarDb, 2) + " ns (SIMD " + juce::String(simdDb, 2)
+                   + ")   decibelsToGain " + juce::String(scalarGain, 2) + " ns (SIMD " + juce::String(simdGain, 2) + ")");
+    }
+
+    alignas(SIMDFloat) std::array<float, blockSize> reductions {};
+    alignas(SIMDFloat) std::array<float, blockSize> output {};
+};
+
+static DecibelConversionsBenchmark decibelConversionsBenchmark;
@@ -0,0 +1,173 @@
+#include <juce_dsp/juce_dsp.h>
+#include "dsp/followers/PitchFollower.h"
+#include "Benchmark.h"
+
+namespace
+{
+    /**
+     * YIN as it was with the incremental difference function: every input sample slides all
+     * maxLag lags of d(lag) (four vector passes), and a detection only walks the curve. The
+     * once-a-second FFT resync against float drift is left out, which only flatters this side.
+     */
+    class LegacyIncrementalYin
+    {
+    public:
+        void prepare(double sampleRate, float minFrequency, float maxFrequency)
+        {
+            currentSampleRate = sampleRate;
+            maxLag = juce::jmax(2, (int) (sampleRate / minFrequency) + 2);
+            minLag = juce::jmax(2, (int) (sampleRate / maxFrequency));
+            lagLimit = juce::jmin((int) (sampleRate / minFrequency) + 1, maxLag - 1);
+            frameLength = 2 * maxLag + 1;
+
+            audioBuffer.assign((size_t) (2 * frameLength), 0.0f);
+            difference.assign((size_t) maxLag, 0.0f);
+            scratch.assign((size_t) maxLag, 0.0f);
+            lagCurve.assign((size_t) (maxLag + 2), 0.0f);
+            writePosition = 0;
+        }
+
+        void process(const float* samples, int numSamples, int hop)
+        {
+            for (int sample = 0; sample < numSamples; ++sample)
+            {
+                audioBuffer[(size_t) writePosition] = samples[sample];
+                audioBuffer[(size_t) (writePosition + frameLength)] = samples[sample];
+                updateDifference(writePosition + frameLength);
+
+                if (++writePosition == frameLength)
+                    writePosition = 0;
+
+                if (hop > 0 && ++samplesSinceAnalysis >= hop)
+                {
+                    detect();
+                    samplesSinceAnalysis = 0;
+                }
+            }
+
+            if (hop == 0)
+                detect();
+        }
+
+        float getCurrentFrequency() const { return frequency; }
+
+    private:
+        void updateDifference(int newestIndex)
+        {
+            const float newest = audioBuffer[(size_t) newestIndex];
+            const float leaving = audioBuffer[(size_t) (newestIndex - maxLag)];
+
+            juce::FloatVectorOperations::add(scratch.data(), audioBuffer.data() + newestIndex - maxLag, -newest, maxLag);
+            juce::FloatVectorOperations::addWithMultiply(difference.data(), scratch.data(), scratch.data(), maxLag);
+
+            juce::FloatVectorOperations::add(scratch.data(), audioBuffer.data() + newestIndex - 2 * maxLag, -leaving, maxLag);
+            juce::FloatVectorOperations::subtractWithMultiply(difference.data(), scratch.data(), scratch.data(), maxLag);
+        }
+
+        void detect()
+        {
+            lagCurve[0] = 1.0f;
+            double runningSum = 0.0;
+
+            for (int lag = 1; lag <= lagLimit; ++lag)
+            {
+                const float d = juce::jmax(0.0f, difference[(size_t) (maxLag - lag)]);
+                runningSum += d;
+                lagCurve[(size_t) lag] = runningSum > 1e-12 ? (float) (d * lag / runningSum) : 1.0f;
+            }
+
+            frequency = 0.0f;
+
+            for (int lag = minLag; lag < lagLimit; ++lag)
+            {
+                if (lagCurve[(size_t) lag] < 0.15f)
+                {
+                    while (lag + 1 < lagLimit && lagCurve[(size_t) (lag + 1)] < lagCurve[(size_t) lag])
+                        ++lag;
+
+                    const float left = lagCurve[(size_t) (lag - 1)], centre = lagCurve[(size_t) lag], right = lagCurve[(size_t) (lag + 1)];
+                    const float curvature = left - 2.0f * centre + right;
+                    const float offset = curvature > 0.0f ? juce::jlimit(-0.5f, 0.5f, 0.5f * (left - right) / curvature) : 0.0f;
+
+                    frequency = (float) (currentSampleRate / (lag + offset));
+                    return;
+                }
+            }
+        }
+
+        double currentSampleRate = 48000.0;
+        int maxLag = 0, minLag = 0, lagLimit = 0, frameLength = 0, writePosition = 0, samplesSinceAnalysis = 0;
+        std::vector<float> audioBuffer, difference, scratch, lagCurve;
+        float frequency = 0.0f;
+    };
+}
+
+class PitchFollowerBenchmark : public juce::UnitTest
+{
+public:
+    PitchFollowerBenchmark() : juce::UnitTest("PitchFollower", "Benchmarks") {}
+
+    void runTest() override
+    {
+        // One analysis per 512-sample block, and 64-sample blocks analysed every 512 samples
+        measure(512, 0);
+        measure(64, 512);
+    }
+
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int numSamples = 16384;
+
+    void measure(int blockSize, int hop)
+    {
+        beginTest("YIN, 40 Hz floor at 48 kHz, " + juce::String(blockSize) + "-sample blocks, "
+                  + (hop > 0 ? "hop " + juce::String(hop) : juce::String("hop = block")) + ": before / after");
+
+        // A 110 Hz chord with a little noise, mono
+        juce::AudioBuffer<float> input(1, numSamples);
+        punk_dsp::benchmark::fillTestSignal(input, sampleRate, 0);
+
+        LegacyIncrementalYin legacy;
+        legacy.prepare(sampleRate, 40.0f, 2000.0f);
+
+        punk_dsp::PitchFollower current;
+        current.setAlgorithm(punk_dsp::PitchFollower::Algorithm::YIN);
+        current.setAnalysisHop(hop);
+        current.prepare({ sampleRate, (juce::uint32) blockSize, 1 });
+
+        juce::AudioBuffer<float> block(1, blockSize);
+        const int numBlocks = numSamples / blockSize;
+
+        // Both see the same history, so both must report the same pitch
+        for (int i = 0; i < numBlocks; ++i)
+        {
+            block.copyFrom(0, 0, input, 0, i * blockSize, blockSize);
+            legacy.process(block.getReadPointer(0), blockSize, hop);
+            current.processBlock(block);
+        }
+
+        const float legacyFrequency = legacy.getCurrentFrequency(), currentFrequency = current.getCurrentFrequency();
+        expectWithinAbsoluteError(currentFrequency, legacyFrequency, 0.01f, "Current and legacy YIN disagree");
+        expectWithinAbsoluteError(currentFrequency, 110.0f, 0.5f, "Wrong pitch");
+
+        int legacyBlock = 0, currentBlock = 0;
+
+        const double legacyNs = punk_dsp::benchmark::nanosecondsPerCall(5, 2 * numBlocks, [&]
+        {
+            legacy.process(input.getReadPointer(0, (legacyBlock++ % numBlocks) * blockSize), blockSize, hop);
+        });
+
+        const double currentNs = punk_dsp::benchmark::nanosecondsPerCall(5, 2 * numBlocks, [&]
+        {
+            block.copyFrom(0, 0, input, 0, (currentBlock++ % numBlocks) * blockSize, blockSize);
+            current.processBlock(block);
+        });
+
+        logMessage("before (per-sample difference update): " + juce::String(legacyNs / 1000.0, 1) + " us per block");
+        logMessage("after  (FFT per analysis):              " + juce::String(currentNs / 1000.0, 1) + " us per block ("
+                   + juce::String(legacyNs / currentNs, 2) + "x)");
+        logMessage("pitch: before " + juce::String(legacyFrequency, 3) + " Hz, after " + juce::String(currentFrequency, 3) + " Hz");
+    }
+};
+
+static PitchFollowerBenchmark pitchFollowerBenchmark;
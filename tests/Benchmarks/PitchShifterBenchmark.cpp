@@ -0,0 +1,214 @@
+#include <juce_dsp/juce_dsp.h>
+#include "dsp/Pitch/PitchShifter.h"
+#include "Benchmark.h"
+
+namespace
+{
+    /**
+     * The granular loop as it was before the power-of-two rings and fixed-point grain phases:
+     * modulo / while-loop wrapping, double read positions and an interpolated Hann lookup, with
+     * the old prepare() sizes. Constant ratio and mix, which is where both versions agree.
+     */
+    class LegacyGranularShifter
+    {
+    public:
+        void prepare(double sampleRate, int maxBlockSize, int numChannels)
+        {
+            windowSize = juce::jlimit(64, 8192, (int) std::round(sampleRate * 0.040));
+            hopSize = juce::jmax(1, (int) std::round(windowSize * 0.5));
+            retriggerDelay = windowSize;
+            delayBufferSize = juce::jmax(4 * windowSize, maxBlockSize * 4);
+            latencySamples = windowSize;
+
+            hannTable.resize((size_t) windowSize + 1);
+            for (int n = 0; n <= windowSize; ++n)
+                hannTable[(size_t) n] = (float) (0.5 - 0.5 * std::cos(juce::MathConstants<double>::twoPi * n / windowSize));
+
+            channels.resize((size_t) numChannels);
+            for (auto& ch : channels)
+            {
+                ch.delay.assign((size_t) delayBufferSize, 0.0f);
+                ch.dry.assign((size_t) juce::jmax(latencySamples + maxBlockSize, 2 * maxBlockSize), 0.0f);
+            }
+        }
+
+        void process(juce::AudioBuffer<float>& buffer, double ratio, float mix)
+        {
+            const float dryGain = 1.0f - mix;
+
+            for (auto& ch : channels)
+            {
+                if (ch.g1.pos == 0.0 && ch.g1.startIndex == 0)
+                    retrigger(ch, ch.g1, retriggerDelay);
+                if (ch.g2.pos == 0.0 && ch.g2.startIndex == 0)
+                    retrigger(ch, ch.g2, retriggerDelay + hopSize);
+            }
+
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+            {
+                auto& ch = channels[(size_t) channel];
+                float* data = buffer.getWritePointer(channel);
+                const int drySize = (int) ch.dry.size();
+
+                for (int n = 0; n < buffer.getNumSamples(); ++n)
+                {
+                    ch.delay[(size_t) ch.writeIndex] = data[n];
+                    ch.dry[(size_t) ch.dryWriteIndex] = data[n];
+
+                    int dryReadIndex = ch.dryWriteIndex - latencySamples;
+                    while (dryReadIndex < 0) dryReadIndex += drySize;
+                    dryReadIndex %= drySize;
+                    const float drySample = ch.dry[(size_t) dryReadIndex];
+
+                    const float wetSample = readGrain(ch, ch.g1, ratio) + readGrain(ch, ch.g2, ratio);
+
+                    ch.g1.pos += 1.0;
+                    ch.g2.pos += 1.0;
+
+                    if (ch.g1.pos >= (double) windowSize)
+                        retrigger(ch, ch.g1, retriggerDelay);
+                    if (ch.g2.pos >= (double) windowSize)
+                        retrigger(ch, ch.g2, retriggerDelay + hopSize);
+
+                    data[n] = dryGain * drySample + mix * wetSample;
+
+                    ch.writeIndex = (ch.writeIndex + 1) % delayBufferSize;
+                    ch.dryWriteIndex = (ch.dryWriteIndex + 1) % drySize;
+                }
+            }
+        }
+
+    private:
+        struct Grain
+        {
+            double pos = 0.0;
+            int startIndex = 0;
+        };
+
+        struct Channel
+        {
+            std::vector<float> delay, dry;
+            int writeIndex = 0, dryWriteIndex = 0;
+            Grain g1, g2;
+        };
+
+        void retrigger(Channel& ch, Grain& g, int delaySamples) const
+        {
+            int start = ch.writeIndex - delaySamples;
+            while (start < 0) start += delayBufferSize;
+            g.startIndex = start % delayBufferSize;
+            g.pos = 0.0;
+        }
+
+        float hannAt(double x01) const
+        {
+            if (x01 <= 0.0 || x01 >= 1.0)
+                return 0.0f;
+
+            const double index = x01 * (double) windowSize;
+            const int i = (int) index;
+            const float a = hannTable[(size_t) juce::jlimit(0, windowSize, i)];
+            const float b = hannTable[(size_t) juce::jlimit(0, windowSize, i + 1)];
+            return a + (float) (index - i) * (b - a);
+        }
+
+        float readGrain(const Channel& ch, const Grain& g, double ratio) const
+        {
+            double readIndex = (double) g.startIndex + g.pos * ratio;
+            while (readIndex >= delayBufferSize) readIndex -= delayBufferSize;
+            while (readIndex < 0.0) readIndex += delayBufferSize;
+
+            const int i0 = (int) std::floor(readIndex);
+            const int i1 = (i0 + 1) % delayBufferSize;
+            const float frac = (float) (readIndex - i0);
+            const float s0 = ch.delay[(size_t) i0];
+            const float sample = s0 + frac * (ch.delay[(size_t) i1] - s0);
+
+            return sample * hannAt(g.pos / (double) windowSize);
+        }
+
+        int windowSize = 0, hopSize = 0, retriggerDelay = 0, delayBufferSize = 0, latencySamples = 0;
+        std::vector<float> hannTable;
+        std::vector<Channel> channels;
+    };
+}
+
+class PitchShifterBenchmark : public juce::UnitTest
+{
+public:
+    PitchShifterBenchmark() : juce::UnitTest("PitchShifter", "Benchmarks") {}
+
+    void runTest() override
+    {
+        constexpr double sampleRate = 48000.0;
+        constexpr int blockSize = 256;
+        constexpr int numChannels = 16;
+        constexpr int numBlocks = 64;
+        const double ratio = std::pow(2.0, 7.0 / 12.0);
+
+        beginTest("Granular, 16 channels x 256 samples at 48 kHz, +7 semitones: before / after");
+
+        // The same input blocks for both, generated up front
+        std::vector<juce::AudioBuffer<float>> input((size_t) numBlocks);
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            input[(size_t) block].setSize(numChannels, blockSize);
+            punk_dsp::benchmark::fillTestSignal(input[(size_t) block], sampleRate, (juce::int64) block * blockSize);
+        }
+
+        juce::AudioBuffer<float> legacyOut(numChannels, blockSize), currentOut(numChannels, blockSize);
+
+        LegacyGranularShifter legacy;
+        legacy.prepare(sampleRate, blockSize, numChannels);
+
+        punk_dsp::PitchShifter current;
+        current.prepare(sampleRate, blockSize, numChannels);
+        current.setPitchRatio(ratio);
+        current.setSmoothingTimeMs(5.0);
+
+        // Let the ratio settle and clear the history: from there both must produce the same signal
+        for (int block = 0; block < 8; ++block)
+        {
+            currentOut.makeCopyOf(input[(size_t) block]);
+            current.process(currentOut);
+        }
+
+        current.reset();
+
+        float maxDifference = 0.0f;
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            legacyOut.makeCopyOf(input[(size_t) block]);
+            currentOut.makeCopyOf(input[(size_t) block]);
+            legacy.process(legacyOut, ratio, 1.0f);
+            current.process(currentOut);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+                for (int i = 0; i < blockSize; ++i)
+                    maxDifference = juce::jmax(maxDifference, std::abs(legacyOut.getSample(channel, i) - currentOut.getSample(channel, i)));
+        }
+
+        expectLessThan(maxDifference, 1.0e-4f, "Current and legacy granular output differ");
+
+        int legacyBlock = 0, currentBlock = 0;
+
+        const double legacyNs = punk_dsp::benchmark::nanosecondsPerCall(5, 200, [&]
+        {
+            legacyOut.makeCopyOf(input[(size_t) (legacyBlock++ % numBlocks)]);
+            legacy.process(legacyOut, ratio, 1.0f);
+        });
+
+        const double currentNs = punk_dsp::benchmark::nanosecondsPerCall(5, 200, [&]
+        {
+            currentOut.makeCopyOf(input[(size_t) (currentBlock++ % numBlocks)]);
+            current.process(currentOut);
+        });
+
+        logMessage("before (modulo rings, double phases): " + juce::String(legacyNs / 1000.0, 1) + " us per block");
+        logMessage("after  (power-of-two rings, 32.32):   " + juce::String(currentNs / 1000.0, 1) + " us per block ("
+                   + juce::String(legacyNs / currentNs, 2) + "x)");
+        logMessage("max |before - after| = " + juce::String(maxDifference, 8));
+    }
+};
+
+static PitchShifterBenchmark pitchShifterBenchmark;
@@ -0,0 +1,154 @@
+#include <juce_dsp/juce_dsp.h>
+#include "dsp/Distortion/Waveshaper.h"
+#include "dsp/Distortion/Oversampled.h"
+#include "Benchmark.h"
+
+namespace
+{
+    using Shaper = punk_dsp::Waveshaper<float>;
+
+    // One clipper, picked at compile time so the oversampled kernel has no dispatch in it
+    template <punk_dsp::ClipperType clipper>
+    float shape(Shaper& shaper, int channel, float x)
+    {
+        if constexpr (clipper == punk_dsp::ClipperType::Soft)
+            return shaper.applySoftClipper(channel, x);
+        else if constexpr (clipper == punk_dsp::ClipperType::Hard)
+            return shaper.applyHardClipper(channel, x);
+        else if constexpr (clipper == punk_dsp::ClipperType::Tanh)
+            return shaper.applyTanhClipper(channel, x);
+        else
+            return shaper.applyATanClipper(channel, x);
+    }
+}
+
+/**
+ * Waveshaper ADAA against oversampling, per clipper: CPU per sample and aliasing (power outside the
+ * harmonics over the harmonics) of a 4.7 kHz sine at 48 kHz, stereo 512-sample blocks. Plain, ADAA1
+ * and ADAA2 at the host rate; 2x and 4x IIR Oversampled without ADAA; ADAA1 inside 2x Oversampled.
+ * Tanh runs at drive 5, where its fast approximation still holds, the others at drive 10.
+ */
+class WaveshaperAdaaBenchmark : public juce::UnitTest
+{
+public:
+    WaveshaperAdaaBenchmark() : juce::UnitTest("Waveshaper ADAA", "Benchmarks") {}
+
+    void runTest() override
+    {
+        measure<punk_dsp::ClipperType::Soft>("Soft");
+        measure<punk_dsp::ClipperType::Hard>("Hard");
+        measure<punk_dsp::ClipperType::Tanh>("Tanh");
+        measure<punk_dsp::ClipperType::ATan>("ATan");
+    }
+
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int blockSize = 512;
+    static constexpr int order = 13, size = 1 << order, bin = 805;     // 4717 Hz, on an exact bin
+    static constexpr int numChannels = 2;
+
+    struct Setting
+    {
+        const char* name;
+        int factor;                     // 1 = host rate
+        punk_dsp::ADAAOrder adaa;
+    };
+
+    static void fillSine(juce::AudioBuffer<float>& buffer)
+    {
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                buffer.setSample(channel, i, (float) std::sin(juce::MathConstants<double>::twoPi * bin * i / size));
+    }
+
+    static double aliasingToHarmonicsDb(const juce::AudioBuffer<float>& buffer)
+    {
+        std::vector<float> spectrum((size_t) (2 * size), 0.0f);
+        std::copy(buffer.getReadPointer(0), buffer.getReadPointer(0) + size, spectrum.begin());
+        juce::dsp::FFT(order).performRealOnlyForwardTransform(spectrum.data(), true);
+
+        double harmonics = 0.0, aliasing = 0.0;
+
+        for (int k = 1; k <= size / 2; ++k)
+        {
+            const double power = juce::square((double) spectrum[(size_t) (2 * k)]) + juce::square((double) spectrum[(size_t) (2 * k + 1)]);
+            (k % bin == 0 ? harmonics : aliasing) += power;
+        }
+
+        return 10.0 * std::log10(aliasing / harmonics);
+    }
+
+    template <punk_dsp::ClipperType clipper>
+    void measure(const juce::String& clipperName)
+    {
+        const float drive = clipper == punk_dsp::ClipperType::Tanh ? 5.0f : 10.0f;
+        beginTest(clipperName + " at drive " + juce::String((int) drive) + ": ADAA against IIR oversampling");
+
+        static constexpr Setting settings[] = { { "plain", 1, punk_dsp::ADAAOrder::Off },
+                                                { "ADAA1", 1, punk_dsp::ADAAOrder::FirstOrder },
+                                                { "ADAA2", 1, punk_dsp::ADAAOrder::SecondOrder },
+                                                { "2x", 2, punk_dsp::ADAAOrder::Off },
+                                                { "4x", 4, punk_dsp::ADAAOrder::Off },
+                                                { "ADAA1 in 2x", 2, punk_dsp::ADAAOrder::FirstOrder } };
+
+        const auto kernel = [](Shaper& shaper, int channel, float x) { return shape<clipper>(shaper, channel, x); };
+        double plainAliasingDb = 0.0;
+
+        juce::AudioBuffer<float> sine(numChannels, size);
+        fillSine(sine);
+
+        for (const auto& setting : settings)
+        {
+            punk_dsp::Oversampled<Shaper> oversampled;
+            oversampled.setFactor(juce::jmax(2, setting.factor));
+            oversampled.prepare({ sampleRate, (juce::uint32) size, (juce::uint32) numChannels });
+
+            Shaper& shaper = oversampled.getProcessor();
+            shaper.setClipper(clipper);
+            shaper.setDrive(drive);
+            shaper.setADAAOrder(setting.adaa);
+            shaper.prepare({ sampleRate * setting.factor, (juce::uint32) (size * setting.factor), (juce::uint32) numChannels });
+
+            const auto run = [&](juce::AudioBuffer<float>& buffer)
+            {
+                if (setting.factor == 1)
+                    shaper.process(buffer);
+                else
+                    oversampled.process(buffer, kernel);
+            };
+
+            // Aliasing: two periods of the whole window, the first settles filters and ADAA state
+            juce::AudioBuffer<float> window(numChannels, size);
+
+            for (int pass = 0; pass < 2; ++pass)
+            {
+                window.makeCopyOf(sine);
+                run(window);
+            }
+
+            const double aliasingDb = aliasingToHarmonicsDb(window);
+            if (setting.factor == 1 && setting.adaa == punk_dsp::ADAAOrder::Off)
+                plainAliasingDb = aliasingDb;
+
+            expectLessOrEqual(aliasingDb, plainAliasingDb + 0.1, juce::String(setting.name) + " aliases more than the plain clipper");
+
+            // CPU: 512-sample blocks out of the same sine
+            juce::AudioBuffer<float> block(numChannels, blockSize);
+            int start = 0;
+
+            const double ns = punk_dsp::benchmark::nanosecondsPerCall(5, 200, [&]
+            {
+                for (int channel = 0; channel < numChannels; ++channel)
+                    block.copyFrom(channel, 0, sine, channel, start, blockSize);
+
+                run(block);
+                start = (start + blockSize) % size;
+            }) / (blockSize * numChannels);
+
+            logMessage(juce::String(setting.name).paddedRight(' ', 12) + juce::String(ns, 2) + " ns per sample, aliasing "
+                       + juce::String(aliasingDb, 1) + " dB");
+        }
+    }
+};
+
+static WaveshaperAdaaBenchmark waveshaperAdaaBenchmark;
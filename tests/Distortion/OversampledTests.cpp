@@ -0,0 +1,143 @@
+#include <juce_dsp/juce_dsp.h>
+#include "dsp/Distortion/Oversampled.h"
+#include "dsp/Distortion/Waveshaper.h"
+
+namespace
+{
+    // Oversampled only needs a Processor<SampleType> to hand to the kernel
+    template <typename SampleType>
+    struct PassThrough {};
+}
+
+/**
+ * setFactor() / setFilter() after prepare(): every layout must run exactly as if it had been set
+ * before prepare(), with the same latency.
+ *
+ * A kernel taking the channel runs each channel on its own state: a stereo Waveshaper with ADAA
+ * inside Oversampled must give, channel for channel, what two mono instances give.
+ */
+class OversampledTests : public juce::UnitTest
+{
+public:
+    OversampledTests() : juce::UnitTest("Oversampled", "Distortion") {}
+
+    void runTest() override
+    {
+        for (const auto filter : { punk_dsp::OversamplingFilter::IIR, punk_dsp::OversamplingFilter::FIR })
+        {
+            for (const int factor : { 2, 4, 8 })
+            {
+                beginTest(juce::String(factor) + "x " + (filter == punk_dsp::OversamplingFilter::IIR ? "IIR" : "FIR")
+                          + " switched to after prepare()");
+
+                Shaper before, after;
+                before.setFactor(factor);
+                before.setFilter(filter);
+                before.prepare({ sampleRate, (juce::uint32) blockSize, 2 });
+
+                // Prepared for another factor and the other filter, then switched, with a block run in between
+                after.setFactor(factor == 8 ? 2 : 8);
+                after.setFilter(filter == punk_dsp::OversamplingFilter::IIR ? punk_dsp::OversamplingFilter::FIR
+                                                                           : punk_dsp::OversamplingFilter::IIR);
+                after.prepare({ sampleRate, (juce::uint32) blockSize, 2 });
+                juce::AudioBuffer<float> warmUp(2, blockSize);
+                fill(warmUp, 0);
+                after.process(warmUp, kernel);
+                after.setFactor(factor);
+                after.setFilter(filter);
+
+                expectEquals(after.getFactor(), factor);
+                expectEquals(after.getLatencySamples(), before.getLatencySamples());
+
+                juce::AudioBuffer<float> expected(2, blockSize), output(2, blockSize);
+                int differences = 0;
+
+                for (int block = 0; block < 16; ++block)
+                {
+                    fill(expected, block * blockSize);
+                    output.makeCopyOf(expected);
+                    before.process(expected, kernel);
+                    after.process(output, kernel);
+
+                    for (int channel = 0; channel < 2; ++channel)
+                        for (int i = 0; i < blockSize; ++i)
+                            differences += expected.getSample(channel, i) != output.getSample(channel, i) ? 1 : 0;
+                }
+
+                expectEquals(differences, 0);
+            }
+        }
+
+        for (const auto order : { punk_dsp::ADAAOrder::FirstOrder, punk_dsp::ADAAOrder::SecondOrder })
+            for (const int factor : { 2, 4 })
+                checkStereoAdaa(order, factor);
+    }
+
+private:
+    using Shaper = punk_dsp::Oversampled<PassThrough<float>>;
+
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int blockSize = 256;
+
+    static float kernel(PassThrough<float>&, float x) { return std::tanh(4.0f * x); }
+
+    using AdaaShaper = punk_dsp::Oversampled<punk_dsp::Waveshaper<float>>;
+
+    static void prepareAdaa(AdaaShaper& shaper, punk_dsp::ADAAOrder order, int factor, int numChannels)
+    {
+        shaper.setFactor(factor);
+        shaper.prepare({ sampleRate, (juce::uint32) blockSize, (juce::uint32) numChannels });
+        shaper.getProcessor().setDrive(6.0f);
+        shaper.getProcessor().setADAAOrder(order);
+        shaper.getProcessor().prepare({ sampleRate * factor, (juce::uint32) (blockSize * factor), (juce::uint32) numChannels });
+    }
+
+    void checkStereoAdaa(punk_dsp::ADAAOrder order, int factor)
+    {
+        beginTest(juce::String(order == punk_dsp::ADAAOrder::FirstOrder ? "ADAA1" : "ADAA2") + " Waveshaper in "
+                  + juce::String(factor) + "x Oversampled: each channel on its own ADAA state");
+
+        const auto adaaKernel = [](auto& shaper, int channel, float x) { return shaper.applyTanhClipper(channel, x); };
+
+        AdaaShaper stereo;
+        std::array<AdaaShaper, 2> mono;
+        prepareAdaa(stereo, order, factor, 2);
+        prepareAdaa(mono[0], order, factor, 1);
+        prepareAdaa(mono[1], order, factor, 1);
+
+        juce::AudioBuffer<float> both(2, blockSize), single(1, blockSize);
+        int differences = 0;
+
+        for (int block = 0; block < 16; ++block)
+        {
+            fill(both, block * blockSize);
+
+            for (int channel = 0; channel < 2; ++channel)
+            {
+                single.copyFrom(0, 0, both, channel, 0, blockSize);
+                mono[(size_t) channel].process(single, adaaKernel);
+                both.copyFrom(channel, 0, single, 0, 0, blockSize);
+            }
+
+            juce::AudioBuffer<float> output(2, blockSize);
+            fill(output, block * blockSize);
+            stereo.process(output, adaaKernel);
+
+            for (int channel = 0; channel < 2; ++channel)
+                for (int i = 0; i < blockSize; ++i)
+                    differences += output.getSample(channel, i) != both.getSample(channel, i) ? 1 : 0;
+        }
+
+        expectEquals(differences, 0, "Stereo run differs from two mono runs");
+    }
+
+    static void fill(juce::AudioBuffer<float>& buffer, int startSample)
+    {
+        for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                buffer.setSample(channel, i, 0.5f * (float) std::sin(juce::MathConstants<double>::twoPi * 1000.0 * (1 + channel)
+                                                                     * (startSample + i) / sampleRate));
+    }
+};
+
+static OversampledTests oversampledTests;
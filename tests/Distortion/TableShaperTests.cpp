@@ -0,0 +1,65 @@
+#include <juce_dsp/juce_dsp.h>
+#include "dsp/Distortion/TableShaper.h"
+
+/**
+ * TableShaper lookups: inside the input range the cubic table follows the curve closely, beyond it
+ * the edge values hold, and inputs that are not numbers (NaN, infinities, huge values) must still
+ * land in the table: they come out as an edge value, never as a read outside it.
+ */
+class TableShaperTests : public juce::UnitTest
+{
+public:
+    TableShaperTests() : juce::UnitTest("TableShaper", "Distortion") {}
+
+    void runTest() override
+    {
+        checkLookups<float>("float");
+        checkLookups<double>("double");
+    }
+
+private:
+    static double curve(double x) { return std::atan(3.0 * x) * 2.0 / juce::MathConstants<double>::pi; }
+
+    template <typename SampleType>
+    void checkLookups(const juce::String& typeName)
+    {
+        punk_dsp::TableShaper<SampleType> shaper;
+        shaper.setCurve(curve);
+        shaper.setInputRange(2.0f);
+
+        juce::AudioBuffer<SampleType> buffer(1, 1);
+        shaper.processBuffer(buffer);   // Picks up the table
+
+        beginTest(typeName + ": the table follows the curve inside the range");
+
+        double maxError = 0.0;
+        for (int i = 0; i <= 400; ++i)
+        {
+            const double x = -2.0 + 4.0 * i / 400.0;
+            maxError = juce::jmax(maxError, std::abs((double) shaper.processSample((SampleType) x) - curve(x)));
+        }
+
+        expectLessThan(maxError, 1.0e-5, "Largest interpolation error");
+
+        beginTest(typeName + ": out-of-range and non-finite inputs read an edge of the table");
+
+        const auto lowEdge = shaper.processSample((SampleType) -2), highEdge = shaper.processSample((SampleType) 2);
+        const auto nan = std::numeric_limits<SampleType>::quiet_NaN();
+        const auto infinity = std::numeric_limits<SampleType>::infinity();
+        const auto largest = std::numeric_limits<SampleType>::max();
+
+        expectEquals(shaper.processSample((SampleType) 5), highEdge, "Above the range");
+        expectEquals(shaper.processSample((SampleType) -5), lowEdge, "Below the range");
+        expectEquals(shaper.processSample(largest), highEdge, "Largest finite input");
+        expectEquals(shaper.processSample(-largest), lowEdge, "Lowest finite input");
+        expectEquals(shaper.processSample(infinity), highEdge, "+inf");
+        expectEquals(shaper.processSample(-infinity), lowEdge, "-inf");
+        expectEquals(shaper.processSample(nan), lowEdge, "NaN");
+
+        buffer.setSample(0, 0, nan);
+        shaper.processBuffer(buffer);
+        expectEquals(buffer.getSample(0, 0), lowEdge, "NaN through processBuffer");
+    }
+};
+
+static TableShaperTests tableShaperTests;
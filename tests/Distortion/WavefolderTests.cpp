@@ -0,0 +1,192 @@
+#include <juce_dsp/juce_dsp.h>
+#include "dsp/Distortion/Wavefolder.h"
+
+namespace
+{
+    // The fold as it was written before the closed form: reflect about +-threshold until in range
+    double reflectInLoop(double x, double threshold)
+    {
+        while (std::abs(x) > threshold)
+            x = x > threshold ? 2.0 * threshold - x : -2.0 * threshold - x;
+
+        return x;
+    }
+
+    // The same reflection for any drive: fmod is exact, so this is the loop without the iterations
+    double reflect(double x, double threshold)
+    {
+        if (std::abs(x) <= threshold)
+            return x;
+
+        double phase = std::fmod(x + threshold, 4.0 * threshold);
+        if (phase < 0.0)
+            phase += 4.0 * threshold;
+
+        return phase < 2.0 * threshold ? phase - threshold : 3.0 * threshold - phase;
+    }
+}
+
+/**
+ * Wavefolder fold to range against the reflective fold it replaced: drive up to 1e6, thresholds
+ * of 0 and below, and foldToRangeBuffer()'s scalar head / tail against its SIMD body.
+ */
+class WavefolderTests : public juce::UnitTest
+{
+public:
+    WavefolderTests() : juce::UnitTest("Wavefolder", "Distortion") {}
+
+    void runTest() override
+    {
+        beginTest("Reflection without the loop matches the loop");
+        {
+            double maxError = 0.0;
+            for (int i = 0; i <= 20000; ++i)
+            {
+                const double x = -150.0 + 300.0 * i / 20000.0;
+                maxError = juce::jmax(maxError, std::abs(reflect(x, 0.6) - reflectInLoop(x, 0.6)));
+            }
+
+            expectLessThan(maxError, 1.0e-12);
+        }
+
+        checkAgainstReflection<float>("float");
+        checkAgainstReflection<double>("double");
+
+        checkDegenerateThresholds<float>("float");
+        checkDegenerateThresholds<double>("double");
+
+        checkBufferAgainstSamples<float>("float");
+        checkBufferAgainstSamples<double>("double");
+    }
+
+private:
+    static constexpr double maxFoldPhase = 4194304.0;   // 2^22, where Wavefolder.cpp caps the phase
+
+    template <typename SampleType>
+    static std::vector<SampleType> testInput()
+    {
+        juce::Random random(25);
+        std::vector<SampleType> input(4099);
+
+        for (auto& sample : input)
+            sample = (SampleType) (2.0 * random.nextDouble() - 1.0);
+
+        return input;
+    }
+
+    template <typename SampleType>
+    void checkAgainstReflection(const juce::String& type)
+    {
+        const auto input = testInput<SampleType>();
+        const double eps = std::numeric_limits<SampleType>::epsilon();
+
+        for (const float threshold : { 0.6f, 0.1f, 1.0f })
+        {
+            beginTest(type + ", threshold " + juce::String(threshold, 1) + ": against the reflective fold, drive 0.5 to 1e6");
+
+            for (const float drive : { 0.5f, 3.0f, 100.0f, 1.0e4f, 1.0e6f })
+            {
+                punk_dsp::Wavefolder<SampleType> folder;
+                folder.setDrive(drive);
+                folder.setThreshold(threshold);
+
+                double maxExcess = 0.0, maxMagnitude = 0.0;
+
+                for (const SampleType sample : input)
+                {
+                    // The driven value as the folder computes it (no bias), then folded exactly
+                    const SampleType driven = drive * sample;
+                    const double folded = folder.foldToRangeSample(sample);
+                    maxMagnitude = juce::jmax(maxMagnitude, std::abs(folded));
+
+                    if (std::abs((double) driven + threshold) / (4.0 * threshold) >= maxFoldPhase)
+                        continue;
+
+                    // The fold has slope +-1: rounding the phase costs an ulp or two of the driven value
+                    const double expected = reflect((double) driven, (double) threshold);
+                    const double bound = 2.0 * eps * (std::abs((double) driven) + threshold);
+                    maxExcess = juce::jmax(maxExcess, std::abs(folded - expected) - bound);
+                }
+
+                expectLessOrEqual(maxExcess, 0.0, "Drive " + juce::String(drive));
+                expectLessOrEqual(maxMagnitude, (double) threshold, "Output out of range at drive " + juce::String(drive));
+            }
+        }
+    }
+
+    template <typename SampleType>
+    void checkDegenerateThresholds(const juce::String& type)
+    {
+        const auto input = testInput<SampleType>();
+
+        beginTest(type + ": threshold 0 folds to silence, a negative threshold folds as its magnitude");
+
+        for (const float drive : { 1.0f, 1.0e3f, 1.0e6f, 3.0e38f })
+        {
+            punk_dsp::Wavefolder<SampleType> silent, negative, positive;
+
+            for (auto* folder : { &silent, &negative, &positive })
+                folder->setDrive(drive);
+
+            silent.setThreshold(0.0f);
+            negative.setThreshold(-0.4f);
+            positive.setThreshold(0.4f);
+
+            double maxSilent = 0.0;
+            int differences = 0, nonFinite = 0;
+
+            for (const SampleType sample : input)
+            {
+                const SampleType folded = silent.foldToRangeSample(sample);
+                nonFinite += std::isfinite(folded) ? 0 : 1;
+                maxSilent = juce::jmax(maxSilent, std::abs((double) folded));
+                differences += negative.foldToRangeSample(sample) != positive.foldToRangeSample(sample) ? 1 : 0;
+            }
+
+            expectEquals(nonFinite, 0, "Drive " + juce::String(drive));
+            expectLessOrEqual(maxSilent, 1.0e-6, "Threshold 0 at drive " + juce::String(drive));
+            expectEquals(differences, 0, "Threshold -0.4 against 0.4 at drive " + juce::String(drive));
+        }
+    }
+
+    template <typename SampleType>
+    void checkBufferAgainstSamples(const juce::String& type)
+    {
+        beginTest(type + ": foldToRangeBuffer() against foldToRangeSample(), every misalignment and length");
+
+        const auto input = testInput<SampleType>();
+        constexpr int maxLength = 67;
+        constexpr int maxOffset = 8;
+
+        punk_dsp::Wavefolder<SampleType> folder;
+        folder.setDrive(7.0f);
+        folder.setThreshold(0.35f);
+        folder.setBiasPre(0.1f);
+        folder.setBiasPost(-0.05f);
+        folder.setMix(0.8f);
+        folder.setOutGain(0.9f);
+
+        // Starting offsets move the scalar head through every length a register allows
+        std::vector<SampleType> storage((size_t) (maxLength + maxOffset));
+        int differences = 0;
+
+        for (int offset = 0; offset < maxOffset; ++offset)
+        {
+            for (int length = 0; length <= maxLength; ++length)
+            {
+                SampleType* data = storage.data() + offset;
+                std::copy(input.begin(), input.begin() + length, data);
+
+                juce::AudioBuffer<SampleType> buffer(&data, 1, length);
+                folder.foldToRangeBuffer(buffer);
+
+                for (int i = 0; i < length; ++i)
+                    differences += data[i] != folder.foldToRangeSample(input[(size_t) i]) ? 1 : 0;
+            }
+        }
+
+        expectEquals(differences, 0);
+    }
+};
+
+static WavefolderTests wavefolderTests;
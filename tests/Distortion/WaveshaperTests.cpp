@@ -0,0 +1,262 @@
+#include <juce_dsp/juce_dsp.h>
+#include "dsp/Distortion/Waveshaper.h"
+#include "dsp/Distortion/Oversampled.h"
+
+/**
+ * Waveshaper ADAA. With drive 1 and no bias, FirstOrder outputs the divided difference of F1 over
+ * consecutive inputs and SecondOrder twice the second divided difference of F2: both are checked
+ * against F1 and F2 integrated numerically from each shape. Then every order has to take the
+ * roughly 8 dB documented in Waveshaper.h off the aliasing of a hard-driven sine, on its own and
+ * inside Oversampled (stereo, each channel on its own ADAA state through the channel kernel).
+ */
+class WaveshaperTests : public juce::UnitTest
+{
+public:
+    WaveshaperTests() : juce::UnitTest("Waveshaper", "Distortion") {}
+
+    void runTest() override
+    {
+        checkAntiderivatives(punk_dsp::ClipperType::Soft, "Soft", 1.0, [](double u) { return u / (std::abs(u) + 1.0); });
+        checkAntiderivatives(punk_dsp::ClipperType::Hard, "Hard", 1.0,
+                             [](double u) { return std::abs(u) > 1.0 ? std::copysign(2.0 / 3.0, u) : u - u * u * u / 3.0; });
+        checkAntiderivatives(punk_dsp::ClipperType::Tanh, "Tanh", 2.0 / juce::MathConstants<double>::pi, [](double u) { return std::tanh(u); });
+        checkAntiderivatives(punk_dsp::ClipperType::ATan, "ATan", 2.0 / juce::MathConstants<double>::pi, [](double u) { return std::atan(u); });
+
+        for (const auto clipper : { punk_dsp::ClipperType::Soft, punk_dsp::ClipperType::Hard, punk_dsp::ClipperType::Tanh,
+                                    punk_dsp::ClipperType::ATan })
+            checkAliasing(clipper);
+
+        for (const int factor : { 2, 4 })
+            checkOversampledAliasing(factor);
+    }
+
+private:
+    using Shaper = punk_dsp::Waveshaper<double>;
+
+    static juce::String clipperName(punk_dsp::ClipperType clipper)
+    {
+        switch (clipper)
+        {
+            case punk_dsp::ClipperType::Hard: return "Hard";
+            case punk_dsp::ClipperType::Tanh: return "Tanh";
+            case punk_dsp::ClipperType::ATan: return "ATan";
+            case punk_dsp::ClipperType::Soft:
+            default:                          return "Soft";
+        }
+    }
+
+    static double process(Shaper& shaper, punk_dsp::ClipperType clipper, double x)
+    {
+        switch (clipper)
+        {
+            case punk_dsp::ClipperType::Hard: return shaper.applyHardClipper(0, x);
+            case punk_dsp::ClipperType::Tanh: return shaper.applyTanhClipper(0, x);
+            case punk_dsp::ClipperType::ATan: return shaper.applyATanClipper(0, x);
+            case punk_dsp::ClipperType::Soft:
+            default:                          return shaper.applySoftClipper(0, x);
+        }
+    }
+
+    // Integral of g over [a, b]: 5-point Gauss-Legendre on panels, split where the shapes have a kink
+    template <typename Function>
+    static double integrate(Function&& g, double a, double b)
+    {
+        static constexpr double nodes[] = { 0.0, 0.538469310105683091, 0.906179845938663993 };
+        static constexpr double weights[] = { 0.568888888888888889, 0.478628670499366468, 0.236926885056189088 };
+
+        if (a > b)
+            return -integrate(g, b, a);
+
+        double sum = 0.0, from = a;
+
+        for (const double kink : { -1.0, 0.0, 1.0, b })
+        {
+            const double to = juce::jmin(kink, b);
+            if (to <= from)
+                continue;
+
+            const int panels = juce::jmax(1, (int) std::ceil((to - from) * 200.0));
+            const double half = 0.5 * (to - from) / panels;
+
+            for (int p = 0; p < panels; ++p)
+            {
+                const double centre = from + (2 * p + 1) * half;
+                double panel = weights[0] * g(centre);
+
+                for (int n = 1; n < 3; ++n)
+                    panel += weights[n] * (g(centre - half * nodes[n]) + g(centre + half * nodes[n]));
+
+                sum += panel * half;
+            }
+
+            from = to;
+        }
+
+        return sum;
+    }
+
+    template <typename Function>
+    void checkAntiderivatives(punk_dsp::ClipperType clipper, const juce::String& clipperName, double scale, Function&& f)
+    {
+        // F1 (u) = integral of f from 0 to u, F2 (u) = integral of F1 from 0 to u = integral of (u - t) f (t)
+        const auto F1 = [&](double u) { return integrate(f, 0.0, u); };
+        const auto F2 = [&](double u) { return integrate([&](double t) { return (u - t) * f(t); }, 0.0, u); };
+
+        // Inputs across both kinks and the Tanh series switch, far enough apart to stay off the midpoint expansions
+        juce::Random random(42);
+        std::vector<double> inputs { 0.0 };
+
+        while (inputs.size() < 400)
+        {
+            const double range = inputs.size() < 200 ? 2.0 : 12.0;
+            const double x = range * (2.0 * random.nextDouble() - 1.0);
+            const double previous = inputs.back(), beforeThat = inputs.size() > 1 ? inputs[inputs.size() - 2] : 0.0;
+
+            if (std::abs(x - previous) > 0.05 && std::abs(x - beforeThat) > 0.05)
+                inputs.push_back(x);
+        }
+
+        for (const auto order : { punk_dsp::ADAAOrder::FirstOrder, punk_dsp::ADAAOrder::SecondOrder })
+        {
+            const bool first = order == punk_dsp::ADAAOrder::FirstOrder;
+            beginTest(clipperName + (first ? ": F1" : ": F2") + " against numerical integration");
+
+            Shaper shaper;
+            shaper.prepare({ 48000.0, 512, 1 });
+            shaper.setADAAOrder(order);
+
+            double maxError = 0.0;
+
+            // The state starts at 0, which inputs[0] stands for
+            for (size_t n = 1; n < inputs.size(); ++n)
+            {
+                const double x = inputs[n], x1 = inputs[n - 1];
+                double expected;
+
+                if (first)
+                {
+                    expected = (F1(x) - F1(x1)) / (x - x1);
+                }
+                else
+                {
+                    const double x2 = n > 1 ? inputs[n - 2] : 0.0;
+                    const double d0 = (F2(x) - F2(x1)) / (x - x1);
+                    const double d1 = n > 1 ? (F2(x1) - F2(x2)) / (x1 - x2) : F1(0.0);
+                    expected = 2.0 * (d0 - d1) / (x - x2);
+                }
+
+                maxError = juce::jmax(maxError, std::abs(process(shaper, clipper, x) - scale * expected));
+            }
+
+            expectLessThan(maxError, 1.0e-9, "ADAA output against the integrated shape");
+        }
+    }
+
+    // Sine on an exact bin, so the harmonics land on bins: everything else but DC is aliasing
+    static constexpr int aliasingOrder = 13, aliasingSize = 1 << aliasingOrder, aliasingBin = 805;   // 4717 Hz at 48 kHz
+
+    template <typename SampleType>
+    static double aliasingToHarmonicsDb(const juce::AudioBuffer<SampleType>& buffer, int channel)
+    {
+        std::vector<float> spectrum((size_t) (2 * aliasingSize), 0.0f);
+
+        for (int i = 0; i < aliasingSize; ++i)
+            spectrum[(size_t) i] = (float) buffer.getSample(channel, i);
+
+        juce::dsp::FFT(aliasingOrder).performRealOnlyForwardTransform(spectrum.data(), true);
+
+        double harmonics = 0.0, aliasing = 0.0;
+
+        for (int k = 1; k <= aliasingSize / 2; ++k)
+        {
+            const double power = juce::square((double) spectrum[(size_t) (2 * k)]) + juce::square((double) spectrum[(size_t) (2 * k + 1)]);
+            (k % aliasingBin == 0 ? harmonics : aliasing) += power;
+        }
+
+        return 10.0 * std::log10(aliasing / harmonics);
+    }
+
+    // Hard clipper at drive 10 in a stereo 'factor'x IIR Oversampled; the right channel runs at half level
+    void checkOversampledAliasing(int factor)
+    {
+        beginTest("Hard: aliasing inside " + juce::String(factor) + "x Oversampled falls with the ADAA order, on both channels");
+
+        double aliasingDb[3][2] {};
+
+        for (const auto adaa : { punk_dsp::ADAAOrder::Off, punk_dsp::ADAAOrder::FirstOrder, punk_dsp::ADAAOrder::SecondOrder })
+        {
+            punk_dsp::Oversampled<punk_dsp::Waveshaper<float>> shaper;
+            shaper.setFactor(factor);
+            shaper.prepare({ 48000.0, (juce::uint32) aliasingSize, 2 });
+            shaper.getProcessor().setADAAOrder(adaa);
+            shaper.getProcessor().setDrive(10.0f);
+            shaper.getProcessor().prepare({ 48000.0 * factor, (juce::uint32) (aliasingSize * factor), 2 });
+
+            juce::AudioBuffer<float> buffer(2, aliasingSize);
+
+            // Two periods of the whole window: the first settles the filters and the ADAA state
+            for (int pass = 0; pass < 2; ++pass)
+            {
+                for (int channel = 0; channel < 2; ++channel)
+                    for (int i = 0; i < aliasingSize; ++i)
+                        buffer.setSample(channel, i, (channel == 0 ? 1.0f : 0.5f)
+                                                     * (float) std::sin(juce::MathConstants<double>::twoPi * aliasingBin * i / aliasingSize));
+
+                shaper.process(buffer, [](auto& ws, int channel, float x) { return ws.applyHardClipper(channel, x); });
+            }
+
+            for (int channel = 0; channel < 2; ++channel)
+                aliasingDb[(int) adaa][channel] = aliasingToHarmonicsDb(buffer, channel);
+        }
+
+        for (int channel = 0; channel < 2; ++channel)
+        {
+            const juce::String side = channel == 0 ? "left" : "right";
+            logMessage(side + " aliasing / harmonics: off " + juce::String(aliasingDb[0][channel], 1) + " dB, first order "
+                       + juce::String(aliasingDb[1][channel], 1) + " dB, second order " + juce::String(aliasingDb[2][channel], 1) + " dB");
+
+            expectLessThan(aliasingDb[1][channel], aliasingDb[0][channel] - 8.0, "FirstOrder, " + side);
+            expectLessThan(aliasingDb[2][channel], aliasingDb[1][channel] - 8.0, "SecondOrder, " + side);
+        }
+    }
+
+    void checkAliasing(punk_dsp::ClipperType clipper)
+    {
+        constexpr int size = aliasingSize, bin = aliasingBin;
+
+        // The plain Tanh clipper is FastMathApproximations::tanh, which only holds up to |u| = 5
+        const float drive = clipper == punk_dsp::ClipperType::Tanh ? 5.0f : 10.0f;
+        beginTest(clipperName(clipper) + ": aliasing of a 4.7 kHz sine at drive " + juce::String((int) drive) + " falls with the ADAA order");
+
+        double aliasingDb[3] {};
+
+        for (const auto adaa : { punk_dsp::ADAAOrder::Off, punk_dsp::ADAAOrder::FirstOrder, punk_dsp::ADAAOrder::SecondOrder })
+        {
+            Shaper shaper;
+            shaper.prepare({ 48000.0, (juce::uint32) size, 1 });
+            shaper.setClipper(clipper);
+            shaper.setADAAOrder(adaa);
+            shaper.setDrive(drive);
+
+            juce::AudioBuffer<double> buffer(1, size);
+            // Two periods of the whole window: the first settles the ADAA state
+            for (int pass = 0; pass < 2; ++pass)
+            {
+                for (int i = 0; i < size; ++i)
+                    buffer.setSample(0, i, std::sin(juce::MathConstants<double>::twoPi * bin * i / size));
+
+                shaper.process(buffer);
+            }
+
+            aliasingDb[(int) adaa] = aliasingToHarmonicsDb(buffer, 0);
+        }
+
+        logMessage("aliasing / harmonics: off " + juce::String(aliasingDb[0], 1) + " dB, first order "
+                   + juce::String(aliasingDb[1], 1) + " dB, second order " + juce::String(aliasingDb[2], 1) + " dB");
+
+        expectLessThan(aliasingDb[1], aliasingDb[0] - 8.0, "FirstOrder");
+        expectLessThan(aliasingDb[2], aliasingDb[1] - 8.0, "SecondOrder");
+    }
+};
+
+static WaveshaperTests waveshaperTests;
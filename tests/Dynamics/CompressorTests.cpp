@@ -0,0 +1,303 @@
+#include <juce_dsp/juce_dsp.h>
+#include "dsp/Dynamics/Compressor.h"
+
+/**
+ * Control-rate gain (updateControlInterval) nulled against the per-sample path: K = 1 must be the
+ * per-sample path bit for bit, and the residual of larger K stays within the figures documented in
+ * Compressor.h (460 Hz tone under a slow envelope, 5 ms attack, 4:1). A key of another layout must
+ * key every channel with its mean, mixed once and shared.
+ *
+ * The default path (peak detector, no lookahead or key) runs full registers one channel per lane
+ * and the channels left over sample by sample. Both must match a plain scalar compressor with
+ * exact dB conversions, for bus widths that fill whole registers, leave a partly empty one, or
+ * never reach the lane path at all.
+ */
+class CompressorTests : public juce::UnitTest
+{
+public:
+    CompressorTests() : juce::UnitTest("Compressor", "Dynamics") {}
+
+    void runTest() override
+    {
+        for (const int numChannels : { 1, 3, 5, 8, 32 })
+        {
+            for (const bool feedForward : { true, false })
+            {
+                for (const bool autoRelease : { false, true })
+                {
+                    beginTest("Default path against a scalar reference, " + juce::String(numChannels) + " channels, "
+                              + (feedForward ? "feed-forward" : "feed-back") + (autoRelease ? ", auto release" : ""));
+
+                    const float maxError = maxReferenceError(numChannels, feedForward, autoRelease);
+                    logMessage("largest difference " + juce::String(maxError, 7));
+                    expectLessThan(maxError, maxReferenceDifference);
+                }
+            }
+        }
+
+        for (const int numChannels : { 1, 2, 8 })
+        {
+            for (const bool feedForward : { true, false })
+            {
+                beginTest("K = 1 is the per-sample path, " + juce::String(numChannels) + " channels, "
+                          + (feedForward ? "feed-forward" : "feed-back"));
+
+                const auto perSample = render(numChannels, feedForward, 0);
+
+                // Every sample of a K = 8 run differs; setting K back to 1 must leave nothing of it behind
+                const auto restored = render(numChannels, feedForward, 1, 8);
+                expectEquals(countDifferences(perSample, restored), 0);
+            }
+        }
+
+        beginTest("Residual of K > 1 against K = 1");
+
+        const auto reference = render(2, true, 1);
+
+        for (const auto& [interval, maxResidualDb] : { std::pair<int, double> { 2, -66.0 }, { 4, -53.0 }, { 8, -45.0 },
+                                                        { 16, -33.0 }, { 32, -19.0 } })
+        {
+            const double residualDb = nullDepthDb(reference, render(2, true, interval));
+            logMessage("K = " + juce::String(interval) + ": " + juce::String(residualDb, 1) + " dB");
+            expectLessOrEqual(residualDb, maxResidualDb, "K = " + juce::String(interval));
+        }
+
+        for (const auto link : { punk_dsp::ChannelLink::Independent, punk_dsp::ChannelLink::Max })
+        {
+            beginTest(juce::String("Three-channel key on a stereo bus is its mean, ")
+                      + (link == punk_dsp::ChannelLink::Independent ? "unlinked" : "linked"));
+
+            juce::AudioBuffer<float> key(3, blockSize), mean(1, blockSize);
+            const auto keyed = renderKeyed(link, [&](int b) -> const juce::AudioBuffer<float>&
+            {
+                for (int channel = 0; channel < 3; ++channel)
+                    for (int i = 0; i < blockSize; ++i)
+                        key.setSample(channel, i, testSignal(channel + 1, b * blockSize + i) * (float) (channel + 1) / 3.0f);
+
+                return key;
+            });
+
+            const auto premixed = renderKeyed(link, [&](int b) -> const juce::AudioBuffer<float>&
+            {
+                for (int channel = 0; channel < 3; ++channel)
+                    for (int i = 0; i < blockSize; ++i)
+                        key.setSample(channel, i, testSignal(channel + 1, b * blockSize + i) * (float) (channel + 1) / 3.0f);
+
+                // Mixed the way SidechainInput does it
+                float* data = mean.getWritePointer(0);
+                juce::FloatVectorOperations::copy(data, key.getReadPointer(0), blockSize);
+                juce::FloatVectorOperations::add(data, key.getReadPointer(1), blockSize);
+                juce::FloatVectorOperations::add(data, key.getReadPointer(2), blockSize);
+                juce::FloatVectorOperations::multiply(data, 1.0f / 3.0f, blockSize);
+                return mean;
+            });
+
+            expectEquals(countDifferences(keyed, premixed), 0);
+        }
+    }
+
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int blockSize = 480;
+    static constexpr int numBlocks = 200;
+
+    // The fast dB conversions are off by under 0.001 dB; the paths land within about 5e-6 of the reference
+    static constexpr float maxReferenceDifference = 5.0e-5f;
+
+    /**
+     * Two seconds of a 460 Hz tone swelling between -40 and 0 dBFS, compressed with interval K.
+     * previousInterval > 0 runs a first pass at that interval and reset()s before K is set.
+     * interval 0 leaves updateControlInterval() uncalled.
+     */
+    static juce::AudioBuffer<float> render(int numChannels, bool feedForward, int interval, int previousInterval = 0)
+    {
+        punk_dsp::Compressor<float> compressor;
+        compressor.prepare({ sampleRate, (juce::uint32) blockSize, (juce::uint32) numChannels });
+        compressor.updateThres(-24.0f);
+        compressor.updateRatio(4.0f);
+        compressor.updateKnee(6.0f);
+        compressor.updateAttack(5.0f);
+        compressor.updateRelease(80.0f);
+        compressor.updateFeedForward(feedForward);
+
+        juce::AudioBuffer<float> output(numChannels, blockSize * numBlocks), block(numChannels, blockSize);
+
+        const auto run = [&]
+        {
+            for (int b = 0; b < numBlocks; ++b)
+            {
+                for (int channel = 0; channel < numChannels; ++channel)
+                    for (int i = 0; i < blockSize; ++i)
+                        block.setSample(channel, i, testSignal(channel, b * blockSize + i));
+
+                compressor.process(block);
+
+                for (int channel = 0; channel < numChannels; ++channel)
+                    output.copyFrom(channel, b * blockSize, block, channel, 0, blockSize);
+            }
+        };
+
+        if (previousInterval > 0)
+        {
+            compressor.updateControlInterval(previousInterval);
+            run();
+            compressor.reset();
+        }
+
+        if (interval > 0)
+            compressor.updateControlInterval(interval);
+
+        run();
+        return output;
+    }
+
+    /**
+     * The compressor the default path implements, one channel and one sample at a time, with
+     * juce::Decibels for the conversions: the envelope runs on the reduction amount, attacks
+     * while the target (or the auto release floor) is above it.
+     */
+    struct ScalarReference
+    {
+        float thresdB = -24.0f, ratio = 4.0f, kneedB = 6.0f, attackMs = 5.0f, releaseMs = 80.0f;
+        bool feedForward = true, autoRelease = false;
+
+        void process(float* data, int numSamples, float& reduction, float& held) const
+        {
+            const auto coefficient = [](float ms) { return std::exp(-1.f / (0.001f * ms * (float) sampleRate)); };
+            const float attack = coefficient(attackMs), release = coefficient(releaseMs);
+            const float sustain = autoRelease ? coefficient(releaseMs * punk_dsp::Compressor<float>::autoReleaseSpread) : 1.0f;
+            const float slope = 1.0f - 1.0f / ratio;
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                float inputDB = juce::Decibels::gainToDecibels(std::abs(data[i]));
+
+                if (! feedForward)
+                    inputDB -= reduction;
+
+                float target = 0.0f;
+
+                if (inputDB > thresdB + kneedB / 2.0f)
+                    target = (inputDB - thresdB) * slope;
+                else if (inputDB > thresdB - kneedB / 2.0f)
+                    target = slope / (2.0f * kneedB) * juce::square(inputDB - thresdB + kneedB / 2.0f);
+
+                held = target + sustain * (held - target);
+                const float floor = juce::jmax(target, held);
+                const float alpha = floor > reduction ? attack : release;
+                reduction = floor + alpha * (reduction - floor);
+
+                data[i] *= juce::Decibels::decibelsToGain(-reduction);
+            }
+        }
+    };
+
+    // Largest sample difference between the compressor and the reference over the test signal,
+    // each channel at its own level so a lane mix-up can't cancel out
+    float maxReferenceError(int numChannels, bool feedForward, bool autoRelease)
+    {
+        punk_dsp::Compressor<float> compressor;
+        compressor.prepare({ sampleRate, (juce::uint32) blockSize, (juce::uint32) numChannels });
+        compressor.updateThres(-24.0f);
+        compressor.updateRatio(4.0f);
+        compressor.updateKnee(6.0f);
+        compressor.updateAttack(5.0f);
+        compressor.updateRelease(80.0f);
+        compressor.updateFeedForward(feedForward);
+        compressor.updateAutoRelease(autoRelease);
+
+        ScalarReference reference;
+        reference.feedForward = feedForward;
+        reference.autoRelease = autoRelease;
+
+        std::vector<float> reduction((size_t) numChannels, 0.0f), held((size_t) numChannels, 0.0f);
+        juce::AudioBuffer<float> block(numChannels, blockSize), expected(numChannels, blockSize);
+        float maxError = 0.0f;
+
+        for (int b = 0; b < numBlocks / 4; ++b)
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+                for (int i = 0; i < blockSize; ++i)
+                    block.setSample(channel, i, testSignal(channel, b * blockSize + i) * (float) (channel % 5 + 1) / 5.0f);
+
+            expected.makeCopyOf(block);
+            compressor.process(block);
+
+            for (int channel = 0; channel < numChannels; ++channel)
+            {
+                reference.process(expected.getWritePointer(channel), blockSize, reduction[(size_t) channel], held[(size_t) channel]);
+
+                for (int i = 0; i < blockSize; ++i)
+                    maxError = juce::jmax(maxError, std::abs(block.getSample(channel, i) - expected.getSample(channel, i)));
+            }
+        }
+
+        return maxError;
+    }
+
+    // Stereo, compressed from the key block returned by keyForBlock(blockIndex)
+    template <typename KeySource>
+    static juce::AudioBuffer<float> renderKeyed(punk_dsp::ChannelLink link, KeySource&& keyForBlock)
+    {
+        punk_dsp::Compressor<float> compressor;
+        compressor.prepare({ sampleRate, (juce::uint32) blockSize, 2 });
+        compressor.updateThres(-24.0f);
+        compressor.updateRatio(4.0f);
+        compressor.updateLink(link);
+
+        juce::AudioBuffer<float> output(2, blockSize * numBlocks), block(2, blockSize);
+
+        for (int b = 0; b < numBlocks; ++b)
+        {
+            for (int channel = 0; channel < 2; ++channel)
+                for (int i = 0; i < blockSize; ++i)
+                    block.setSample(channel, i, testSignal(channel, b * blockSize + i));
+
+            compressor.processWithSidechain(block, keyForBlock(b));
+
+            for (int channel = 0; channel < 2; ++channel)
+                output.copyFrom(channel, b * blockSize, block, channel, 0, blockSize);
+        }
+
+        return output;
+    }
+
+    static float testSignal(int channel, int n)
+    {
+        const double t = n / sampleRate;
+        const double envelopeDb = -20.0 + 20.0 * std::sin(juce::MathConstants<double>::twoPi * 1.5 * t);
+        return (float) (juce::Decibels::decibelsToGain(envelopeDb)
+                        * std::sin(juce::MathConstants<double>::twoPi * 460.0 * t + 0.3 * channel));
+    }
+
+    static int countDifferences(const juce::AudioBuffer<float>& a, const juce::AudioBuffer<float>& b)
+    {
+        int differences = 0;
+
+        for (int channel = 0; channel < a.getNumChannels(); ++channel)
+            for (int i = 0; i < a.getNumSamples(); ++i)
+                differences += a.getSample(channel, i) != b.getSample(channel, i) ? 1 : 0;
+
+        return differences;
+    }
+
+    // RMS of the difference relative to the RMS of the reference, in dB
+    static double nullDepthDb(const juce::AudioBuffer<float>& reference, const juce::AudioBuffer<float>& other)
+    {
+        double signal = 0.0, residual = 0.0;
+
+        for (int channel = 0; channel < reference.getNumChannels(); ++channel)
+        {
+            for (int i = 0; i < reference.getNumSamples(); ++i)
+            {
+                const double x = reference.getSample(channel, i);
+                signal += x * x;
+                residual += juce::square(x - other.getSample(channel, i));
+            }
+        }
+
+        return 10.0 * std::log10(residual / signal);
+    }
+};
+
+static CompressorTests compressorTests;
@@ -0,0 +1,91 @@
+#include <juce_dsp/juce_dsp.h>
+#include "dsp/Dynamics/DecibelConversions.h"
+
+/**
+ * Sweeps every accuracy tier from -100 dB to +100 dB against juce::Decibels in double precision and
+ * holds it to the bounds documented in DecibelConversions.h, for the scalar and the SIMDRegister paths.
+ */
+class DecibelConversionsTests : public juce::UnitTest
+{
+public:
+    DecibelConversionsTests() : juce::UnitTest("DecibelConversions", "Dynamics") {}
+
+    void runTest() override
+    {
+        checkTier<punk_dsp::DecibelAccuracy::Fast>("Fast", 0.0047, 8.7e-5);
+        checkTier<punk_dsp::DecibelAccuracy::Balanced>("Balanced", 0.0007, 3.7e-6);
+        checkTier<punk_dsp::DecibelAccuracy::Precise>("Precise", 0.0001, 8.5e-7);
+        checkTier<punk_dsp::DecibelAccuracy::Reference>("Reference", 0.0001, 8.5e-7);
+    }
+
+private:
+    using SIMDFloat = juce::dsp::SIMDRegister<float>;
+    static constexpr int lanes = (int) SIMDFloat::SIMDNumElements;
+    static constexpr int numPoints = 1 << 18;
+
+    template <punk_dsp::DecibelAccuracy accuracy>
+    void checkTier(const juce::String& tierName, double maxDbError, double maxRelativeGainError)
+    {
+        using Conversions = punk_dsp::DecibelConversions<accuracy>;
+
+        beginTest(tierName + ": error against juce::Decibels from -100 dB to +100 dB");
+
+        // The points sit on a dB grid; the gains are the float nearest to each
+        std::vector<float> dB((size_t) numPoints), gain((size_t) numPoints);
+        for (int i = 0; i < numPoints; ++i)
+        {
+            const double level = -100.0 + 200.0 * (i + 1) / numPoints;
+            dB[(size_t) i] = (float) level;
+            gain[(size_t) i] = (float) juce::Decibels::decibelsToGain(level, -1000.0);
+        }
+
+        double dbError = 0.0, gainError = 0.0, simdDbError = 0.0, simdGainError = 0.0;
+
+        for (int i = 0; i < numPoints; i += lanes)
+        {
+            alignas(SIMDFloat) float simdDb[lanes];
+            alignas(SIMDFloat) float simdGain[lanes];
+            Conversions::gainToDecibels(SIMDFloat::fromRawArray(gain.data() + i)).copyToRawArray(simdDb);
+            Conversions::decibelsToGain(SIMDFloat::fromRawArray(dB.data() + i)).copyToRawArray(simdGain);
+
+            for (int lane = 0; lane < lanes; ++lane)
+            {
+                const auto n = (size_t) (i + lane);
+                const double expectedDb = juce::Decibels::gainToDecibels((double) gain[n]);
+                const double expectedGain = juce::Decibels::decibelsToGain((double) dB[n]);
+
+                dbError = juce::jmax(dbError, std::abs(Conversions::gainToDecibels(gain[n]) - expectedDb));
+                gainError = juce::jmax(gainError, std::abs(Conversions::decibelsToGain(dB[n]) / expectedGain - 1.0));
+                simdDbError = juce::jmax(simdDbError, std::abs(simdDb[lane] - expectedDb));
+                simdGainError = juce::jmax(simdGainError, std::abs(simdGain[lane] / expectedGain - 1.0));
+            }
+        }
+
+        expectLessOrEqual(dbError, maxDbError, "gainToDecibels");
+        expectLessOrEqual(gainError, maxRelativeGainError, "decibelsToGain");
+        expectLessOrEqual(simdDbError, maxDbError, "gainToDecibels, SIMD");
+        expectLessOrEqual(simdGainError, maxRelativeGainError, "decibelsToGain, SIMD");
+
+        logMessage("max error: " + juce::String(dbError, 6) + " dB, " + juce::String(gainError * 1.0e6, 3) + "e-6 relative gain");
+
+        beginTest(tierName + ": -100 dB floor");
+
+        for (const float floorGain : { 0.0f, 1.0e-6f, 1.0e-5f })
+            expectEquals(Conversions::gainToDecibels(floorGain), Conversions::minusInfinityDb);
+
+        for (const float floorDb : { -100.0f, -120.0f, -1000.0f })
+            expectEquals(Conversions::decibelsToGain(floorDb), 0.0f);
+
+        alignas(SIMDFloat) float floorGains[lanes], floorLevels[lanes];
+        Conversions::gainToDecibels(SIMDFloat::expand(0.0f)).copyToRawArray(floorGains);
+        Conversions::decibelsToGain(SIMDFloat::expand(-120.0f)).copyToRawArray(floorLevels);
+
+        for (int lane = 0; lane < lanes; ++lane)
+        {
+            expectEquals(floorGains[lane], Conversions::minusInfinityDb);
+            expectEquals(floorLevels[lane], 0.0f);
+        }
+    }
+};
+
+static DecibelConversionsTests decibelConversionsTests;
@@ -0,0 +1,74 @@
+#include <juce_dsp/juce_dsp.h>
+#include "dsp/Dynamics/Gate.h"
+
+/**
+ * Gate hysteresis and hold with the Peak detector, which reads |x| and so dips under the closing
+ * level at every zero crossing: a tone between the closing and opening levels, whose dips are all
+ * shorter than the hold, must keep an open gate open, and the gate must still close once the level
+ * really drops.
+ */
+class GateTests : public juce::UnitTest
+{
+public:
+    GateTests() : juce::UnitTest("Gate", "Dynamics") {}
+
+    void runTest() override
+    {
+        for (const float frequency : { 100.0f, 220.0f, 440.0f })
+        {
+            beginTest("Tone between the closing and opening levels holds the gate open, " + juce::String(frequency, 0) + " Hz");
+
+            // Open at -6 dB, hover at -23 dB (threshold -20, closing at -26), then fall to -60 dB
+            const int openEnd = samples(0.1), hoverEnd = samples(1.1), numSamples = blockSize * 132;
+            juce::AudioBuffer<float> input(1, numSamples);
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const float level = i < openEnd ? -6.0f : i < hoverEnd ? -23.0f : -60.0f;
+                input.setSample(0, i, juce::Decibels::decibelsToGain(level)
+                                      * (float) std::sin(juce::MathConstants<double>::twoPi * frequency * i / sampleRate));
+            }
+
+            punk_dsp::Gate<float> gate;
+            gate.prepare({ sampleRate, (juce::uint32) blockSize, 1 });
+            gate.updateThres(-20.0f);
+            gate.updateHysteresis(6.0f);
+            gate.updateHold(5.0f);
+            gate.updateRange(-80.0f);
+            gate.updateAttack(1.0f);
+            gate.updateRelease(20.0f);
+
+            juce::AudioBuffer<float> output(1, numSamples), block(1, blockSize);
+
+            for (int start = 0; start < numSamples; start += blockSize)
+            {
+                block.copyFrom(0, 0, input, 0, start, blockSize);
+                gate.process(block);
+                output.copyFrom(0, start, block, 0, 0, blockSize);
+            }
+
+            // Fully open from a few ms after the burst until the level falls
+            float maxHoverError = 0.0f;
+            for (int i = samples(0.02); i < hoverEnd; ++i)
+                maxHoverError = juce::jmax(maxHoverError, std::abs(output.getSample(0, i) - input.getSample(0, i)));
+
+            expectLessThan(maxHoverError, 1.0e-6f, "Gate moved while the tone stayed above the closing level");
+
+            // Closed to the range well after hold + release
+            float maxClosedRatio = 0.0f;
+            for (int i = hoverEnd + samples(0.15); i < numSamples; ++i)
+                if (std::abs(input.getSample(0, i)) > 1.0e-4f)
+                    maxClosedRatio = juce::jmax(maxClosedRatio, std::abs(output.getSample(0, i) / input.getSample(0, i)));
+
+            expectLessThan(maxClosedRatio, juce::Decibels::decibelsToGain(-70.0f), "Gate did not close");
+        }
+    }
+
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int blockSize = 512;
+
+    static int samples(double seconds) { return (int) (seconds * sampleRate); }
+};
+
+static GateTests gateTests;
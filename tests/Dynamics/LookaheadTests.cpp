@@ -0,0 +1,67 @@
+#include <juce_dsp/juce_dsp.h>
+#include "dsp/Dynamics/Lookahead.h"
+
+/**
+ * Lookahead against a brute-force window maximum and delay line. Falling input keeps every sample
+ * in the deque, which is where a ring sized for delay + 1 entries has no slack left.
+ */
+class LookaheadTests : public juce::UnitTest
+{
+public:
+    LookaheadTests() : juce::UnitTest("Lookahead", "Dynamics") {}
+
+    void runTest() override
+    {
+        for (const int maxDelay : { 1, 3, 7, 15, 63, 100 })
+        {
+            beginTest("Falling ramps, delay " + juce::String(maxDelay));
+            check(maxDelay, [](int n) { return 1.0f - (float) (n % 97) / 97.0f; });
+
+            beginTest("Noise, delay " + juce::String(maxDelay));
+            juce::Random random(maxDelay);
+            std::vector<float> noise(4096);
+            for (auto& value : noise)
+                value = random.nextFloat();
+
+            check(maxDelay, [&](int n) { return noise[(size_t) n]; });
+        }
+    }
+
+private:
+    template <typename Signal>
+    void check(int maxDelay, Signal&& signal)
+    {
+        constexpr int numSamples = 4096;
+        constexpr int blockSize = 37;
+
+        punk_dsp::Lookahead<float> lookahead;
+        lookahead.prepare(maxDelay, 1);
+        lookahead.setDelay(maxDelay);
+
+        std::vector<float> input((size_t) numSamples), data((size_t) numSamples), levels((size_t) numSamples);
+        for (int n = 0; n < numSamples; ++n)
+            input[(size_t) n] = data[(size_t) n] = levels[(size_t) n] = signal(n);
+
+        for (int start = 0; start < numSamples; start += blockSize)
+            lookahead.process(0, data.data() + start, levels.data() + start, juce::jmin(blockSize, numSamples - start));
+
+        int levelErrors = 0, delayErrors = 0;
+
+        for (int n = 0; n < numSamples; ++n)
+        {
+            float expectedLevel = 0.0f;
+            for (int k = juce::jmax(0, n - maxDelay); k <= n; ++k)
+                expectedLevel = juce::jmax(expectedLevel, input[(size_t) k]);
+
+            const float expectedSample = n >= maxDelay ? input[(size_t) (n - maxDelay)] : 0.0f;
+
+            levelErrors += levels[(size_t) n] != expectedLevel ? 1 : 0;
+            delayErrors += data[(size_t) n] != expectedSample ? 1 : 0;
+        }
+
+        expectEquals(levelErrors, 0, "Window maximum");
+        expectEquals(delayErrors, 0, "Delayed audio");
+    }
+};
+
+static LookaheadTests lookaheadTests;
@@ -0,0 +1,100 @@
+#include <juce_dsp/juce_dsp.h>
+#include "dsp/Dynamics/MultibandCompressor.h"
+
+/**
+ * MultibandCompressor with every band idle (threshold far above the signal): the LR4 bands must
+ * sum to an allpass, so the impulse response has a flat magnitude, for 2 to 5 bands. With
+ * lookahead every band is delayed alike: still flat, and nothing comes out before the reported
+ * latency, even after one band's lookahead was changed on its own through getBand().
+ */
+class MultibandCompressorTests : public juce::UnitTest
+{
+public:
+    MultibandCompressorTests() : juce::UnitTest("MultibandCompressor", "Dynamics") {}
+
+    void runTest() override
+    {
+        for (int numBands = punk_dsp::MultibandCompressor::minBands; numBands <= punk_dsp::MultibandCompressor::maxBands; ++numBands)
+        {
+            for (const float lookaheadMs : { 0.0f, 5.0f })
+            {
+                beginTest(juce::String(numBands) + " idle bands sum flat, lookahead " + juce::String(lookaheadMs, 0) + " ms");
+                checkFlatSum(numBands, lookaheadMs, false);
+            }
+        }
+
+        beginTest("A band's own lookahead is put back in line with the others");
+        checkFlatSum(4, 5.0f, true);
+    }
+
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int blockSize = 512;
+    static constexpr int order = 14, size = 1 << order;
+
+    // Float biquads in series: a few thousandths of a dB
+    static constexpr double maxRippleDb = 0.01;
+
+    void checkFlatSum(int numBands, float lookaheadMs, bool strayBand)
+    {
+        punk_dsp::MultibandCompressor compressor;
+        compressor.setNumBands(numBands);
+        compressor.setLookahead(lookaheadMs);
+        compressor.prepare({ sampleRate, (juce::uint32) blockSize, 2 });
+
+        for (int band = 0; band < numBands; ++band)
+        {
+            compressor.getBand(band).updateThres(24.0f);
+            compressor.getBand(band).updateRatio(4.0f);
+        }
+
+        if (strayBand)
+            compressor.getBand(1).updateLookahead(2.0f);
+
+        // An impulse on both channels, in blocks
+        juce::AudioBuffer<float> response(2, size), block(2, blockSize);
+        response.clear();
+        response.setSample(0, 0, 1.0f);
+        response.setSample(1, 0, 1.0f);
+
+        for (int start = 0; start < size; start += blockSize)
+        {
+            for (int channel = 0; channel < 2; ++channel)
+                block.copyFrom(channel, 0, response, channel, start, blockSize);
+
+            compressor.process(block);
+
+            for (int channel = 0; channel < 2; ++channel)
+                response.copyFrom(channel, start, block, channel, 0, blockSize);
+        }
+
+        const int latency = compressor.getLatencySamples();
+        expectEquals(latency, juce::roundToInt(lookaheadMs * 0.001 * sampleRate), "Reported latency");
+
+        float early = 0.0f;
+        for (int i = 0; i < latency; ++i)
+            early = juce::jmax(early, std::abs(response.getSample(0, i)));
+
+        expectEquals(early, 0.0f, "Output before the reported latency");
+
+        // Magnitude of the impulse response, every bin
+        std::vector<float> spectrum(2 * size, 0.0f);
+        std::copy(response.getReadPointer(0), response.getReadPointer(0) + size, spectrum.begin());
+        juce::dsp::FFT(order).performRealOnlyForwardTransform(spectrum.data(), true);
+
+        double lowestDb = 0.0, highestDb = 0.0;
+
+        for (int k = 1; k < size / 2; ++k)
+        {
+            const double magnitudeDb = 10.0 * std::log10(juce::square((double) spectrum[(size_t) (2 * k)])
+                                                         + juce::square((double) spectrum[(size_t) (2 * k + 1)]));
+            lowestDb = juce::jmin(lowestDb, magnitudeDb);
+            highestDb = juce::jmax(highestDb, magnitudeDb);
+        }
+
+        expectLessThan(juce::jmax(highestDb, -lowestDb), maxRippleDb,
+                       "Magnitude between " + juce::String(lowestDb, 4) + " and " + juce::String(highestDb, 4) + " dB");
+    }
+};
+
+static MultibandCompressorTests multibandCompressorTests;
@@ -0,0 +1,262 @@
+#include <juce_dsp/juce_dsp.h>
+#include "dsp/followers/PitchFollower.h"
+#include <thread>
+
+/**
+ * PitchFollower on steady tones at known pitches from 40 Hz (the default floor) to 1 kHz: sines
+ * and band-limited sawtooths, whose strong upper harmonics invite octave errors. Every estimate
+ * must land on the tone, and the parabolic refinement must beat the whole-lag grid, whose error
+ * at 1 kHz (48 samples per period) would reach 18 cents.
+ *
+ * Latency: a follower analysing every sample gives the earliest point a tone onset can be
+ * detected. The same onset at every offset within a hop must then show up no later than
+ * getAnalysisLatencySamples() after that point, and the worst offset close to it.
+ *
+ * analyseRing: a follower prepared for an external ring, reading a frame that wraps around the
+ * end of the ring, must report what processBlock reports for the same history.
+ */
+class PitchFollowerTests : public juce::UnitTest
+{
+public:
+    PitchFollowerTests() : juce::UnitTest("PitchFollower", "Followers") {}
+
+    void runTest() override
+    {
+        checkKnownPitches(punk_dsp::PitchFollower::Algorithm::NormalisedCorrelation, "NormalisedCorrelation");
+        checkKnownPitches(punk_dsp::PitchFollower::Algorithm::YIN, "YIN");
+        checkKnownPitches(punk_dsp::PitchFollower::Algorithm::MPM, "MPM");
+
+        checkLatency(punk_dsp::PitchFollower::AnalysisThread::AudioThread, 0, 64);
+        checkLatency(punk_dsp::PitchFollower::AnalysisThread::AudioThread, 256, 64);
+        checkLatency(punk_dsp::PitchFollower::AnalysisThread::BackgroundThread, 480, 96);
+
+        for (const int newestIndex : { 100, 2500, 4095 })
+            checkRingAnalysis(newestIndex);
+    }
+
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int blockSize = 512;
+
+    enum class Waveform
+    {
+        Sine,
+        Sawtooth
+    };
+
+    // Period-exact tones, sawtooth summed up to 20 kHz
+    static void fillTone(juce::AudioBuffer<float>& buffer, Waveform waveform, double frequency)
+    {
+        const int numHarmonics = waveform == Waveform::Sine ? 1 : (int) (20000.0 / frequency);
+
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+        {
+            const double phase = juce::MathConstants<double>::twoPi * frequency * i / sampleRate;
+            double sample = 0.0;
+
+            for (int harmonic = 1; harmonic <= numHarmonics; ++harmonic)
+                sample += std::sin(harmonic * phase) / harmonic;
+
+            buffer.setSample(0, i, (float) (0.5 * sample));
+        }
+    }
+
+    static void feed(punk_dsp::PitchFollower& follower, const juce::AudioBuffer<float>& input, int blockLength)
+    {
+        juce::AudioBuffer<float> block(1, blockLength);
+
+        for (int start = 0; start + blockLength <= input.getNumSamples(); start += blockLength)
+        {
+            block.copyFrom(0, 0, input, 0, start, blockLength);
+            follower.processBlock(block);
+        }
+    }
+
+    static double centsBetween(double frequency, double reference)
+    {
+        return 1200.0 * std::log2(frequency / reference);
+    }
+
+    void checkKnownPitches(punk_dsp::PitchFollower::Algorithm algorithm, const juce::String& algorithmName)
+    {
+        for (const auto waveform : { Waveform::Sine, Waveform::Sawtooth })
+        {
+            const juce::String waveformName = waveform == Waveform::Sine ? "sines" : "sawtooths";
+            beginTest(algorithmName + ": " + waveformName + " from 40 Hz to 1 kHz");
+
+            double worstCents = 0.0;
+
+            for (const double frequency : { 40.0, 41.2, 55.0, 82.41, 110.0, 146.83, 196.0, 261.63,
+                                            329.63, 440.0, 523.25, 659.26, 783.99, 987.77, 1000.0 })
+            {
+                juce::AudioBuffer<float> input(1, (int) (0.25 * sampleRate));
+                fillTone(input, waveform, frequency);
+
+                punk_dsp::PitchFollower follower;
+                follower.setAlgorithm(algorithm);
+                follower.prepare({ sampleRate, (juce::uint32) blockSize, 1 });
+                feed(follower, input, blockSize);
+
+                const double estimate = follower.getCurrentFrequency();
+                const double cents = estimate > 0.0 ? centsBetween(estimate, frequency) : 1200.0;
+                const juce::String where = algorithmName + " on a " + juce::String(frequency, 2) + " Hz " + waveformName
+                                         + ", got " + juce::String(estimate, 2) + " Hz";
+
+                expect(follower.isPitchDetected(), where + ": no pitch detected");
+                expectLessThan(std::abs(cents), maxCentsError, where);
+
+                worstCents = juce::jmax(worstCents, std::abs(cents));
+            }
+
+            logMessage("worst error " + juce::String(worstCents, 2) + " cents");
+        }
+    }
+
+    // A 220 Hz tone from 'onset' on, after silence
+    static void fillOnset(juce::AudioBuffer<float>& buffer, int onset)
+    {
+        buffer.clear();
+
+        for (int i = onset; i < buffer.getNumSamples(); ++i)
+            buffer.setSample(0, i, (float) (0.5 * std::sin(juce::MathConstants<double>::twoPi * 220.0 * (i - onset) / sampleRate)));
+    }
+
+    static void configure(punk_dsp::PitchFollower& follower, int hop)
+    {
+        follower.setAlgorithm(punk_dsp::PitchFollower::Algorithm::YIN);
+        follower.setMinFrequency(100.0f);
+        follower.setAnalysisHop(hop);
+    }
+
+    // Input samples until a follower that analyses every sample detects an onset at sample 0
+    static int earliestDetection()
+    {
+        juce::AudioBuffer<float> input(1, (int) (0.1 * sampleRate)), sample(1, 1);
+        fillOnset(input, 0);
+
+        punk_dsp::PitchFollower follower;
+        configure(follower, 1);
+        follower.prepare({ sampleRate, 1, 1 });
+
+        for (int i = 0; i < input.getNumSamples(); ++i)
+        {
+            sample.setSample(0, 0, input.getSample(0, i));
+            follower.processBlock(sample);
+
+            if (follower.isPitchDetected())
+                return i + 1;
+        }
+
+        return -1;
+    }
+
+    /**
+     * Onsets at several offsets within a hop, fed in blocks of 'blockLength'. On the background
+     * thread the blocks are paced in real time, so the worker's polling shows up in the delay.
+     */
+    void checkLatency(punk_dsp::PitchFollower::AnalysisThread thread, int hop, int blockLength)
+    {
+        const bool inBackground = thread == punk_dsp::PitchFollower::AnalysisThread::BackgroundThread;
+        const int period = hop > 0 ? hop : blockLength;
+
+        beginTest(juce::String(inBackground ? "Background" : "Audio") + " thread, "
+                  + (hop > 0 ? "hop " + juce::String(hop) : juce::String("hop = block")) + ", "
+                  + juce::String(blockLength) + "-sample blocks: reported latency against the observed delay");
+
+        const int earliest = earliestDetection();
+        expectGreaterThan(earliest, 0, "The reference never detected the onset");
+
+        int reportedLatency = 0, worstDelay = 0;
+        const int offsetStep = inBackground ? period / 8 : 1;
+
+        for (int offset = 0; offset < period; offset += offsetStep)
+        {
+            juce::AudioBuffer<float> input(1, offset + earliest + 4 * period + 8 * blockLength), block(1, blockLength);
+            fillOnset(input, offset);
+
+            punk_dsp::PitchFollower follower;
+            configure(follower, hop);
+            follower.setAnalysisThread(thread);
+            follower.prepare({ sampleRate, (juce::uint32) blockLength, 1 });
+            reportedLatency = follower.getAnalysisLatencySamples();
+
+            auto nextBlockTime = std::chrono::steady_clock::now();
+            const auto blockDuration = std::chrono::microseconds((juce::int64) (1.0e6 * blockLength / sampleRate));
+            int detectedAt = -1;
+
+            for (int start = 0; start + blockLength <= input.getNumSamples() && detectedAt < 0; start += blockLength)
+            {
+                block.copyFrom(0, 0, input, 0, start, blockLength);
+                follower.processBlock(block);
+
+                if (inBackground)
+                {
+                    nextBlockTime += blockDuration;
+                    std::this_thread::sleep_until(nextBlockTime);
+                }
+
+                if (follower.isPitchDetected())
+                    detectedAt = start + blockLength;
+            }
+
+            const int delay = detectedAt - (offset + earliest);
+            expect(detectedAt > 0, "Onset at " + juce::String(offset) + " never detected");
+            expectGreaterOrEqual(delay, 0, "Detected before the onset could be seen, offset " + juce::String(offset));
+
+            // In the background the estimate is only looked at once per block
+            expectLessOrEqual(delay, reportedLatency + (inBackground ? blockLength : 0),
+                              "Delay beyond the reported latency, offset " + juce::String(offset));
+
+            worstDelay = juce::jmax(worstDelay, delay);
+        }
+
+        // Not a loose upper bound: the worst offset waits about as long as reported
+        if (inBackground)
+            expectGreaterOrEqual(worstDelay, reportedLatency / 2, "Reported latency far above the observed delay");
+        else
+            expectEquals(worstDelay, reportedLatency - 1, "Reported latency does not match the worst observed delay");
+
+        logMessage("reported " + juce::String(reportedLatency) + " samples, worst observed " + juce::String(worstDelay));
+    }
+
+    void checkRingAnalysis(int newestIndex)
+    {
+        beginTest("analyseRing with the newest sample at ring index " + juce::String(newestIndex) + " matches processBlock");
+
+        constexpr int ringSize = 4096;
+        juce::AudioBuffer<float> input(1, 2 * ringSize);
+        fillTone(input, Waveform::Sawtooth, 146.83);
+
+        punk_dsp::PitchFollower blockFollower, ringFollower;
+        blockFollower.setAlgorithm(punk_dsp::PitchFollower::Algorithm::YIN);
+        ringFollower.setAlgorithm(punk_dsp::PitchFollower::Algorithm::YIN);
+        blockFollower.prepare({ sampleRate, (juce::uint32) blockSize, 1 });
+        ringFollower.prepareForRing(sampleRate);
+
+        // The whole input in blocks; the ring holds its last ringSize samples
+        feed(blockFollower, input, blockSize);
+
+        std::vector<float> ring(ringSize);
+        const int numSamples = input.getNumSamples();
+
+        for (int i = 0; i < ringSize; ++i)
+            ring[(size_t) ((newestIndex - i) & (ringSize - 1))] = input.getSample(0, numSamples - 1 - i);
+
+        ringFollower.analyseRing(ring.data(), ringSize - 1, newestIndex);
+
+        expect(ringFollower.isPitchDetected(), "No pitch detected from the ring");
+        expectWithinAbsoluteError(ringFollower.getCurrentFrequency(), blockFollower.getCurrentFrequency(), 1.0e-3f,
+                                  "Ring and block analysis disagree");
+
+        // Prepared for a ring, the follower keeps no history to feed
+        juce::AudioBuffer<float> block(1, blockSize);
+        block.clear();
+        ringFollower.processBlock(block);
+        expectEquals(ringFollower.getCurrentFrequency(), blockFollower.getCurrentFrequency(), "processBlock changed the ring estimate");
+    }
+
+    // Parabolic refinement: well under the 18 cents of whole lags at 1 kHz
+    static constexpr double maxCentsError = 3.0;
+};
+
+static PitchFollowerTests pitchFollowerTests;
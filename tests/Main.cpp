@@ -0,0 +1,28 @@
+#include <juce_core/juce_core.h>
+
+/**
+ * Runs every registered juce::UnitTest except the "Benchmarks" category (the ctest target),
+ * or only the benchmarks when started with --benchmarks. Exits with 1 if any expectation failed.
+ */
+int main(int argc, char* argv[])
+{
+    const bool runBenchmarks = argc > 1 && juce::String(argv[1]) == "--benchmarks";
+
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure(false);
+
+    int failures = 0;
+
+    for (const auto& category : juce::UnitTest::getAllCategories())
+    {
+        if ((category == "Benchmarks") != runBenchmarks)
+            continue;
+
+        runner.runTestsInCategory(category);
+
+        for (int i = 0; i < runner.getNumResults(); ++i)
+            failures += runner.getResult(i)->failures;
+    }
+
+    return failures > 0 ? 1 : 0;
+}
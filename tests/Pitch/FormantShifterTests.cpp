@@ -0,0 +1,239 @@
+#include <juce_dsp/juce_dsp.h>
+#include "dsp/Pitch/FormantShifter.h"
+
+/**
+ * FormantShifter on a 150 Hz harmonic tone whose spectral envelope peaks at 1 kHz (a single
+ * formant). At ratio 1 it must still be the input delayed by getLatencySamples(). Shifted with the
+ * formant at 0, the harmonics must move to the new pitch while the formant stays where it was; the
+ * plain PhaseVocoderShifter, run on the same tone, shows the formant moving with the pitch. With
+ * the pitch at 0 and the formant shifted, the formant must move instead.
+ */
+class FormantShifterTests : public juce::UnitTest
+{
+public:
+    FormantShifterTests() : juce::UnitTest("FormantShifter", "Pitch") {}
+
+    void runTest() override
+    {
+        checkUnityRatio();
+
+        for (const float semitones : { -5.0f, 4.0f, 7.0f })
+            checkFormantKept(semitones);
+
+        checkFormantMoved(3.0f);
+        checkFormantMoved(-3.0f);
+    }
+
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int blockSize = 480;
+    static constexpr int numSamples = blockSize * 150;
+    static constexpr double fundamental = 150.0;
+    static constexpr double formantFrequency = 1000.0;
+
+    /**
+     * The 1.5 ms lifter resolves the envelope to about 667 Hz, and the cepstrum of a harmonic
+     * spectrum with deep valleys between the partials comes out slightly narrower than the
+     * envelope the tone was built with, so a shifted formant lands up to ~90 Hz off. Still well
+     * clear of the 230 Hz and more the plain phase vocoder moves it by at the shifts checked.
+     */
+    static constexpr double maxFormantError = 110.0;
+
+    // Harmonics up to 8 kHz under a Gaussian formant on a flat floor
+    static double envelopeAt(double frequency)
+    {
+        return 0.05 + std::exp(-0.5 * juce::square((frequency - formantFrequency) / 250.0));
+    }
+
+    static void fillFormantTone(juce::AudioBuffer<float>& buffer)
+    {
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+        {
+            double sample = 0.0;
+
+            for (int harmonic = 1; harmonic * fundamental < 8000.0; ++harmonic)
+                sample += envelopeAt(harmonic * fundamental)
+                        * std::sin(juce::MathConstants<double>::twoPi * harmonic * fundamental * i / sampleRate);
+
+            buffer.setSample(0, i, (float) (0.1 * sample));
+        }
+    }
+
+    static void processInBlocks(punk_dsp::PhaseVocoderShifter& shifter, juce::AudioBuffer<float>& buffer)
+    {
+        juce::AudioBuffer<float> block(1, blockSize);
+
+        for (int start = 0; start + blockSize <= buffer.getNumSamples(); start += blockSize)
+        {
+            block.copyFrom(0, 0, buffer, 0, start, blockSize);
+            shifter.process(block);
+            buffer.copyFrom(0, start, block, 0, 0, blockSize);
+        }
+    }
+
+    // Hann-windowed power spectrum of the settled tail, one value per bin of a 2^order FFT
+    static constexpr int analysisOrder = 14;
+    static constexpr int analysisSize = 1 << analysisOrder;
+    static constexpr double binWidth = sampleRate / analysisSize;
+
+    static std::vector<float> tailSpectrum(const juce::AudioBuffer<float>& buffer)
+    {
+        std::vector<float> spectrum(2 * analysisSize, 0.0f);
+        const float* tail = buffer.getReadPointer(0, buffer.getNumSamples() - analysisSize);
+
+        for (int i = 0; i < analysisSize; ++i)
+            spectrum[(size_t) i] = tail[i] * (0.5f - 0.5f * std::cos(juce::MathConstants<float>::twoPi * (float) i / (float) analysisSize));
+
+        juce::dsp::FFT(analysisOrder).performRealOnlyForwardTransform(spectrum.data(), true);
+
+        std::vector<float> power(analysisSize / 2);
+        for (int k = 0; k < analysisSize / 2; ++k)
+            power[(size_t) k] = juce::square(spectrum[(size_t) (2 * k)]) + juce::square(spectrum[(size_t) (2 * k + 1)]);
+
+        return power;
+    }
+
+    // Strongest bin within two bins of 'frequency'
+    static float powerNear(const std::vector<float>& power, double frequency)
+    {
+        const int centre = juce::roundToInt(frequency / binWidth);
+        float strongest = 0.0f;
+
+        for (int k = juce::jmax(1, centre - 2); k <= juce::jmin((int) power.size() - 1, centre + 2); ++k)
+            strongest = juce::jmax(strongest, power[(size_t) k]);
+
+        return strongest;
+    }
+
+    /**
+     * Where the formant sits in a harmonic spectrum with fundamental 'pitch': the power-weighted
+     * mean frequency of its harmonics between 200 Hz and 4 kHz. Robust to the few dB the phase
+     * vocoder moves single harmonics by, which would throw off a pick of the loudest one.
+     */
+    static double formantCentre(const std::vector<float>& power, double pitch)
+    {
+        double weighted = 0.0, total = 0.0;
+
+        for (int harmonic = 1; harmonic * pitch < 4000.0; ++harmonic)
+        {
+            if (harmonic * pitch < 200.0)
+                continue;
+
+            const double harmonicPower = powerNear(power, harmonic * pitch);
+            weighted += harmonicPower * harmonic * pitch;
+            total += harmonicPower;
+        }
+
+        return weighted / total;
+    }
+
+    // The harmonics sit on multiples of 'pitch': most of the power near them, little in between
+    static double harmonicPowerRatioDb(const std::vector<float>& power, double pitch)
+    {
+        double onHarmonics = 0.0, between = 0.0;
+
+        for (int harmonic = 1; (harmonic + 1) * pitch < 6000.0; ++harmonic)
+        {
+            onHarmonics += powerNear(power, harmonic * pitch);
+            between += powerNear(power, (harmonic + 0.5) * pitch);
+        }
+
+        return 10.0 * std::log10(onHarmonics / (between + 1.0e-20));
+    }
+
+    void checkUnityRatio()
+    {
+        beginTest("Ratio 1 and formant 0 is the input delayed by the latency");
+
+        juce::AudioBuffer<float> input(1, numSamples);
+        juce::Random random(7);
+
+        for (int i = 0; i < numSamples; ++i)
+            input.setSample(0, i, random.nextFloat() - 0.5f);
+
+        punk_dsp::FormantShifter shifter;
+        shifter.prepare({ sampleRate, (juce::uint32) blockSize, 1 });
+
+        juce::AudioBuffer<float> output;
+        output.makeCopyOf(input);
+        processInBlocks(shifter, output);
+
+        const int latency = shifter.getLatencySamples();
+        float maxError = 0.0f;
+
+        for (int i = 0; i < numSamples; ++i)
+            maxError = juce::jmax(maxError, std::abs(output.getSample(0, i) - (i >= latency ? input.getSample(0, i - latency) : 0.0f)));
+
+        expectLessThan(maxError, 1.0e-5f, "Not the input delayed by " + juce::String(latency) + " samples");
+    }
+
+    void checkFormantKept(float semitones)
+    {
+        beginTest(juce::String(semitones, 0) + " semitones, formant 0: the pitch moves, the 1 kHz formant stays");
+
+        const double ratio = std::pow(2.0, semitones / 12.0);
+        juce::AudioBuffer<float> input(1, numSamples);
+        fillFormantTone(input);
+
+        juce::AudioBuffer<float> kept, moved;
+        kept.makeCopyOf(input);
+        moved.makeCopyOf(input);
+
+        punk_dsp::FormantShifter formantShifter;
+        formantShifter.setSemitones(semitones);
+        formantShifter.prepare({ sampleRate, (juce::uint32) blockSize, 1 });
+        processInBlocks(formantShifter, kept);
+
+        punk_dsp::PhaseVocoderShifter plainShifter;
+        plainShifter.setSemitones(semitones);
+        plainShifter.prepare({ sampleRate, (juce::uint32) blockSize, 1 });
+        processInBlocks(plainShifter, moved);
+
+        const auto keptPower = tailSpectrum(kept);
+        const auto movedPower = tailSpectrum(moved);
+        const double pitch = fundamental * ratio;
+
+        expectGreaterThan(harmonicPowerRatioDb(keptPower, pitch), 20.0, "Harmonics are not on the shifted pitch");
+
+        const double inputCentre = formantCentre(tailSpectrum(input), fundamental);
+        const double keptCentre = formantCentre(keptPower, pitch);
+        const double movedCentre = formantCentre(movedPower, pitch);
+
+        expectLessThan(std::abs(keptCentre - inputCentre), maxFormantError,
+                       "Formant moved from " + juce::String(inputCentre, 0) + " Hz to " + juce::String(keptCentre, 0) + " Hz");
+        expectLessThan(std::abs(movedCentre - inputCentre * ratio), maxFormantError,
+                       "Plain phase vocoder formant at " + juce::String(movedCentre, 0) + " Hz");
+        expectLessThan(std::abs(keptCentre - inputCentre), std::abs(movedCentre - inputCentre),
+                       "Formant moved as far as without formant preservation");
+
+        logMessage("formant " + juce::String(inputCentre, 0) + " Hz in, " + juce::String(keptCentre, 0)
+                   + " Hz out (plain phase vocoder " + juce::String(movedCentre, 0) + " Hz)");
+    }
+
+    void checkFormantMoved(float formantSemitones)
+    {
+        beginTest("Pitch 0, formant " + juce::String(formantSemitones, 0) + " semitones: the formant moves, the pitch stays");
+
+        const double formantRatio = std::pow(2.0, formantSemitones / 12.0);
+        juce::AudioBuffer<float> buffer(1, numSamples);
+        fillFormantTone(buffer);
+
+        punk_dsp::FormantShifter shifter;
+        shifter.setFormantSemitones(formantSemitones);
+        shifter.prepare({ sampleRate, (juce::uint32) blockSize, 1 });
+
+        const double inputCentre = formantCentre(tailSpectrum(buffer), fundamental);
+        processInBlocks(shifter, buffer);
+
+        const auto power = tailSpectrum(buffer);
+        const double centre = formantCentre(power, fundamental);
+
+        expectGreaterThan(harmonicPowerRatioDb(power, fundamental), 20.0, "Harmonics left the original pitch");
+        expectLessThan(std::abs(centre - inputCentre * formantRatio), maxFormantError,
+                       "Formant at " + juce::String(centre, 0) + " Hz");
+
+        logMessage("formant " + juce::String(inputCentre, 0) + " Hz in, " + juce::String(centre, 0) + " Hz out");
+    }
+};
+
+static FormantShifterTests formantShifterTests;
@@ -0,0 +1,133 @@
+#include <juce_dsp/juce_dsp.h>
+#include "dsp/Pitch/PhaseVocoderShifter.h"
+
+/**
+ * PhaseVocoderShifter. At ratio 1 the spectrum is passed through, so the wet output must be the
+ * input delayed by getLatencySamples() (and so must the dry path), for every FFT size and overlap.
+ * Shifted, a steady sine must come out on the shifted frequency: the spectral peak of the output
+ * has to sit in the bin of frequency * ratio.
+ */
+class PhaseVocoderShifterTests : public juce::UnitTest
+{
+public:
+    PhaseVocoderShifterTests() : juce::UnitTest("PhaseVocoderShifter", "Pitch") {}
+
+    void runTest() override
+    {
+        for (const int order : { 9, 11, 13 })
+            for (const int overlap : { 4, 8 })
+                checkUnityRatio(order, overlap);
+
+        for (const float frequency : { 220.0f, 440.0f, 1000.0f })
+            for (const float ratio : { 0.5f, 0.8f, 1.5f, 2.0f })
+                checkShiftedSine(frequency, ratio);
+    }
+
+private:
+    static constexpr double sampleRate = 48000.0;
+    static constexpr int blockSize = 480;
+
+    static void processInBlocks(punk_dsp::PhaseVocoderShifter& shifter, juce::AudioBuffer<float>& buffer)
+    {
+        juce::AudioBuffer<float> block(buffer.getNumChannels(), blockSize);
+
+        for (int start = 0; start + blockSize <= buffer.getNumSamples(); start += blockSize)
+        {
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                block.copyFrom(channel, 0, buffer, channel, start, blockSize);
+
+            shifter.process(block);
+
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                buffer.copyFrom(channel, start, block, channel, 0, blockSize);
+        }
+    }
+
+    void checkUnityRatio(int order, int overlap)
+    {
+        beginTest("Ratio 1 is the input delayed by the latency, FFT order " + juce::String(order) + ", overlap " + juce::String(overlap));
+
+        const int numSamples = blockSize * 100;
+        juce::AudioBuffer<float> input(2, numSamples);
+        juce::Random random(order * 10 + overlap);
+
+        for (int channel = 0; channel < 2; ++channel)
+            for (int i = 0; i < numSamples; ++i)
+                input.setSample(channel, i, random.nextFloat() - 0.5f);
+
+        for (const float mix : { 1.0f, 0.0f })
+        {
+            punk_dsp::PhaseVocoderShifter shifter;
+            shifter.setFftOrder(order);
+            shifter.setOverlapFactor(overlap);
+            shifter.setPitchRatio(1.0f);
+            shifter.setMix(mix);
+            shifter.prepare({ sampleRate, (juce::uint32) blockSize, 2 });
+
+            juce::AudioBuffer<float> output;
+            output.makeCopyOf(input);
+            processInBlocks(shifter, output);
+
+            const int latency = shifter.getLatencySamples();
+            float maxError = 0.0f;
+
+            for (int channel = 0; channel < 2; ++channel)
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    const float expected = i >= latency ? input.getSample(channel, i - latency) : 0.0f;
+                    maxError = juce::jmax(maxError, std::abs(output.getSample(channel, i) - expected));
+                }
+
+            expectLessThan(maxError, 1.0e-5f, juce::String(mix == 1.0f ? "Wet" : "Dry") + " path is not the input delayed by "
+                                              + juce::String(latency) + " samples");
+        }
+    }
+
+    void checkShiftedSine(float frequency, float ratio)
+    {
+        beginTest(juce::String(frequency, 0) + " Hz sine shifted by " + juce::String(ratio, 2) + " lands on its bin");
+
+        const int numSamples = blockSize * 200;
+        juce::AudioBuffer<float> buffer(1, numSamples);
+
+        for (int i = 0; i < numSamples; ++i)
+            buffer.setSample(0, i, 0.5f * (float) std::sin(juce::MathConstants<double>::twoPi * frequency * i / sampleRate));
+
+        punk_dsp::PhaseVocoderShifter shifter;
+        shifter.setPitchRatio(ratio);
+        shifter.prepare({ sampleRate, (juce::uint32) blockSize, 1 });
+        processInBlocks(shifter, buffer);
+
+        // Hann-windowed spectrum of the settled tail
+        constexpr int order = 14, size = 1 << order;
+        std::vector<float> spectrum(2 * size, 0.0f);
+        const float* tail = buffer.getReadPointer(0, numSamples - size);
+
+        for (int i = 0; i < size; ++i)
+            spectrum[(size_t) i] = tail[i] * (0.5f - 0.5f * std::cos(juce::MathConstants<float>::twoPi * (float) i / (float) size));
+
+        juce::dsp::FFT(order).performRealOnlyForwardTransform(spectrum.data(), true);
+
+        int peakBin = 1;
+        float peakPower = 0.0f;
+
+        for (int k = 1; k < size / 2; ++k)
+        {
+            const float power = juce::square(spectrum[(size_t) (2 * k)]) + juce::square(spectrum[(size_t) (2 * k + 1)]);
+
+            if (power > peakPower)
+            {
+                peakPower = power;
+                peakBin = k;
+            }
+        }
+
+        const double binWidth = sampleRate / size;
+        const double expectedBin = frequency * ratio / binWidth;
+
+        expectLessOrEqual(std::abs(peakBin - expectedBin), 1.0, "Output peak at " + juce::String(peakBin * binWidth, 1)
+                                                                 + " Hz, expected " + juce::String(frequency * ratio, 1) + " Hz");
+    }
+};
+
+static PhaseVocoderShifterTests phaseVocoderShifterTests;
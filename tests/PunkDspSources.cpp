@@ -0,0 +1,15 @@
+/*
+ The processors under test, unity-built the same way punk_dsp.cpp does. The tests only link
+ juce_dsp, so the GUI and preset sources (and their modules) stay out.
+*/
+#include <juce_dsp/juce_dsp.h>
+
+#include "dsp/Dynamics/Compressor.cpp"
+#include "dsp/Dynamics/Gate.cpp"
+#include "dsp/Dynamics/MultibandCompressor.cpp"
+#include "dsp/Distortion/TableShaper.cpp"
+#include "dsp/Distortion/Wavefolder.cpp"
+#include "dsp/Distortion/Waveshaper.cpp"
+#include "dsp/Pitch/PitchShifter.cpp"
+#include "dsp/Pitch/PhaseVocoderShifter.cpp"
+#include "dsp/Pitch/FormantShifter.cpp"